@@ -21,7 +21,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui sql xml
+QT       += core gui sql xml concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -48,6 +48,17 @@ unix:DEFINES += GIT_REVISION='\\"$$system(git rev-parse --short HEAD)\\"'
 DEPENDPATH += $$PWD/../atools/src
 INCLUDEPATH += $$PWD/../atools/src $$PWD/src
 
+# Optional use of the SQLite C API for the in-memory database mode and SQLite statistics.
+# Enable with "qmake CONFIG+=system_sqlite" only if the Qt SQL plugin uses the same system
+# SQLite library (Qt configured with "-system-sqlite"). Two SQLite copies must not share a connection.
+system_sqlite {
+  DEFINES += LITTLELOGBOOK_SQLITE_API
+  LIBS += -lsqlite3
+}
+
+# Process memory information for benchmarks
+win32:LIBS += -lpsapi
+
 CONFIG(debug, debug|release) {
   LIBS += -L $$PWD/../atools/debug -l atools
   PRE_TARGETDEPS += $$PWD/../atools/debug/libatools.a
@@ -71,8 +82,43 @@ SOURCES += src/main.cpp\
     src/export/exporter.cpp \
     src/gui/airportinfo.cpp \
     src/gui/pathdialog.cpp \
+    src/gui/pivotdialog.cpp \
     src/gui/pathsettings.cpp \
-    src/export/kmlexporter.cpp
+    src/export/kmlexporter.cpp \
+    src/import/logbookreader.cpp \
+    src/import/logbookcrosscheck.cpp \
+    src/import/backgroundimport.cpp \
+    src/import/bulkloader.cpp \
+    src/import/logbookimporter.cpp \
+    src/import/airportimporter.cpp \
+    src/bench/benchmarkreport.cpp \
+    src/bench/readerbenchmark.cpp \
+    src/cli/commandline.cpp \
+    src/db/databasesnapshot.cpp \
+    src/db/connectionpool.cpp \
+    src/table/querybuilder.cpp \
+    src/table/selectstatement.cpp \
+    src/table/rowidbitmap.cpp \
+    src/table/filtercache.cpp \
+    src/table/grouprollup.cpp \
+    src/table/grouptreemodel.cpp \
+    src/table/pivotmodel.cpp \
+    src/table/pivotquery.cpp \
+    src/cli/queryexportsource.cpp \
+    src/bench/logbookgenerator.cpp \
+    src/bench/benchmarkdatabase.cpp \
+    src/bench/querybenchmark.cpp \
+    src/bench/processmemory.cpp \
+    src/bench/exportbenchmark.cpp \
+    src/bench/processio.cpp \
+    src/bench/importbenchmark.cpp \
+    src/bench/viewbenchmark.cpp \
+    src/bench/datacallcounter.cpp \
+    src/diag/querystats.cpp \
+    src/diag/diagnosticswidget.cpp \
+    src/diag/tracer.cpp \
+    src/diag/slowquerylog.cpp \
+    src/diag/memorystats.cpp
 
 HEADERS  += src/gui/mainwindow.h \
     src/table/sqlmodel.h \
@@ -88,8 +134,44 @@ HEADERS  += src/gui/mainwindow.h \
     src/export/exporter.h \
     src/gui/airportinfo.h \
     src/gui/pathdialog.h \
+    src/gui/pivotdialog.h \
     src/gui/pathsettings.h \
-    src/export/kmlexporter.h
+    src/export/kmlexporter.h \
+    src/import/logbookreader.h \
+    src/import/logbookcrosscheck.h \
+    src/import/backgroundimport.h \
+    src/import/bulkloader.h \
+    src/import/logbookimporter.h \
+    src/import/airportimporter.h \
+    src/bench/benchmarkreport.h \
+    src/bench/readerbenchmark.h \
+    src/cli/commandline.h \
+    src/db/databasesnapshot.h \
+    src/db/connectionpool.h \
+    src/table/querybuilder.h \
+    src/table/selectstatement.h \
+    src/table/rowidbitmap.h \
+    src/table/filtercache.h \
+    src/table/grouprollup.h \
+    src/table/grouptreemodel.h \
+    src/table/pivotmodel.h \
+    src/table/pivotquery.h \
+    src/export/exportsource.h \
+    src/cli/queryexportsource.h \
+    src/bench/logbookgenerator.h \
+    src/bench/benchmarkdatabase.h \
+    src/bench/querybenchmark.h \
+    src/bench/processmemory.h \
+    src/bench/exportbenchmark.h \
+    src/bench/processio.h \
+    src/bench/importbenchmark.h \
+    src/bench/viewbenchmark.h \
+    src/bench/datacallcounter.h \
+    src/diag/querystats.h \
+    src/diag/diagnosticswidget.h \
+    src/diag/tracer.h \
+    src/diag/slowquerylog.h \
+    src/diag/memorystats.h
 
 FORMS    += src/gui/mainwindow.ui \
     src/gui/pathdialog.ui
@@ -0,0 +1,104 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "bench/benchmarkdatabase.h"
+
+#include "db/connectionpool.h"
+#include "import/airportimporter.h"
+#include "gui/constants.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "exception.h"
+#include "logging/loggingdefs.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+
+using atools::sql::SqlDatabase;
+using atools::sql::SqlQuery;
+
+namespace {
+
+/* Each instance needs its own connection name */
+int nextConnectionId = 0;
+
+}
+
+BenchmarkDatabase::BenchmarkDatabase(const LogbookGeneratorConfig& generatorConfig, atools::fs::SimulatorType type)
+  : config(generatorConfig), simulatorType(type)
+{
+  connectionName = QString("benchmarkdb-%1").arg(nextConnectionId++);
+}
+
+BenchmarkDatabase::~BenchmarkDatabase()
+{
+  delete pool;
+
+  if(db != nullptr)
+  {
+    db->close();
+    delete db;
+    SqlDatabase::removeDatabase(connectionName);
+  }
+}
+
+QString BenchmarkDatabase::getDatabaseFile() const
+{
+  return QDir(tempDir.path()).filePath("benchmark.sqlite");
+}
+
+QString BenchmarkDatabase::getRunwaysFile() const
+{
+  return QDir(tempDir.path()).filePath("runways.xml");
+}
+
+void BenchmarkDatabase::create()
+{
+  if(!tempDir.isValid())
+    throw atools::Exception("Cannot create temporary directory for benchmark database");
+
+  LogbookGenerator generator(config);
+  generator.writeRunways(getRunwaysFile());
+
+  if(db == nullptr)
+  {
+    db = new SqlDatabase();
+    *db = SqlDatabase::addDatabase(ll::constants::DATABASE_TYPE, connectionName);
+    db->setDatabaseName(getDatabaseFile());
+    db->open();
+    SqlQuery(db).exec("pragma journal_mode = wal");
+  }
+
+  QElapsedTimer timer;
+  timer.start();
+  AirportImporter airportImporter(db);
+  airportImporter.loadAirports(getRunwaysFile());
+  airportImportMs = timer.restart();
+
+  generator.createLogbook(db, simulatorType);
+  logbookImportMs = timer.elapsed();
+
+  SqlQuery query(db);
+  query.exec("select count(*) from logbook");
+  numEntries = query.next() ? query.value(0).toInt() : 0;
+  query.finish();
+
+  if(pool == nullptr)
+    pool = new ConnectionPool(getDatabaseFile(), false /* in memory */);
+
+  qDebug() << "Benchmark database" << getDatabaseFile() << "with" << numEntries << "entries";
+}
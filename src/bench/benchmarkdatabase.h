@@ -0,0 +1,94 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_BENCHMARKDATABASE_H
+#define LITTLELOGBOOK_BENCHMARKDATABASE_H
+
+#include "bench/logbookgenerator.h"
+
+#include <QTemporaryDir>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+} // namespace sql
+} // namespace atools
+
+class ConnectionPool;
+
+/*
+ * Temporary database filled with generated airports and logbook entries for
+ * benchmarks. The logbook table is created by importing the sample logbook of the
+ * configuration (see LogbookGenerator). Files and database are created in a
+ * temporary directory that is removed on destruction.
+ * The database is in WAL mode like the one used by the GUI.
+ */
+class BenchmarkDatabase
+{
+public:
+  BenchmarkDatabase(const LogbookGeneratorConfig& config, atools::fs::SimulatorType type = atools::fs::FSX);
+  ~BenchmarkDatabase();
+
+  /* Generate and import runways.xml and create the generated entries for the simulator.
+   * Throws atools::Exception on errors. */
+  void create();
+
+  /* Connection used for the import. Also used by models as the main connection. */
+  atools::sql::SqlDatabase *getDatabase()
+  {
+    return db;
+  }
+
+  /* Read-only connections like used by statistics, tooltips and exports */
+  ConnectionPool *getConnectionPool()
+  {
+    return pool;
+  }
+
+  QString getDatabaseFile() const;
+  QString getRunwaysFile() const;
+
+  /* Number of rows in the logbook table */
+  int getNumEntries() const
+  {
+    return numEntries;
+  }
+
+  /* Import times of the last create() call. The logbook time includes the sample
+   * import and inserting the generated entries. */
+  qint64 getAirportImportMs() const
+  {
+    return airportImportMs;
+  }
+
+  qint64 getLogbookImportMs() const
+  {
+    return logbookImportMs;
+  }
+
+private:
+  LogbookGeneratorConfig config;
+  atools::fs::SimulatorType simulatorType;
+  QTemporaryDir tempDir;
+  QString connectionName;
+  atools::sql::SqlDatabase *db = nullptr;
+  ConnectionPool *pool = nullptr;
+  int numEntries = 0;
+  qint64 airportImportMs = 0, logbookImportMs = 0;
+};
+
+#endif // LITTLELOGBOOK_BENCHMARKDATABASE_H
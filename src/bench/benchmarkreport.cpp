@@ -0,0 +1,130 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "bench/benchmarkreport.h"
+
+#include "logging/loggingdefs.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QSysInfo>
+
+#include <algorithm>
+#include <cstdio>
+
+BenchmarkReport::BenchmarkReport(const QString& benchmarkName)
+  : name(benchmarkName)
+{
+}
+
+void BenchmarkReport::addResult(const QString& name, const QJsonObject& values)
+{
+  QJsonObject result(values);
+  result.insert("name", name);
+  results.append(result);
+}
+
+void BenchmarkReport::setProperty(const QString& name, const QJsonValue& value)
+{
+  properties.insert(name, value);
+}
+
+bool BenchmarkReport::write(const QString& filename) const
+{
+  QJsonObject root;
+  root.insert("benchmark", name);
+  root.insert("version", QCoreApplication::applicationVersion());
+  root.insert("revision", QString(GIT_REVISION));
+  root.insert("cpu", QSysInfo::currentCpuArchitecture());
+  root.insert("os", QSysInfo::prettyProductName());
+  root.insert("timestamp", QDateTime::currentDateTime().toString(Qt::ISODate));
+  root.insert("properties", properties);
+  root.insert("results", results);
+
+  QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Indented);
+
+  if(filename.isEmpty())
+  {
+    std::fwrite(json.constData(), 1, static_cast<size_t>(json.size()), stdout);
+    std::fflush(stdout);
+    return true;
+  }
+
+  QFile file(filename);
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qWarning() << "Cannot write benchmark report" << filename << file.errorString();
+    return false;
+  }
+  file.write(json);
+  return true;
+}
+
+void BenchmarkReport::log() const
+{
+  qInfo() << "Benchmark" << name << properties.toVariantMap();
+  for(const QJsonValue& result : results)
+    qInfo() << result.toObject().toVariantMap();
+}
+
+double BenchmarkReport::minimumMs(const QVector<qint64>& nanos)
+{
+  if(nanos.isEmpty())
+    return 0.;
+
+  return *std::min_element(nanos.begin(), nanos.end()) / 1000000.;
+}
+
+double BenchmarkReport::medianMs(const QVector<qint64>& nanos)
+{
+  if(nanos.isEmpty())
+    return 0.;
+
+  QVector<qint64> sorted(nanos);
+  std::sort(sorted.begin(), sorted.end());
+  return sorted.at(sorted.size() / 2) / 1000000.;
+}
+
+double BenchmarkReport::perSecond(qint64 count, double millis)
+{
+  return millis > 0. ? count * 1000. / millis : 0.;
+}
+
+QVector<qint64> BenchmarkReport::measure(int iterations, const std::function<void()>& func)
+{
+  QVector<qint64> times;
+  times.reserve(iterations);
+  for(int i = 0; i < iterations; i++)
+  {
+    QElapsedTimer timer;
+    timer.start();
+    func();
+    times.append(timer.nsecsElapsed());
+  }
+  return times;
+}
+
+QJsonObject BenchmarkReport::timesToJson(const QVector<qint64>& nanos)
+{
+  QJsonObject values;
+  values.insert("minMs", minimumMs(nanos));
+  values.insert("medianMs", medianMs(nanos));
+  return values;
+}
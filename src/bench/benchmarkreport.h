@@ -0,0 +1,68 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_BENCHMARKREPORT_H
+#define LITTLELOGBOOK_BENCHMARKREPORT_H
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QVector>
+
+#include <functional>
+
+/*
+ * Collects benchmark results and writes them as JSON for automated comparison
+ * between builds. Each result is a flat object with a name and arbitrary values.
+ */
+class BenchmarkReport
+{
+public:
+  BenchmarkReport(const QString& benchmarkName);
+
+  /* Add a result. values should contain numbers or strings only. */
+  void addResult(const QString& name, const QJsonObject& values);
+
+  /* Add a value that applies to all results like database size or record count */
+  void setProperty(const QString& name, const QJsonValue& value);
+
+  /* Write the report as JSON to the given file or to stdout if filename is empty.
+   * @return false if the file could not be written */
+  bool write(const QString& filename) const;
+
+  /* Log all results in a human readable form */
+  void log() const;
+
+  /* Helpers to summarize a series of measurements in nanoseconds */
+  static double minimumMs(const QVector<qint64>& nanos);
+  static double medianMs(const QVector<qint64>& nanos);
+
+  /* Items per second for the given item count and time */
+  static double perSecond(qint64 count, double millis);
+
+  /* Run func iterations times and return the times in nanoseconds */
+  static QVector<qint64> measure(int iterations, const std::function<void()>& func);
+
+  /* Object with minMs and medianMs for a series of measurements */
+  static QJsonObject timesToJson(const QVector<qint64>& nanos);
+
+private:
+  QString name;
+  QJsonObject properties;
+  QJsonArray results;
+};
+
+#endif // LITTLELOGBOOK_BENCHMARKREPORT_H
@@ -0,0 +1,46 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "bench/datacallcounter.h"
+
+#include <algorithm>
+
+DataCallCounter::DataCallCounter(QObject *parent)
+  : QIdentityProxyModel(parent)
+{
+}
+
+QVariant DataCallCounter::data(const QModelIndex& index, int role) const
+{
+  counts[role >= 0 && role < NUM_COUNTED_ROLES - 1 ? role : NUM_COUNTED_ROLES - 1]++;
+  return QIdentityProxyModel::data(index, role);
+}
+
+qint64 DataCallCounter::getCount(int role) const
+{
+  if(role >= 0 && role < NUM_COUNTED_ROLES - 1)
+    return counts[role];
+  else if(role == Qt::UserRole)
+    return counts[NUM_COUNTED_ROLES - 1];
+  else
+    return 0;
+}
+
+void DataCallCounter::reset()
+{
+  std::fill(counts, counts + NUM_COUNTED_ROLES, 0);
+}
@@ -0,0 +1,49 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_DATACALLCOUNTER_H
+#define LITTLELOGBOOK_DATACALLCOUNTER_H
+
+#include <QIdentityProxyModel>
+
+/*
+ * Proxy between a view and its model that counts the data() calls per role.
+ * Used by the view benchmark only so that the model itself does not pay for
+ * counting in the GUI.
+ */
+class DataCallCounter :
+  public QIdentityProxyModel
+{
+  Q_OBJECT
+
+public:
+  DataCallCounter(QObject *parent = nullptr);
+
+  virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+  /* Number of data() calls for the given role since the last reset. Roles above
+   * Qt::InitialSortOrderRole are summed up as Qt::UserRole. */
+  qint64 getCount(int role) const;
+  void reset();
+
+private:
+  /* Last entry is for all other roles */
+  static const int NUM_COUNTED_ROLES = Qt::InitialSortOrderRole + 2;
+  mutable qint64 counts[NUM_COUNTED_ROLES] = {};
+};
+
+#endif // LITTLELOGBOOK_DATACALLCOUNTER_H
@@ -0,0 +1,266 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "bench/exportbenchmark.h"
+
+#include "bench/benchmarkdatabase.h"
+#include "bench/benchmarkreport.h"
+#include "bench/processmemory.h"
+#include "cli/queryexportsource.h"
+#include "export/csvexporter.h"
+#include "export/htmlexporter.h"
+#include "export/kmlexporter.h"
+#include "table/columnlist.h"
+#include "table/querybuilder.h"
+#include "sql/sqlquery.h"
+#include "exception.h"
+#include "logging/loggingdefs.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QSqlRecord>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <memory>
+
+using atools::sql::SqlQuery;
+
+namespace {
+
+/* Rows per HTML page as used by the default settings */
+const int HTML_PAGE_SIZE = 500;
+
+/* Passes all calls to the wrapped source and sums up the time spent in formatting */
+class TimingExportSource :
+  public ExportSource
+{
+public:
+  TimingExportSource(const ExportSource *exportSource)
+    : source(exportSource)
+  {
+  }
+
+  virtual atools::sql::SqlDatabase *getReadDatabase() const override
+  {
+    return source->getReadDatabase();
+  }
+
+  virtual QString getCurrentSqlQuery() const override
+  {
+    return source->getCurrentSqlQuery();
+  }
+
+  virtual QVariantMap getCurrentQueryBinds() const override
+  {
+    return source->getCurrentQueryBinds();
+  }
+
+  virtual QString getQueryStateDescription() const override
+  {
+    return source->getQueryStateDescription();
+  }
+
+  virtual int getTotalRowCount() const override
+  {
+    return source->getTotalRowCount();
+  }
+
+  virtual QString formatModelData(const QString& col, const QVariant& var) const override
+  {
+    timer.start();
+    QString retval = source->formatModelData(col, var);
+    formatNs += timer.nsecsElapsed();
+    formatCalls++;
+    return retval;
+  }
+
+  virtual const Column *getColumn(int physicalIndex) const override
+  {
+    return source->getColumn(physicalIndex);
+  }
+
+  virtual int getColumnVisualIndex(int physicalIndex) const override
+  {
+    return source->getColumnVisualIndex(physicalIndex);
+  }
+
+  virtual bool isColumnVisibleInView(int physicalIndex) const override
+  {
+    return source->isColumnVisibleInView(physicalIndex);
+  }
+
+  virtual QString getSortColumn() const override
+  {
+    return source->getSortColumn();
+  }
+
+  qint64 getFormatNs() const
+  {
+    return formatNs;
+  }
+
+  qint64 getFormatCalls() const
+  {
+    return formatCalls;
+  }
+
+private:
+  const ExportSource *source;
+  mutable QElapsedTimer timer;
+  mutable qint64 formatNs = 0, formatCalls = 0;
+};
+
+/* Sum of all file sizes in dir. HTML exports write one file per page. */
+qint64 directorySize(const QString& dir)
+{
+  qint64 size = 0;
+  for(const QFileInfo& info : QDir(dir).entryInfoList(QDir::Files))
+    size += info.size();
+  return size;
+}
+
+qint64 median(QVector<qint64> values)
+{
+  if(values.isEmpty())
+    return 0;
+
+  std::sort(values.begin(), values.end());
+  return values.at(values.size() / 2);
+}
+
+}
+
+ExportBenchmark::ExportBenchmark(const QVector<int>& databaseSizes, const QString& sampleLogbookFile,
+                                 int numIterations)
+  : sizes(databaseSizes), sampleLogbook(sampleLogbookFile), iterations(numIterations)
+{
+  addExporter("csv", "csv", [](ExportSource *source) -> Exporter * {
+    return new CsvExporter(source);
+  });
+  addExporter("html", "html", [](ExportSource *source) -> Exporter * {
+    return new HtmlExporter(source, HTML_PAGE_SIZE);
+  });
+  addExporter("kml", "kml", [](ExportSource *source) -> Exporter * {
+    return new KmlExporter(source);
+  });
+}
+
+void ExportBenchmark::addExporter(const QString& name, const QString& suffix, ExporterFactory factory)
+{
+  exporters.append({name, suffix, factory});
+}
+
+void ExportBenchmark::run(BenchmarkReport& report)
+{
+  QJsonArray sizeArr;
+  for(int size : sizes)
+    sizeArr.append(size);
+  report.setProperty("sizes", sizeArr);
+  report.setProperty("iterations", iterations);
+  report.setProperty("peakRssReset", ProcessMemory::resetPeakRss());
+
+  for(int size : sizes)
+  {
+    LogbookGeneratorConfig config;
+    config.numEntries = size;
+    config.sampleLogbook = sampleLogbook;
+    BenchmarkDatabase database(config);
+    database.create();
+
+    // Default view of the table without any filters
+    ColumnList columns(true /* airports */);
+    QueryBuilder query(&columns);
+    query.build();
+
+    qint64 queryNs = measureQuery(database, query);
+
+    for(const ExporterType& type : exporters)
+      runExporter(report, database, query, type, queryNs);
+  }
+}
+
+qint64 ExportBenchmark::measureQuery(BenchmarkDatabase& database, const QueryBuilder& query)
+{
+  QVector<qint64> times = BenchmarkReport::measure(iterations, [&]() {
+    SqlQuery sqlQuery(database.getDatabase());
+    sqlQuery.prepare(query.getSqlQuery());
+    SelectStatement::bindValues(sqlQuery, query.getSqlBinds());
+    sqlQuery.exec();
+    while(sqlQuery.next())
+    {
+      // Read all values like the exporters do but do not format them
+      QSqlRecord rec = sqlQuery.record();
+      for(int col = 0; col < rec.count(); ++col)
+        rec.value(col);
+    }
+  });
+  return median(times);
+}
+
+void ExportBenchmark::runExporter(BenchmarkReport& report, BenchmarkDatabase& database,
+                                  const QueryBuilder& query, const ExporterType& type, qint64 queryNs)
+{
+  QueryExportSource source(database.getDatabase(), &query);
+
+  QVector<qint64> totalTimes, formatTimes;
+  qint64 rows = 0, bytes = 0, formatCalls = 0, peakRss = 0;
+
+  for(int i = 0; i < iterations; i++)
+  {
+    // Fresh directory for each run to count all files written
+    QTemporaryDir dir;
+    if(!dir.isValid())
+      throw atools::Exception("Cannot create temporary directory for export");
+
+    TimingExportSource timingSource(&source);
+    std::unique_ptr<Exporter> exporter(type.factory(&timingSource));
+
+    ProcessMemory::resetPeakRss();
+    QElapsedTimer timer;
+    timer.start();
+    int exported = exporter->exportAllTo(dir.path() + QDir::separator() + "export." + type.suffix);
+    totalTimes.append(timer.nsecsElapsed());
+
+    if(exported == -1)
+      throw atools::Exception("Export " + type.name + " failed");
+
+    peakRss = std::max(peakRss, ProcessMemory::peakRss());
+    formatTimes.append(timingSource.getFormatNs());
+    formatCalls = timingSource.getFormatCalls();
+    rows = exported;
+    bytes = directorySize(dir.path());
+  }
+
+  qint64 totalNs = median(totalTimes), formatNs = median(formatTimes);
+  double totalMs = totalNs / 1000000.;
+
+  QJsonObject values = BenchmarkReport::timesToJson(totalTimes);
+  values.insert("rows", rows);
+  values.insert("bytes", bytes);
+  values.insert("rowsPerSecond", BenchmarkReport::perSecond(rows, totalMs));
+  values.insert("bytesPerSecond", BenchmarkReport::perSecond(bytes, totalMs));
+  values.insert("queryMs", queryNs / 1000000.);
+  values.insert("formatMs", formatNs / 1000000.);
+  values.insert("writeMs", std::max(totalNs - queryNs - formatNs, Q_INT64_C(0)) / 1000000.);
+  values.insert("formatCalls", formatCalls);
+  values.insert("peakRssBytes", peakRss);
+  report.addResult("export/" + QString::number(database.getNumEntries()) + "/" + type.name, values);
+}
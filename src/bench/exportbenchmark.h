@@ -0,0 +1,75 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_EXPORTBENCHMARK_H
+#define LITTLELOGBOOK_EXPORTBENCHMARK_H
+
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+class BenchmarkReport;
+class BenchmarkDatabase;
+class Exporter;
+class ExportSource;
+class QueryBuilder;
+
+/*
+ * Runs all exporters on generated databases of several sizes and writes into
+ * temporary files. Reports rows and bytes per second, peak resident set size
+ * and the time split between query, formatting and writing.
+ *
+ * Query time is measured by a separate pass that only reads all rows. Formatting
+ * time is collected by wrapping the export source. Everything else is counted as
+ * writing which includes the markup of HTML and KML.
+ */
+class ExportBenchmark
+{
+public:
+  /* Creates an exporter writing the rows of source */
+  typedef std::function<Exporter *(ExportSource *source)> ExporterFactory;
+
+  /* Registers the CSV, HTML and KML exporters */
+  ExportBenchmark(const QVector<int>& databaseSizes, const QString& sampleLogbookFile, int numIterations);
+
+  /* Add another exporter to the benchmark. suffix is used for the output file. */
+  void addExporter(const QString& name, const QString& suffix, ExporterFactory factory);
+
+  /* Run all measurements and add the results to the report */
+  void run(BenchmarkReport& report);
+
+private:
+  struct ExporterType
+  {
+    QString name, suffix;
+    ExporterFactory factory;
+  };
+
+  void runExporter(BenchmarkReport& report, BenchmarkDatabase& database, const QueryBuilder& query,
+                   const ExporterType& type, qint64 queryNs);
+
+  /* Time to run the query and read all values without formatting */
+  qint64 measureQuery(BenchmarkDatabase& database, const QueryBuilder& query);
+
+  QVector<ExporterType> exporters;
+  QVector<int> sizes;
+  QString sampleLogbook;
+  int iterations;
+};
+
+#endif // LITTLELOGBOOK_EXPORTBENCHMARK_H
@@ -0,0 +1,258 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "bench/importbenchmark.h"
+
+#include "bench/benchmarkreport.h"
+#include "bench/logbookgenerator.h"
+#include "bench/processio.h"
+#include "import/airportimporter.h"
+#include "gui/constants.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "exception.h"
+#include "logging/loggingdefs.h"
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <functional>
+
+using atools::sql::SqlDatabase;
+using atools::sql::SqlQuery;
+
+namespace {
+
+const char *IMPORT_CONNECTION = "importbenchmark";
+
+/* Same as the defaults of LogbookImporter::filterFromSettings() without reading the settings */
+atools::fs::lb::LogbookEntryFilter defaultFilter()
+{
+  atools::fs::lb::LogbookEntryFilter filter;
+  filter.invalidDate();
+  filter.startAndDestEmpty();
+  filter.startAndDestSame();
+  filter.flightTimeLowerThan(5);
+  return filter;
+}
+
+qint64 fileSize(const QString& filename)
+{
+  QFileInfo info(filename);
+  return info.exists() ? info.size() : 0;
+}
+
+qint64 median(QVector<qint64> values)
+{
+  if(values.isEmpty())
+    return 0;
+
+  std::sort(values.begin(), values.end());
+  return values.at(values.size() / 2);
+}
+
+}
+
+ImportBenchmark::ImportBenchmark(const QVector<int>& airportSizes, const QStringList& sampleLogbookFiles,
+                                 const QString& runwaysFile, int numIterations)
+  : sizes(airportSizes), sampleLogbooks(sampleLogbookFiles), runways(runwaysFile), iterations(numIterations)
+{
+}
+
+void ImportBenchmark::run(BenchmarkReport& report)
+{
+  QJsonArray sizeArr;
+  for(int size : sizes)
+    sizeArr.append(size);
+  report.setProperty("sizes", sizeArr);
+  report.setProperty("iterations", iterations);
+  report.setProperty("loader", "atools");
+  report.setProperty("runways", runways.isEmpty() ? QString("generated") : runways);
+
+  for(int size : sizes)
+    runRunways(report, size);
+
+  for(const QString& logbookFile : sampleLogbooks)
+    runLogbook(report, logbookFile);
+}
+
+void ImportBenchmark::runRunways(BenchmarkReport& report, int size)
+{
+  QTemporaryDir tempDir;
+  if(!tempDir.isValid())
+    throw atools::Exception("Cannot create temporary directory for import benchmark");
+
+  LogbookGeneratorConfig config;
+  config.numAirports = size;
+
+  QDir dir(tempDir.path());
+  QString runwaysFile = dir.filePath("runways.xml");
+  LogbookGenerator(config).writeRunways(runwaysFile);
+  QString databaseFile = dir.filePath("import.sqlite");
+
+  QVector<qint64> runwayTimes;
+  int numAirports = 0;
+  for(int i = 0; i < iterations; i++)
+  {
+    for(const QString& suffix : {QString(), QString("-wal"), QString("-shm")})
+      QFile::remove(databaseFile + suffix);
+
+    {
+      SqlDatabase db = SqlDatabase::addDatabase(ll::constants::DATABASE_TYPE, IMPORT_CONNECTION);
+      db.setDatabaseName(databaseFile);
+      db.open();
+      SqlQuery(&db).exec("pragma journal_mode = wal");
+
+      QElapsedTimer timer;
+      timer.start();
+      AirportImporter airportImporter(&db);
+      airportImporter.loadAirports(runwaysFile);
+      runwayTimes.append(timer.nsecsElapsed());
+      numAirports = airportImporter.getNumLoaded();
+
+      db.close();
+    }
+    SqlDatabase::removeDatabase(IMPORT_CONNECTION);
+  }
+
+  QJsonObject runwayValues = BenchmarkReport::timesToJson(runwayTimes);
+  runwayValues.insert("airports", numAirports);
+  runwayValues.insert("fileBytes", fileSize(runwaysFile));
+  runwayValues.insert("airportsPerSecond",
+                      BenchmarkReport::perSecond(numAirports, BenchmarkReport::medianMs(runwayTimes)));
+  report.addResult("runways/" + QString::number(size), runwayValues);
+}
+
+void ImportBenchmark::runLogbook(BenchmarkReport& report, const QString& logbookFile)
+{
+  if(!QFileInfo(logbookFile).isFile())
+    throw atools::Exception(QString("Sample logbook \"%1\" not found").arg(logbookFile));
+
+  QTemporaryDir tempDir;
+  if(!tempDir.isValid())
+    throw atools::Exception("Cannot create temporary directory for import benchmark");
+
+  QDir dir(tempDir.path());
+  QString runwaysFile = runways;
+  if(runwaysFile.isEmpty())
+  {
+    runwaysFile = dir.filePath("runways.xml");
+    LogbookGenerator(LogbookGeneratorConfig()).writeRunways(runwaysFile);
+  }
+  QString databaseFile = dir.filePath("import.sqlite");
+
+  QVector<Sample> full, reload, append;
+  for(int i = 0; i < iterations; i++)
+  {
+    for(const QString& suffix : {QString(), QString("-wal"), QString("-shm")})
+      QFile::remove(databaseFile + suffix);
+
+    {
+      SqlDatabase db = SqlDatabase::addDatabase(ll::constants::DATABASE_TYPE, IMPORT_CONNECTION);
+      db.setDatabaseName(databaseFile);
+      db.open();
+      SqlQuery(&db).exec("pragma journal_mode = wal");
+
+      // The loader looks up airports for names and distances like in the GUI
+      AirportImporter(&db).loadAirports(runwaysFile);
+
+      // Same file for the second simulator which is used for appending
+      full.append(importLogbook(&db, databaseFile, logbookFile, atools::fs::FSX));
+      reload.append(importLogbook(&db, databaseFile, logbookFile, atools::fs::FSX));
+      append.append(importLogbook(&db, databaseFile, logbookFile, atools::fs::P3D_V3));
+
+      db.close();
+    }
+    SqlDatabase::removeDatabase(IMPORT_CONNECTION);
+  }
+
+  // Results are named by the number of entries which is the size axis for real logbooks
+  QString sizeName = QString::number(full.isEmpty() ? 0 : full.last().rows);
+  qint64 logbookBytes = fileSize(logbookFile);
+  addResult(report, "logbook/" + sizeName + "/full", full, logbookBytes);
+  addResult(report, "logbook/" + sizeName + "/reload", reload, logbookBytes);
+  addResult(report, "logbook/" + sizeName + "/append", append, logbookBytes);
+}
+
+ImportBenchmark::Sample ImportBenchmark::importLogbook(SqlDatabase *db, const QString& databaseFile,
+                                                       const QString& logbookFile,
+                                                       atools::fs::SimulatorType type)
+{
+  // Start with an empty WAL so its size shows the pages written by this import
+  SqlQuery(db).exec("pragma wal_checkpoint(truncate)");
+
+  Sample sample;
+  qint64 writtenBefore = ProcessIo::bytesWritten();
+
+  LogbookImporter importer(db);
+
+  QElapsedTimer timer;
+  timer.start();
+  importer.loadLogbook(logbookFile, type, defaultFilter());
+  sample.totalNs = timer.nsecsElapsed();
+
+  sample.walBytes = fileSize(databaseFile + "-wal");
+  sample.bytesWritten = writtenBefore != -1 ? ProcessIo::bytesWritten() - writtenBefore : -1;
+
+  SqlQuery(db).exec("pragma wal_checkpoint(truncate)");
+  sample.databaseBytes = fileSize(databaseFile);
+
+  sample.times = importer.getPhaseTimes();
+  sample.rows = importer.getNumLoaded();
+  sample.duplicates = importer.getNumDuplicates();
+  return sample;
+}
+
+void ImportBenchmark::addResult(BenchmarkReport& report, const QString& name, const QVector<Sample>& samples,
+                                qint64 fileBytes)
+{
+  QVector<qint64> totalTimes;
+  for(const Sample& sample : samples)
+    totalTimes.append(sample.totalNs);
+
+  // Median of one value of all samples
+  auto medianOf = [&samples](const std::function<qint64(const Sample&)>& value) -> qint64 {
+    QVector<qint64> values;
+    for(const Sample& sample : samples)
+      values.append(value(sample));
+    return median(values);
+  };
+
+  int rows = samples.isEmpty() ? 0 : samples.last().rows;
+
+  QJsonObject values = BenchmarkReport::timesToJson(totalTimes);
+  values.insert("rows", rows);
+  values.insert("duplicates", samples.isEmpty() ? 0 : samples.last().duplicates);
+  values.insert("fileBytes", fileBytes);
+  values.insert("rowsPerSecond", BenchmarkReport::perSecond(rows, BenchmarkReport::medianMs(totalTimes)));
+
+  values.insert("loadMs", medianOf([](const Sample& s) {return s.times.loadMs; }));
+  values.insert("updateMs", medianOf([](const Sample& s) {return s.times.updateMs; }));
+  values.insert("indexMs", medianOf([](const Sample& s) {return s.times.indexMs; }));
+  values.insert("analyzeMs", medianOf([](const Sample& s) {return s.times.analyzeMs; }));
+
+  values.insert("bytesWritten", medianOf([](const Sample& s) {return s.bytesWritten; }));
+  values.insert("walBytes", medianOf([](const Sample& s) {return s.walBytes; }));
+  values.insert("databaseBytes", medianOf([](const Sample& s) {return s.databaseBytes; }));
+  report.addResult(name, values);
+}
@@ -0,0 +1,81 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_IMPORTBENCHMARK_H
+#define LITTLELOGBOOK_IMPORTBENCHMARK_H
+
+#include "import/logbookimporter.h"
+
+#include <QStringList>
+#include <QVector>
+
+class BenchmarkReport;
+
+/*
+ * Measures imports through the same path as the GUI: the atools AirportLoader and
+ * LogbookLoader within a BulkLoader followed by the updates of LogbookImporter.
+ *
+ * Runways are generated with an increasing number of airports. Logbook.BIN files
+ * cannot be generated so each recorded sample logbook is measured in three
+ * scenarios: "full" imports into a database containing only airports, "reload"
+ * imports the same file again which replaces all entries and "append" adds the
+ * entries again for a second simulator. The airports are generated or read from
+ * the given runways.xml which makes the airport lookups of the loader realistic.
+ *
+ * Reports the time per import phase, rows per second, bytes written by the
+ * process (database, WAL and checkpoints), the WAL file size and the database
+ * size after a checkpoint.
+ */
+class ImportBenchmark
+{
+public:
+  /* runwaysFile is used for the logbook scenarios if not empty */
+  ImportBenchmark(const QVector<int>& airportSizes, const QStringList& sampleLogbookFiles,
+                  const QString& runwaysFile, int numIterations);
+
+  /* Run all measurements and add the results to the report */
+  void run(BenchmarkReport& report);
+
+private:
+  /* Phase times, sizes and counters of one import */
+  struct Sample
+  {
+    LogbookImportTimes times;
+    qint64 totalNs = 0, bytesWritten = 0, walBytes = 0, databaseBytes = 0;
+    int rows = 0, duplicates = 0;
+  };
+
+  /* Import generated runways with the given number of airports */
+  void runRunways(BenchmarkReport& report, int size);
+
+  /* Run all scenarios for a sample logbook */
+  void runLogbook(BenchmarkReport& report, const QString& logbookFile);
+
+  /* Import the logbook and collect all values */
+  Sample importLogbook(atools::sql::SqlDatabase *db, const QString& databaseFile,
+                       const QString& logbookFile, atools::fs::SimulatorType type);
+
+  void addResult(BenchmarkReport& report, const QString& name, const QVector<Sample>& samples,
+                 qint64 fileBytes);
+
+  QVector<int> sizes;
+  QStringList sampleLogbooks;
+  QString runways;
+  int iterations;
+};
+
+#endif // LITTLELOGBOOK_IMPORTBENCHMARK_H
@@ -0,0 +1,499 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "bench/logbookgenerator.h"
+
+#include "import/airportimporter.h"
+#include "import/bulkloader.h"
+#include "import/logbookimporter.h"
+#include "gui/constants.h"
+#include "fs/lb/types.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "exception.h"
+#include "logging/loggingdefs.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSqlQuery>
+#include <QVariant>
+#include <QXmlStreamWriter>
+#include <QtMath>
+
+#include <algorithm>
+
+using atools::fs::SimulatorType;
+using atools::sql::SqlDatabase;
+using atools::sql::SqlQuery;
+using namespace atools::fs::lb::types;
+
+namespace {
+
+/* Start of the generated logbooks: 2010-01-01 00:00:00 UTC */
+const quint32 FIRST_START_DATE = 1262304000;
+
+/* Time span covered by the generated entries in seconds (about six years) */
+const qint64 LOGBOOK_TIME_SPAN = 6LL * 365 * 24 * 3600;
+
+const double EARTH_RADIUS_NM = 3440.065;
+
+const char *GENERATOR_CONNECTION = "logbookgenerator";
+
+/* Database written by generate() */
+const char *DATABASE_NAME = "little_logbook.sqlite";
+
+/* Columns filled for generated entries if the table of the loader has them */
+const QStringList ENTRY_COLUMNS(
+{
+  "simulator_id", "logbook_id", "startdate",
+  "airport_from_icao", "airport_from_name", "airport_from_city", "airport_from_state", "airport_from_country",
+  "airport_to_icao", "airport_to_name", "airport_to_city", "airport_to_state", "airport_to_country",
+  "distance", "description", "total_time", "night_time", "instrument_time",
+  "aircraft_reg", "aircraft_descr", "aircraft_type", "aircraft_flags", "visits"
+});
+
+/* ICAO region prefix with a rough bounding rectangle */
+struct Region
+{
+  char prefix;
+  const char *country;
+  double latFrom, latTo, lonFrom, lonTo;
+};
+
+const Region REGIONS[] =
+{
+  {'K', "United States", 25., 49., -125., -67.},
+  {'E', "Germany", 47., 55., 6., 15.},
+  {'L', "Spain", 36., 43., -9., 3.},
+  {'C', "Canada", 43., 62., -135., -55.},
+  {'Y', "Australia", -38., -12., 114., 153.},
+  {'R', "Japan", 31., 44., 130., 145.},
+  {'S', "Brazil", -30., -3., -60., -35.},
+  {'F', "South Africa", -34., -23., 17., 32.}
+};
+const int NUM_REGIONS = sizeof(REGIONS) / sizeof(Region);
+
+const char *STATES[] = {"California", "Texas", "Florida", "Washington", "Colorado", "New York", "Alaska"};
+const int NUM_STATES = sizeof(STATES) / sizeof(const char *);
+
+const char *SYLLABLES[] = {"ber", "lin", "mun", "ich", "ham", "burg", "san", "ta", "ro", "sa", "wood", "field",
+                           "port", "ville", "ka", "mi", "no", "ra", "del", "mar", "co", "ton", "ash", "bro"};
+const int NUM_SYLLABLES = sizeof(SYLLABLES) / sizeof(const char *);
+
+const char *AIRPORT_SUFFIXES[] = {"Intl", "Regional", "Municipal", "Field", "Airpark"};
+const int NUM_AIRPORT_SUFFIXES = sizeof(AIRPORT_SUFFIXES) / sizeof(const char *);
+
+/* Aircraft templates per type with description and cruise speed */
+struct AircraftTemplate
+{
+  quint16 type;
+  const char *descr;
+  int speedKts;
+  bool multiEngine;
+};
+
+const AircraftTemplate AIRCRAFT_TEMPLATES[] =
+{
+  {AIRCRAFT_UNKNOWN, "Experimental", 120, false},
+  {AIRCRAFT_GLIDER, "DG-808S", 60, false},
+  {AIRCRAFT_FIXED_WING, "Cessna Skyhawk 172SP", 120, false},
+  {AIRCRAFT_FIXED_WING, "Mooney Bravo", 170, false},
+  {AIRCRAFT_FIXED_WING, "Beechcraft Baron 58", 190, true},
+  {AIRCRAFT_FIXED_WING, "Beechcraft King Air 350", 280, true},
+  {AIRCRAFT_FIXED_WING, "Bombardier CRJ700", 450, true},
+  {AIRCRAFT_FIXED_WING, "Boeing 737-800", 460, true},
+  {AIRCRAFT_FIXED_WING, "Boeing 747-400", 490, true},
+  {AIRCRAFT_AMPHIBIOUS, "Maule M7 Orion", 130, false},
+  {AIRCRAFT_AMPHIBIOUS, "DHC-6 Twin Otter", 150, true},
+  {AIRCRAFT_ROTARY, "Bell 206B JetRanger", 110, false},
+  {AIRCRAFT_ROTARY, "Robinson R22", 90, false}
+};
+
+/* Weights for a Zipf distribution over count elements */
+std::vector<double> zipfWeights(int count, double exponent)
+{
+  std::vector<double> weights(static_cast<size_t>(count));
+  for(int i = 0; i < count; i++)
+    weights[static_cast<size_t>(i)] = 1. / std::pow(i + 1., exponent);
+  return weights;
+}
+
+double distanceNm(double lonX1, double latY1, double lonX2, double latY2)
+{
+  double lat1 = qDegreesToRadians(latY1), lat2 = qDegreesToRadians(latY2);
+  double dLat = lat2 - lat1, dLon = qDegreesToRadians(lonX2 - lonX1);
+  double a = std::sin(dLat / 2.) * std::sin(dLat / 2.) +
+             std::cos(lat1) * std::cos(lat2) * std::sin(dLon / 2.) * std::sin(dLon / 2.);
+  return EARTH_RADIUS_NM * 2. * std::atan2(std::sqrt(a), std::sqrt(1. - a));
+}
+
+}
+
+LogbookGenerator::LogbookGenerator(const LogbookGeneratorConfig& generatorConfig)
+  : config(generatorConfig)
+{
+  config.numAirports = std::max(config.numAirports, 2);
+  config.numAircraft = std::max(config.numAircraft, 1);
+  config.numEntries = std::max(config.numEntries, 0);
+
+  random.seed(config.seed);
+  createAirports();
+  createAircraft();
+}
+
+QString LogbookGenerator::simulatorDirName(SimulatorType type)
+{
+  switch(type)
+  {
+    case atools::fs::FSX:
+      return "fsx";
+
+    case atools::fs::FSX_SE:
+      return "fsxse";
+
+    case atools::fs::P3D_V2:
+      return "p3dv2";
+
+    case atools::fs::P3D_V3:
+      return "p3dv3";
+
+    case atools::fs::ALL_SIMULATORS:
+      break;
+  }
+  return QString();
+}
+
+void LogbookGenerator::generate(const QString& directory, const QVector<SimulatorType>& types)
+{
+  QStringList runwaysFiles;
+  for(SimulatorType type : types)
+  {
+    QString dirName = QDir(directory).filePath(simulatorDirName(type));
+    if(!QDir().mkpath(dirName))
+      throw atools::Exception(QString("Cannot create directory \"%1\"").arg(dirName));
+
+    runwaysFiles.append(QDir(dirName).filePath("runways.xml"));
+    writeRunways(runwaysFiles.last());
+  }
+
+  QString databaseFile = QDir(directory).filePath(DATABASE_NAME);
+  QFile::remove(databaseFile);
+  {
+    SqlDatabase db = SqlDatabase::addDatabase(ll::constants::DATABASE_TYPE, GENERATOR_CONNECTION);
+    db.setDatabaseName(databaseFile);
+    db.open();
+
+    // All simulators have the same airports
+    if(!runwaysFiles.isEmpty())
+      AirportImporter(&db).loadAirports(runwaysFiles.first());
+
+    for(SimulatorType type : types)
+      createLogbook(&db, type);
+
+    db.close();
+  }
+  SqlDatabase::removeDatabase(GENERATOR_CONNECTION);
+}
+
+bool LogbookGenerator::chance(double percent)
+{
+  return std::uniform_real_distribution<double>(0., 100.)(random) < percent;
+}
+
+void LogbookGenerator::createAirports()
+{
+  std::uniform_real_distribution<double> unit(0., 1.);
+  std::uniform_int_distribution<int> syllable(0, NUM_SYLLABLES - 1);
+
+  airports.clear();
+  airports.reserve(config.numAirports);
+  for(int i = 0; i < config.numAirports; i++)
+  {
+    const Region& region = REGIONS[i % NUM_REGIONS];
+
+    // Unique code from the running number within the region
+    int code = i / NUM_REGIONS;
+    Airport ap;
+    ap.icao = QString(QChar(region.prefix)) +
+              QChar('A' + (code / (26 * 26)) % 26) + QChar('A' + (code / 26) % 26) + QChar('A' + code % 26);
+
+    QString city = QString(SYLLABLES[syllable(random)]) + SYLLABLES[syllable(random)];
+    if(unit(random) < 0.5)
+      city += SYLLABLES[syllable(random)];
+    city[0] = city.at(0).toUpper();
+
+    ap.city = city;
+    ap.name = city + " " + AIRPORT_SUFFIXES[i % NUM_AIRPORT_SUFFIXES];
+    ap.country = region.country;
+    if(region.prefix == 'K')
+      ap.state = STATES[code % NUM_STATES];
+
+    ap.latY = region.latFrom + unit(random) * (region.latTo - region.latFrom);
+    ap.lonX = region.lonFrom + unit(random) * (region.lonTo - region.lonFrom);
+    ap.altitude = static_cast<int>(unit(random) * unit(random) * 6000.);
+
+    // Busy airports with low numbers get the long runways
+    double size = 1. / std::sqrt(1. + i / 50.);
+    ap.runwayLength = static_cast<int>(1500. + (unit(random) * 0.5 + size) * 8000.);
+    ap.hasIls = ap.runwayLength > 6000 && unit(random) < 0.9;
+    ap.hasLights = ap.hasIls || unit(random) < 0.7;
+    airports.append(ap);
+  }
+}
+
+void LogbookGenerator::createAircraft()
+{
+  // Pick type first by the configured mix and then one of the templates for the type
+  std::vector<double> typeWeights(config.aircraftTypeWeights.begin(), config.aircraftTypeWeights.end());
+  typeWeights.resize(AIRCRAFT_ROTARY + 1, 0.);
+  if(std::all_of(typeWeights.begin(), typeWeights.end(), [](double w) {return w <= 0.; }))
+    typeWeights[AIRCRAFT_FIXED_WING] = 1.;
+
+  std::discrete_distribution<int> typeDist(typeWeights.begin(), typeWeights.end());
+
+  aircraft.clear();
+  for(int i = 0; i < config.numAircraft; i++)
+  {
+    quint16 type = static_cast<quint16>(typeDist(random));
+    bool multiEngine = (type == AIRCRAFT_FIXED_WING || type == AIRCRAFT_AMPHIBIOUS) &&
+                       chance(config.multiEnginePercent);
+
+    QVector<const AircraftTemplate *> matching;
+    for(const AircraftTemplate& tmpl : AIRCRAFT_TEMPLATES)
+      if(tmpl.type == type && tmpl.multiEngine == multiEngine)
+        matching.append(&tmpl);
+
+    if(matching.isEmpty())
+    {
+      for(const AircraftTemplate& tmpl : AIRCRAFT_TEMPLATES)
+        if(tmpl.type == type)
+          matching.append(&tmpl);
+    }
+
+    const AircraftTemplate *tmpl =
+      matching.at(std::uniform_int_distribution<int>(0, matching.size() - 1)(random));
+
+    Aircraft ac;
+    ac.reg = QString("N%1").arg(100 + i * 7 % 900) + QChar('A' + i % 26) + QChar('A' + (i / 26) % 26);
+    ac.descr = tmpl->descr;
+    ac.type = tmpl->type;
+    ac.flags = tmpl->multiEngine ? AIRCRAFT_FLAG_MULTIMOTOR : 0;
+    ac.speedKts = tmpl->speedKts;
+    aircraft.append(ac);
+  }
+}
+
+void LogbookGenerator::writeRunways(const QString& filename)
+{
+  QFile file(filename);
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    throw atools::Exception(QString("Cannot open \"%1\": %2").arg(filename).arg(file.errorString()));
+
+  QXmlStreamWriter xml(&file);
+  xml.setAutoFormatting(true);
+  xml.writeStartDocument();
+  xml.writeStartElement("data");
+
+  for(const Airport& ap : airports)
+  {
+    xml.writeStartElement("ICAO");
+    xml.writeAttribute("id", ap.icao);
+    xml.writeTextElement("ICAOName", ap.name);
+    xml.writeTextElement("Country", ap.country);
+    xml.writeTextElement("State", ap.state);
+    xml.writeTextElement("City", ap.city);
+    xml.writeTextElement("Longitude", QString::number(ap.lonX, 'f', 6));
+    xml.writeTextElement("Latitude", QString::number(ap.latY, 'f', 6));
+    xml.writeTextElement("Altitude", QString::number(ap.altitude));
+
+    xml.writeStartElement("Runway");
+    xml.writeAttribute("id", "09");
+    xml.writeTextElement("Len", QString::number(ap.runwayLength));
+    xml.writeTextElement("Hdg", "90.0");
+    if(ap.hasIls)
+    {
+      xml.writeTextElement("ILSFreq", "110.30");
+      xml.writeTextElement("ILSid", "I" + ap.icao.mid(1));
+    }
+    if(ap.hasLights)
+      xml.writeTextElement("EdgeLights", "MEDIUM");
+    xml.writeEndElement(); // Runway
+
+    xml.writeEndElement(); // ICAO
+  }
+
+  xml.writeEndElement(); // data
+  xml.writeEndDocument();
+
+  if(xml.hasError() || file.error() != QFile::NoError)
+    throw atools::Exception(QString("Cannot write \"%1\": %2").arg(filename).arg(file.errorString()));
+
+  file.close();
+  qDebug() << "Wrote" << airports.size() << "airports to" << filename;
+}
+
+void LogbookGenerator::createLogbook(SqlDatabase *db, SimulatorType type)
+{
+  if(config.sampleLogbook.isEmpty())
+    throw atools::Exception("A sample Logbook.BIN is needed to create the logbook table");
+
+  // Only the atools loader knows the file format and creates the table
+  LogbookImporter(db).loadLogbook(config.sampleLogbook, type, atools::fs::lb::LogbookEntryFilter());
+
+  insertEntries(db, type);
+  LogbookImporter::updateEntries(db, type);
+}
+
+void LogbookGenerator::insertEntries(SqlDatabase *db, SimulatorType type)
+{
+  // Different but reproducible logbooks per simulator
+  random.seed(config.seed + 7919u * (static_cast<quint32>(type) + 1u));
+  numInvalid = 0;
+
+  // Fill only the columns that the table of the loader has
+  QStringList columns;
+  QSqlQuery tableInfo(db->getQSqlDatabase());
+  tableInfo.exec("pragma table_info(logbook)");
+  while(tableInfo.next())
+  {
+    QString name = tableInfo.value("name").toString();
+    if(ENTRY_COLUMNS.contains(name))
+      columns.append(name);
+  }
+  tableInfo.finish();
+
+  if(!columns.contains("simulator_id") || !columns.contains("logbook_id"))
+    throw atools::Exception("Logbook table of the loader has no simulator_id or logbook_id column");
+
+  std::vector<double> airportWeights = zipfWeights(airports.size(), config.airportSkew);
+  std::discrete_distribution<int> airportDist(airportWeights.begin(), airportWeights.end());
+
+  // A few favorite aircraft are used for most flights
+  std::vector<double> aircraftWeights = zipfWeights(aircraft.size(), 1.);
+  std::discrete_distribution<int> aircraftDist(aircraftWeights.begin(), aircraftWeights.end());
+
+  std::uniform_real_distribution<double> unit(0., 1.);
+
+  // Average gap between two flights to cover the whole time span
+  double averageGap = std::max(3600., static_cast<double>(LOGBOOK_TIME_SPAN) / std::max(config.numEntries, 1));
+
+  BulkLoader loader(db, "logbook");
+  loader.begin(config.numEntries);
+  loader.exec("delete from logbook where simulator_id = ?", {static_cast<int>(type)});
+
+  SqlQuery insert(db);
+  insert.prepare("insert into logbook (" + columns.join(", ") + ") values (:" + columns.join(", :") + ")");
+
+  // Airport columns of the loader are null for unknown airports
+  auto airportValues = [](QVariantHash& values, const QString& prefix, const Airport *airport) -> void {
+    values.insert(prefix + "name", airport != nullptr ? airport->name : QVariant());
+    values.insert(prefix + "city", airport != nullptr ? airport->city : QVariant());
+    values.insert(prefix + "state", airport != nullptr && !airport->state.isEmpty() ? airport->state : QVariant());
+    values.insert(prefix + "country", airport != nullptr ? airport->country : QVariant());
+  };
+
+  qint64 startDate = FIRST_START_DATE;
+  for(int entry = 1; entry <= config.numEntries; entry++)
+  {
+    const Aircraft& ac = aircraft.at(aircraftDist(random));
+    const Airport& from = airports.at(airportDist(random));
+    const Airport *to = &airports.at(airportDist(random));
+
+    // Gliders and helicopters often return to the departure airport
+    bool local = (ac.type == AIRCRAFT_GLIDER || ac.type == AIRCRAFT_ROTARY) && unit(random) < 0.4;
+    if(local)
+      to = &from;
+    else
+    {
+      for(int i = 0; i < 10 && to == &from; i++)
+        to = &airports.at(airportDist(random));
+    }
+
+    double distance = distanceNm(from.lonX, from.latY, to->lonX, to->latY);
+    double hours = local ? 0.3 + unit(random) * 2. : distance / ac.speedKts + 0.3;
+    hours = std::min(hours * (0.9 + unit(random) * 0.2), 16.);
+
+    float totalTime = static_cast<float>(hours);
+    float nightTime = unit(random) < 0.3 ? static_cast<float>(hours * unit(random)) : 0.f;
+    float instrumentTime = unit(random) < 0.4 ? static_cast<float>(hours * unit(random) * 0.6) : 0.f;
+
+    const Airport *fromAirport = &from, *toAirport = to;
+    quint32 date = static_cast<quint32>(startDate);
+
+    // Add the invalid entries that the import filter of the GUI removes
+    bool invalid = false;
+    if(chance(config.emptyIcaoPercent))
+    {
+      if(chance(50.))
+        fromAirport = toAirport = nullptr;
+      else if(chance(50.))
+        fromAirport = nullptr;
+      else
+        toAirport = nullptr;
+      invalid = true;
+    }
+    if(chance(config.zeroDatePercent))
+    {
+      date = 0;
+      invalid = true;
+    }
+    if(chance(config.shortFlightPercent))
+    {
+      totalTime = static_cast<float>(0.005 + unit(random) * 0.07);
+      nightTime = instrumentTime = 0.f;
+      invalid = true;
+    }
+    if(invalid)
+      numInvalid++;
+
+    QString description;
+    if(unit(random) < 0.4)
+      description = QString("Flight %1 from %2 to %3").arg(entry).arg(from.city).arg(to->city);
+
+    QVariantHash values;
+    values.insert("simulator_id", static_cast<int>(type));
+    values.insert("logbook_id", entry);
+    values.insert("startdate", date);
+    values.insert("airport_from_icao", fromAirport != nullptr ? fromAirport->icao : QString());
+    values.insert("airport_to_icao", toAirport != nullptr ? toAirport->icao : QString());
+    airportValues(values, "airport_from_", fromAirport);
+    airportValues(values, "airport_to_", toAirport);
+    values.insert("distance", fromAirport != nullptr && toAirport != nullptr ? distance : QVariant());
+    values.insert("description", description);
+    values.insert("total_time", totalTime);
+    values.insert("night_time", nightTime);
+    values.insert("instrument_time", instrumentTime);
+    values.insert("aircraft_reg", ac.reg);
+    values.insert("aircraft_descr", ac.descr);
+    values.insert("aircraft_type", ac.type);
+    values.insert("aircraft_flags", ac.flags);
+    if(fromAirport != nullptr && toAirport != nullptr)
+      values.insert("visits", fromAirport->icao + " " + toAirport->icao);
+    else
+      values.insert("visits", QString());
+
+    for(const QString& col : columns)
+      insert.bindValue(":" + col, values.value(col));
+    insert.exec();
+
+    startDate += static_cast<qint64>(hours * 3600. + averageGap * 2. * unit(random));
+  }
+
+  loader.finish();
+  qDebug() << "Inserted" << config.numEntries << "logbook entries" << numInvalid << "invalid for simulator"
+           << simulatorDirName(type);
+}
@@ -0,0 +1,131 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_LOGBOOKGENERATOR_H
+#define LITTLELOGBOOK_LOGBOOKGENERATOR_H
+
+#include "fs/fspaths.h"
+
+#include <QString>
+#include <QVector>
+
+#include <random>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+} // namespace sql
+} // namespace atools
+
+/* Parameters for generated logbooks. Percentages are 0 to 100. */
+struct LogbookGeneratorConfig
+{
+  int numEntries = 10000;
+  int numAirports = 2000;
+  int numAircraft = 25;
+
+  /* Zipf exponent for picking airports. 0 is uniform, 1 gives a few busy hubs
+   * and a long tail of rarely visited airports like real logbooks. */
+  double airportSkew = 1.;
+
+  /* Relative weights for aircraft type unknown, glider, fixed wing, amphibious and rotor */
+  QVector<double> aircraftTypeWeights = {1., 2., 85., 4., 8.};
+
+  /* Fixed wing and amphibious aircraft with more than one engine */
+  double multiEnginePercent = 30.;
+
+  /* Invalid entries as removed by the import filter of the GUI */
+  double emptyIcaoPercent = 2.; /* Half of these have both airports empty */
+  double zeroDatePercent = 1.;
+  double shortFlightPercent = 3.; /* Total time below five minutes */
+
+  quint32 seed = 1;
+
+  /* Recorded Logbook.BIN file that the atools loader accepts. It is imported first
+   * to create the logbook table of the loader. */
+  QString sampleLogbook;
+};
+
+/*
+ * Writes synthetic runways.xml files and fills the logbook table with matching
+ * synthetic entries. Used as fixtures for benchmarks and stress tests.
+ *
+ * No Logbook.BIN files are written since the file format is not documented. The
+ * logbook table is created by importing the recorded sample logbook with the
+ * atools loader. The entries of the simulator are then replaced by generated ones
+ * holding the same columns the loader fills.
+ *
+ * Output is deterministic for the same configuration and simulator type.
+ */
+class LogbookGenerator
+{
+public:
+  LogbookGenerator(const LogbookGeneratorConfig& generatorConfig);
+
+  /* Write runways.xml into a subdirectory per simulator and a database containing
+   * airports and entries of all simulators. Throws atools::Exception on errors. */
+  void generate(const QString& directory, const QVector<atools::fs::SimulatorType>& types);
+
+  /* Write a runways.xml file containing all generated airports */
+  void writeRunways(const QString& filename);
+
+  /* Import the sample logbook for the simulator and replace its entries with
+   * generated ones. Throws atools::Exception on errors. */
+  void createLogbook(atools::sql::SqlDatabase *db, atools::fs::SimulatorType type);
+
+  /* Number of invalid entries written by the last createLogbook() call */
+  int getNumInvalid() const
+  {
+    return numInvalid;
+  }
+
+  /* Subdirectory name used by generate() */
+  static QString simulatorDirName(atools::fs::SimulatorType type);
+
+private:
+  struct Airport
+  {
+    QString icao, name, city, state, country;
+    double lonX, latY;
+    int altitude, runwayLength;
+    bool hasIls, hasLights;
+  };
+
+  struct Aircraft
+  {
+    QString reg, descr;
+    quint16 type, flags;
+    int speedKts;
+  };
+
+  void createAirports();
+  void createAircraft();
+
+  /* Replace the entries of the simulator in the logbook table */
+  void insertEntries(atools::sql::SqlDatabase *db, atools::fs::SimulatorType type);
+
+  /* Returns true with the given percentage */
+  bool chance(double percent);
+
+  LogbookGeneratorConfig config;
+  std::mt19937 random;
+  QVector<Airport> airports;
+  QVector<Aircraft> aircraft;
+  int numInvalid = 0;
+};
+
+#endif // LITTLELOGBOOK_LOGBOOKGENERATOR_H
@@ -0,0 +1,48 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "bench/processio.h"
+
+#include <QFile>
+
+#if defined(Q_OS_WIN32)
+#include <windows.h>
+#endif
+
+qint64 ProcessIo::bytesWritten()
+{
+#if defined(Q_OS_LINUX)
+  QFile file("/proc/self/io");
+  if(file.open(QIODevice::ReadOnly))
+  {
+    for(const QByteArray& line : file.readAll().split('\n'))
+      if(line.startsWith("wchar:"))
+        return line.mid(6).trimmed().toLongLong();
+  }
+  return -1;
+
+#elif defined(Q_OS_WIN32)
+  IO_COUNTERS counters;
+  if(GetProcessIoCounters(GetCurrentProcess(), &counters))
+    return static_cast<qint64>(counters.WriteTransferCount);
+  return -1;
+
+#else
+  return -1;
+
+#endif
+}
@@ -0,0 +1,35 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_PROCESSIO_H
+#define LITTLELOGBOOK_PROCESSIO_H
+
+#include <QtGlobal>
+
+/*
+ * I/O counters of the running process.
+ */
+class ProcessIo
+{
+public:
+  /* Total number of bytes passed to write calls by this process including
+   * database, journal and WAL writes. -1 if not available on the platform. */
+  static qint64 bytesWritten();
+
+};
+
+#endif // LITTLELOGBOOK_PROCESSIO_H
@@ -0,0 +1,112 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "bench/processmemory.h"
+
+#include <QFile>
+
+#if defined(Q_OS_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+#if defined(Q_OS_LINUX)
+/* Read a "VmXXX:   1234 kB" line from /proc/self/status */
+qint64 procStatusValue(const QByteArray& key)
+{
+  QFile file("/proc/self/status");
+  if(file.open(QIODevice::ReadOnly))
+  {
+    for(const QByteArray& line : file.readAll().split('\n'))
+      if(line.startsWith(key + ":"))
+      {
+        QList<QByteArray> fields = line.mid(key.size() + 1).simplified().split(' ');
+        return fields.first().toLongLong() * 1024;
+      }
+  }
+  return -1;
+}
+
+#endif
+
+}
+
+qint64 ProcessMemory::currentRss()
+{
+#if defined(Q_OS_LINUX)
+  return procStatusValue("VmRSS");
+
+#elif defined(Q_OS_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return static_cast<qint64>(counters.WorkingSetSize);
+  return -1;
+
+#else
+  return -1;
+
+#endif
+}
+
+qint64 ProcessMemory::peakRss()
+{
+#if defined(Q_OS_LINUX)
+  return procStatusValue("VmHWM");
+
+#elif defined(Q_OS_WIN32)
+  PROCESS_MEMORY_COUNTERS counters;
+  if(GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+    return static_cast<qint64>(counters.PeakWorkingSetSize);
+  return -1;
+
+#elif defined(Q_OS_MAC)
+  // ru_maxrss is given in bytes on Mac OS X
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) == 0)
+    return static_cast<qint64>(usage.ru_maxrss);
+  return -1;
+
+#elif defined(Q_OS_UNIX)
+  struct rusage usage;
+  if(getrusage(RUSAGE_SELF, &usage) == 0)
+    return static_cast<qint64>(usage.ru_maxrss) * 1024;
+  return -1;
+
+#else
+  return -1;
+
+#endif
+}
+
+bool ProcessMemory::resetPeakRss()
+{
+#if defined(Q_OS_LINUX)
+  // Writing 5 resets VmHWM to the current RSS (kernel 4.0 and later)
+  QFile file("/proc/self/clear_refs");
+  if(file.open(QIODevice::WriteOnly))
+    return file.write("5") == 1;
+  return false;
+
+#else
+  return false;
+
+#endif
+}
@@ -0,0 +1,42 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_PROCESSMEMORY_H
+#define LITTLELOGBOOK_PROCESSMEMORY_H
+
+#include <QtGlobal>
+
+/*
+ * Resident set size of the running process. All values are in bytes and -1
+ * if not available on the platform.
+ */
+class ProcessMemory
+{
+public:
+  /* Current resident set size */
+  static qint64 currentRss();
+
+  /* Highest resident set size since process start or the last resetPeakRss() */
+  static qint64 peakRss();
+
+  /* Set the peak back to the current size. Only supported on Linux.
+   * @return false if the peak cannot be reset */
+  static bool resetPeakRss();
+
+};
+
+#endif // LITTLELOGBOOK_PROCESSMEMORY_H
@@ -0,0 +1,304 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "bench/querybenchmark.h"
+
+#include "bench/benchmarkdatabase.h"
+#include "bench/benchmarkreport.h"
+#include "table/columnlist.h"
+#include "table/formatter.h"
+#include "table/querybuilder.h"
+#include "table/sqlmodel.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "exception.h"
+#include "logging/loggingdefs.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+
+#include <algorithm>
+#include <functional>
+
+using atools::sql::SqlQuery;
+
+namespace {
+
+/* Conditions added one by one. Values use the search field syntax and match a
+ * good part of the generated entries so "or" queries return many rows. */
+struct Condition
+{
+  const char *column;
+  QVariant value;
+};
+
+const Condition CONDITIONS[QueryBenchmark::MAX_CONDITIONS] =
+{
+  {"airport_from_icao", "K*"},
+  {"airport_to_icao", "K*"},
+  {"aircraft_reg", "N1*"},
+  {"airport_from_name", "*a*"},
+  {"airport_to_name", "*a*"},
+  {"airport_from_city", "*o*"},
+  {"airport_to_city", "*o*"},
+  {"airport_from_state", "-"},
+  {"airport_to_state", "-"},
+  {"airport_from_country", "*"},
+  {"airport_to_country", "*"},
+  {"description", "*Flight*"},
+  {"aircraft_descr", "*e*"},
+  {"aircraft_type", 2},
+  {"aircraft_flags", 0}
+};
+
+/* Number of rows visible in a typical table view */
+const int VIEWPORT_ROWS = 40;
+
+/* Calls per formatter measurement */
+const int FORMATTER_CALLS = 100000;
+
+/* Simulator and entry number of all rows returned by the view query */
+QStringList readKeys(BenchmarkDatabase& database, const QueryBuilder& builder)
+{
+  QSqlQuery query(database.getDatabase()->getQSqlDatabase());
+  query.setForwardOnly(true);
+  query.prepare(builder.getViewQuery());
+  SelectStatement::bindValues(query, builder.getViewBinds());
+  if(!query.exec())
+    throw atools::Exception("Query failed: " + query.lastError().text());
+
+  int simIndex = query.record().indexOf("simulator_id"), idIndex = query.record().indexOf("logbook_id");
+  if(simIndex == -1 || idIndex == -1)
+    throw atools::Exception("View query does not select simulator_id and logbook_id");
+
+  QStringList keys;
+  while(query.next())
+    keys.append(query.value(simIndex).toString() + "|" + query.value(idIndex).toString());
+  return keys;
+}
+
+}
+
+QueryBenchmark::QueryBenchmark(const QVector<int>& databaseSizes, const QString& sampleLogbookFile,
+                               int numIterations)
+  : sizes(databaseSizes), sampleLogbook(sampleLogbookFile), iterations(numIterations)
+{
+}
+
+void QueryBenchmark::run(BenchmarkReport& report)
+{
+  QJsonArray sizeArr;
+  for(int size : sizes)
+    sizeArr.append(size);
+  report.setProperty("sizes", sizeArr);
+  report.setProperty("iterations", iterations);
+
+  for(int size : sizes)
+  {
+    LogbookGeneratorConfig config;
+    config.numEntries = size;
+    config.sampleLogbook = sampleLogbook;
+    BenchmarkDatabase database(config, atools::fs::P3D_V3);
+    database.create();
+
+    ColumnList columns(true /* airports */);
+    SqlModel model(nullptr, database.getDatabase(), database.getConnectionPool(), &columns, true);
+
+    runConditions(report, database, model);
+    runFetchAll(report, database, model);
+    runData(report, database, model);
+  }
+
+  runFormatters(report);
+}
+
+void QueryBenchmark::runConditions(BenchmarkReport& report, BenchmarkDatabase& database, SqlModel& model)
+{
+  for(const QString& op : {QString("and"), QString("or")})
+  {
+    model.reset();
+    model.filterOperator(op);
+
+    for(int numConditions = 0; numConditions <= MAX_CONDITIONS; numConditions++)
+    {
+      if(numConditions > 0)
+      {
+        const Condition& cond = CONDITIONS[numConditions - 1];
+        model.filter(cond.column, cond.value);
+      }
+
+      QueryBuilder builder(model.getQueryBuilder());
+      checkFilterTable(database, builder);
+
+      // Statement building only
+      QVector<qint64> buildTimes = BenchmarkReport::measure(iterations, [&builder]() {builder.build(); });
+
+      // Count query as run on each change of the search
+      QVector<qint64> countTimes = BenchmarkReport::measure(iterations, [&]() {
+        SqlQuery query(database.getDatabase());
+        query.prepare(builder.getCountQuery());
+        SelectStatement::bindValues(query, builder.getCountBinds());
+        query.exec();
+        query.next();
+      });
+
+      // First page as read into the model
+      int firstPageRows = 0;
+      QVector<qint64> firstPageTimes = BenchmarkReport::measure(iterations, [&]() {
+        QSqlQuery query(database.getDatabase()->getQSqlDatabase());
+        query.setForwardOnly(true);
+        query.prepare(builder.getSqlQuery());
+        SelectStatement::bindValues(query, builder.getSqlBinds());
+        query.exec();
+        firstPageRows = 0;
+        while(firstPageRows < SqlModel::FETCH_SIZE && query.next())
+          firstPageRows++;
+      });
+
+      // Complete round trip of SqlModel::buildQuery() including model reset
+      QVector<qint64> modelTimes = BenchmarkReport::measure(iterations, [&model, &op]() {
+        model.filterOperator(op);
+      });
+
+      QJsonObject values;
+      values.insert("size", database.getNumEntries());
+      values.insert("operator", op);
+      values.insert("conditions", numConditions);
+      values.insert("rows", model.getTotalRowCount());
+      values.insert("firstPageRows", firstPageRows);
+      values.insert("filterTable", !builder.getFilterTable().isEmpty());
+      values.insert("buildMedianMs", BenchmarkReport::medianMs(buildTimes));
+      values.insert("countMedianMs", BenchmarkReport::medianMs(countTimes));
+      values.insert("firstPageMedianMs", BenchmarkReport::medianMs(firstPageTimes));
+      values.insert("buildQueryMedianMs", BenchmarkReport::medianMs(modelTimes));
+      values.insert("buildQueryMinMs", BenchmarkReport::minimumMs(modelTimes));
+      report.addResult(QString("conditions/%1/%2/%3").arg(database.getNumEntries()).arg(op).arg(numConditions),
+                       values);
+    }
+  }
+}
+
+void QueryBenchmark::checkFilterTable(BenchmarkDatabase& database, const QueryBuilder& builder)
+{
+  if(builder.getFilterTable().isEmpty())
+    return;
+
+  QueryBuilder plain(builder);
+  plain.setFilterTable(QString());
+  plain.build();
+
+  QStringList cachedKeys = readKeys(database, builder), plainKeys = readKeys(database, plain);
+  if(cachedKeys != plainKeys)
+    throw atools::Exception(QString("Filter table selects %1 rows but conditions select %2 rows for %3").
+                            arg(cachedKeys.size()).arg(plainKeys.size()).arg(builder.getStateDescription()));
+}
+
+void QueryBenchmark::runFetchAll(BenchmarkReport& report, BenchmarkDatabase& database, SqlModel& model)
+{
+  int rows = 0;
+  QVector<qint64> times = BenchmarkReport::measure(iterations, [&model, &rows]() {
+    model.reset();
+    while(model.canFetchMore(QModelIndex()))
+      model.fetchMore(QModelIndex());
+    rows = model.rowCount();
+  });
+
+  QJsonObject values = BenchmarkReport::timesToJson(times);
+  values.insert("size", database.getNumEntries());
+  values.insert("rows", rows);
+  values.insert("rowsPerSecond", BenchmarkReport::perSecond(rows, BenchmarkReport::minimumMs(times)));
+  report.addResult(QString("fetchAll/%1").arg(database.getNumEntries()), values);
+}
+
+void QueryBenchmark::runData(BenchmarkReport& report, BenchmarkDatabase& database, SqlModel& model)
+{
+  model.reset();
+
+  // Call through the base class like the view does
+  const QAbstractItemModel& itemModel = model;
+  int rows = std::min(VIEWPORT_ROWS, itemModel.rowCount());
+  int cols = itemModel.columnCount();
+
+  struct Role
+  {
+    const char *name;
+    int role;
+  };
+
+  const Role roles[] =
+  {
+    {"display", Qt::DisplayRole},
+    {"tooltip", Qt::ToolTipRole},
+    {"background", Qt::BackgroundRole},
+    {"alignment", Qt::TextAlignmentRole}
+  };
+
+  for(const Role& role : roles)
+  {
+    QVector<qint64> times = BenchmarkReport::measure(iterations, [&]() {
+      for(int row = 0; row < rows; row++)
+        for(int col = 0; col < cols; col++)
+          itemModel.data(itemModel.index(row, col), role.role);
+    });
+
+    int calls = rows * cols;
+    QJsonObject values = BenchmarkReport::timesToJson(times);
+    values.insert("size", database.getNumEntries());
+    values.insert("calls", calls);
+    values.insert("nsPerCall", calls > 0 ? BenchmarkReport::minimumMs(times) * 1000000. / calls : 0.);
+    report.addResult(QString("data/%1/%2").arg(database.getNumEntries()).arg(role.name), values);
+  }
+}
+
+void QueryBenchmark::runFormatters(BenchmarkReport& report)
+{
+  struct Formatter
+  {
+    const char *name;
+    std::function<QString(int i)> func;
+  };
+
+  const QVector<Formatter> formatters =
+  {
+    {"formatDate", [](int i) {return formatter::formatDate(1262304000 + i * 3917); }},
+    {"formatDateLong", [](int i) {return formatter::formatDateLong(1262304000 + i * 3917); }},
+    {"formatMinutesHours", [](int i) {return formatter::formatMinutesHours(i / 97.); }},
+    {"formatMinutesHoursLong", [](int i) {return formatter::formatMinutesHoursLong(i / 97.); }},
+    {"formatMinutesHoursDays", [](int i) {return formatter::formatMinutesHoursDays(i / 7.); }},
+    {"formatMinutesHoursDaysLong", [](int i) {return formatter::formatMinutesHoursDaysLong(i / 7.); }},
+    {"formatDoubleUnit", [](int i) {return formatter::formatDoubleUnit(i * 1.7); }},
+    {"formatDoubleUnitWithUnit", [](int i) {return formatter::formatDoubleUnit(i * 1.7, "NM", 1); }}
+  };
+
+  for(const Formatter& fmt : formatters)
+  {
+    int totalLength = 0;
+    QVector<qint64> times = BenchmarkReport::measure(iterations, [&fmt, &totalLength]() {
+      for(int i = 0; i < FORMATTER_CALLS; i++)
+        totalLength += fmt.func(i).size();
+    });
+    qDebug() << fmt.name << "total length" << totalLength;
+
+    QJsonObject values = BenchmarkReport::timesToJson(times);
+    values.insert("calls", FORMATTER_CALLS);
+    values.insert("nsPerCall", BenchmarkReport::minimumMs(times) * 1000000. / FORMATTER_CALLS);
+    report.addResult(QString("formatter/%1").arg(fmt.name), values);
+  }
+}
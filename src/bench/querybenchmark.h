@@ -0,0 +1,65 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_QUERYBENCHMARK_H
+#define LITTLELOGBOOK_QUERYBENCHMARK_H
+
+#include <QString>
+#include <QVector>
+
+class BenchmarkReport;
+class BenchmarkDatabase;
+class QueryBuilder;
+class SqlModel;
+
+/*
+ * Measures the interactive hot path of the table view against generated
+ * databases of several sizes:
+ * query building with 0 to 15 conditions combined by "and" and "or", count
+ * query, first page, fetching all rows, SqlModel::data() for each role across a
+ * viewport and all formatter functions.
+ *
+ * The databases use P3D v3 to cover a simulator_id other than the first one.
+ * Each condition combination is checked to select the same rows with and
+ * without the filter table. A mismatch throws atools::Exception.
+ *
+ * Needs a QApplication since the model uses the palette.
+ */
+class QueryBenchmark
+{
+public:
+  QueryBenchmark(const QVector<int>& databaseSizes, const QString& sampleLogbookFile, int numIterations);
+
+  /* Run all measurements and add the results to the report */
+  void run(BenchmarkReport& report);
+
+  /* Maximum number of conditions that are tested */
+  static const int MAX_CONDITIONS = 15;
+
+private:
+  void runConditions(BenchmarkReport& report, BenchmarkDatabase& database, SqlModel& model);
+  void checkFilterTable(BenchmarkDatabase& database, const QueryBuilder& builder);
+  void runFetchAll(BenchmarkReport& report, BenchmarkDatabase& database, SqlModel& model);
+  void runData(BenchmarkReport& report, BenchmarkDatabase& database, SqlModel& model);
+  void runFormatters(BenchmarkReport& report);
+
+  QVector<int> sizes;
+  QString sampleLogbook;
+  int iterations;
+};
+
+#endif // LITTLELOGBOOK_QUERYBENCHMARK_H
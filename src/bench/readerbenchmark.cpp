@@ -0,0 +1,180 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "bench/readerbenchmark.h"
+
+#include "bench/benchmarkreport.h"
+#include "import/logbookcrosscheck.h"
+#include "import/logbookreader.h"
+#include "gui/constants.h"
+#include "fs/lb/logbookloader.h"
+#include "fs/lb/logbookentryfilter.h"
+#include "sql/sqldatabase.h"
+#include "exception.h"
+#include "logging/loggingdefs.h"
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QJsonObject>
+#include <QVector>
+
+#include <functional>
+
+using atools::sql::SqlDatabase;
+
+namespace {
+
+/* Connection name used for the loader database */
+const char *BENCHMARK_CONNECTION = "readerbenchmark";
+
+/* Compare the fields of every n-th record after the runs */
+const int CROSSCHECK_SAMPLE_STEP = 16;
+
+}
+
+ReaderBenchmark::ReaderBenchmark(const QString& logbookFilename, int numIterations)
+  : filename(logbookFilename), iterations(numIterations)
+{
+}
+
+void ReaderBenchmark::run(BenchmarkReport& report)
+{
+  qint64 fileSize = QFileInfo(filename).size();
+  report.setProperty("file", filename);
+  report.setProperty("fileSize", fileSize);
+  report.setProperty("iterations", iterations);
+
+  struct Variant
+  {
+    QString name;
+    std::function<int()> func;
+  };
+
+  QVector<Variant> variants;
+  variants.append({"reader-scan", [this]() -> int {return runReaderScan(); }});
+  variants.append({"reader-decode", [this]() -> int {return runReaderDecode(); }});
+  variants.append({"loader-import", [this]() -> int {return runLoaderImport(); }});
+
+  // Scan and decode are parsing only - the loader also writes into the database
+  // The loader may skip invalid records so only the reader variants have to agree
+  int numReaderRecords = -1;
+  for(const Variant& variant : variants)
+  {
+    QVector<qint64> times;
+    int numRecords = 0;
+    for(int i = 0; i < iterations; i++)
+    {
+      QElapsedTimer timer;
+      timer.start();
+      numRecords = variant.func();
+      times.append(timer.nsecsElapsed());
+    }
+
+    if(variant.name.startsWith("reader-"))
+    {
+      if(numReaderRecords == -1)
+        numReaderRecords = numRecords;
+      else if(numRecords != numReaderRecords)
+        throw atools::Exception(QString("Variant %1 read %2 records but %3 were expected").
+                                arg(variant.name).arg(numRecords).arg(numReaderRecords));
+    }
+
+    double minMs = BenchmarkReport::minimumMs(times);
+
+    QJsonObject values;
+    values.insert("records", numRecords);
+    values.insert("minMs", minMs);
+    values.insert("medianMs", BenchmarkReport::medianMs(times));
+    values.insert("recordsPerSecond", BenchmarkReport::perSecond(numRecords, minMs));
+    values.insert("megabytesPerSecond", BenchmarkReport::perSecond(fileSize, minMs) / (1024. * 1024.));
+    report.addResult(variant.name, values);
+  }
+
+  crossCheck(report);
+}
+
+int ReaderBenchmark::runReaderScan()
+{
+  LogbookReader reader;
+  reader.open(filename);
+
+  LogbookRecord record;
+  while(reader.next(record))
+    ;
+  return reader.getNumRead();
+}
+
+int ReaderBenchmark::runReaderDecode()
+{
+  LogbookReader reader;
+  reader.open(filename);
+
+  // Sum up lengths so the compiler cannot drop the conversions
+  qint64 totalLength = 0;
+  char from[16], to[16];
+  LogbookRecord record;
+  while(reader.next(record))
+  {
+    if(record.airportFrom.toLatin1(from, sizeof(from)))
+      totalLength += record.airportFrom.length;
+    if(record.airportTo.toLatin1(to, sizeof(to)))
+      totalLength += record.airportTo.length;
+
+    totalLength += record.description.toString().size();
+    totalLength += record.aircraftReg.toString().size();
+    totalLength += record.aircraftDescr.toString().size();
+    totalLength += record.visits.toString().size();
+  }
+  qDebug() << "Decoded" << totalLength << "characters";
+  return reader.getNumRead();
+}
+
+int ReaderBenchmark::runLoaderImport()
+{
+  int numLoaded = 0;
+  {
+    SqlDatabase db = SqlDatabase::addDatabase(ll::constants::DATABASE_TYPE, BENCHMARK_CONNECTION);
+    db.setDatabaseName(":memory:");
+    db.open();
+
+    atools::fs::lb::LogbookLoader loader(&db);
+    loader.loadLogbook(filename, atools::fs::FSX, atools::fs::lb::LogbookEntryFilter(), false /* append */);
+    numLoaded = loader.getNumLoaded();
+    db.close();
+  }
+  SqlDatabase::removeDatabase(BENCHMARK_CONNECTION);
+  return numLoaded;
+}
+
+void ReaderBenchmark::crossCheck(BenchmarkReport& report)
+{
+  LogbookCrossCheck check(filename);
+  bool equal = check.run(CROSSCHECK_SAMPLE_STEP);
+
+  QJsonObject values;
+  values.insert("readerRecords", check.getNumReaderRecords());
+  values.insert("loaderRecords", check.getNumLoaderRecords());
+  values.insert("comparedRecords", check.getNumCompared());
+  values.insert("readerOnlyRecords", check.getNumReaderOnly());
+  values.insert("loaderOnlyRecords", check.getNumLoaderOnly());
+  values.insert("mismatches", check.getNumMismatches());
+  report.addResult("crosscheck", values);
+
+  if(!equal)
+    throw atools::Exception(QString("Reader and loader differ for \"%1\": %2").
+                            arg(filename).arg(check.getMismatches().join("; ")));
+}
@@ -0,0 +1,59 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_READERBENCHMARK_H
+#define LITTLELOGBOOK_READERBENCHMARK_H
+
+#include <QString>
+
+class BenchmarkReport;
+
+/*
+ * Compares the memory mapped LogbookReader against the atools LogbookLoader
+ * for a given Logbook.BIN file. The loader can only write into a database so it
+ * loads into an in-memory database. The scan and decode variants show the parsing
+ * part of the reader alone. The reader is not used for imports.
+ *
+ * Throws an exception if the reader variants do not return the same number of
+ * records or if the cross-check finds differences (see LogbookCrossCheck).
+ */
+class ReaderBenchmark
+{
+public:
+  ReaderBenchmark(const QString& logbookFilename, int numIterations);
+
+  /* Run all variants and add the results to the report */
+  void run(BenchmarkReport& report);
+
+private:
+  /* Walk all records without decoding strings. Returns number of records. */
+  int runReaderScan();
+
+  /* Walk all records and decode all strings like an import would */
+  int runReaderDecode();
+
+  /* Load into a temporary in-memory database using the atools loader */
+  int runLoaderImport();
+
+  /* Compare records of reader and loader. Throws an exception on differences. */
+  void crossCheck(BenchmarkReport& report);
+
+  QString filename;
+  int iterations;
+};
+
+#endif // LITTLELOGBOOK_READERBENCHMARK_H
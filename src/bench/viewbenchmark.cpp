@@ -0,0 +1,289 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "bench/viewbenchmark.h"
+
+#include "bench/benchmarkdatabase.h"
+#include "bench/benchmarkreport.h"
+#include "bench/datacallcounter.h"
+#include "table/colum.h"
+#include "table/controller.h"
+#include "table/sqlmodel.h"
+#include "logging/loggingdefs.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QHeaderView>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QKeyEvent>
+#include <QTableView>
+
+#include <algorithm>
+#include <utility>
+
+namespace {
+
+/* Number of page down key presses per iteration */
+const int PAGE_DOWN_FRAMES = 100;
+
+/* Number of end key presses per iteration. Each one fetches the next page. */
+const int END_FRAMES = 10;
+
+/* Font size of the table view as set in the main window */
+const int DEFAULT_FONT_POINT_SIZE = 9;
+
+/* Size of the main window table view */
+const int VIEW_WIDTH = 1280, VIEW_HEIGHT = 800;
+
+/* Roles reported separately. All others are summed up. */
+const std::pair<const char *, int> REPORTED_ROLES[] =
+{
+  {"Display", Qt::DisplayRole},
+  {"Background", Qt::BackgroundRole},
+  {"TextAlignment", Qt::TextAlignmentRole},
+  {"ToolTip", Qt::ToolTipRole}
+};
+
+void sendKey(QTableView& view, int key, Qt::KeyboardModifiers modifiers)
+{
+  QKeyEvent event(QEvent::KeyPress, key, modifiers);
+  QApplication::sendEvent(&view, &event);
+}
+
+/* Set up the view like the one in the main window */
+void setupView(QTableView& view)
+{
+  QFont font(view.font());
+  font.setPointSize(DEFAULT_FONT_POINT_SIZE);
+  view.setFont(font);
+  view.setEditTriggers(QAbstractItemView::NoEditTriggers);
+  view.setTabKeyNavigation(false);
+  view.setAlternatingRowColors(true);
+  view.setSelectionMode(QAbstractItemView::ExtendedSelection);
+  view.setSelectionBehavior(QAbstractItemView::SelectRows);
+  view.setHorizontalScrollMode(QAbstractItemView::ScrollPerPixel);
+  view.setSortingEnabled(true);
+  view.setWordWrap(false);
+  view.horizontalHeader()->setMinimumSectionSize(5);
+  view.horizontalHeader()->setStretchLastSection(false);
+  view.horizontalHeader()->setSectionsMovable(true);
+  view.resize(VIEW_WIDTH, VIEW_HEIGHT);
+}
+
+/* Logical index of the first visible column */
+int firstVisibleColumn(const QTableView& view)
+{
+  QHeaderView *header = view.horizontalHeader();
+  for(int i = 0; i < header->count(); i++)
+  {
+    int logical = header->logicalIndex(i);
+    if(!header->isSectionHidden(logical))
+      return logical;
+  }
+  return 0;
+}
+
+/* Sorted copy of the frame times in nanoseconds */
+QVector<qint64> sorted(QVector<qint64> frames)
+{
+  std::sort(frames.begin(), frames.end());
+  return frames;
+}
+
+}
+
+ViewBenchmark::ViewBenchmark(const QVector<int>& databaseSizes, const QString& sampleLogbookFile,
+                             int numIterations)
+  : sizes(databaseSizes), sampleLogbook(sampleLogbookFile), iterations(numIterations)
+{
+}
+
+void ViewBenchmark::run(BenchmarkReport& report)
+{
+  QJsonArray sizeArr;
+  for(int size : sizes)
+    sizeArr.append(size);
+  report.setProperty("sizes", sizeArr);
+  report.setProperty("iterations", iterations);
+  report.setProperty("platform", QApplication::platformName());
+
+  typedef void (ViewBenchmark::*Scenario)(QTableView&, Controller&, QVector<qint64>&);
+  const QVector<std::pair<QString, Scenario> > scenarios(
+  {
+    {"pageDown", &ViewBenchmark::runPageDown},
+    {"end", &ViewBenchmark::runEnd},
+    {"sort", &ViewBenchmark::runSort},
+    {"group", &ViewBenchmark::runGroup},
+    {"zoom", &ViewBenchmark::runZoom}
+  });
+
+  for(int size : sizes)
+  {
+    LogbookGeneratorConfig config;
+    config.numEntries = size;
+    config.sampleLogbook = sampleLogbook;
+    BenchmarkDatabase database(config);
+    database.create();
+
+    QTableView view;
+    setupView(view);
+    view.show();
+
+    // Do not touch the column layout saved by the GUI
+    Controller controller(&view, database.getDatabase(), database.getConnectionPool(), &view);
+    controller.setPersistViewState(false);
+    controller.setHasLogbook(true);
+    controller.setHasAirports(true);
+    controller.prepareModel();
+    Controller::setTableViewFontSize(&view, view.font().pointSize());
+
+    // Count data() calls between view and model
+    SqlModel *model = controller.getSqlModel();
+    DataCallCounter counter;
+    counter.setSourceModel(model);
+    QItemSelectionModel *selection = view.selectionModel();
+    view.setModel(&counter);
+    delete selection;
+
+    for(const std::pair<QString, Scenario>& scenario : scenarios)
+    {
+      QVector<qint64> frames;
+      QHash<int, qint64> dataCalls;
+      qint64 allDataCalls = 0;
+
+      for(int i = 0; i < iterations; i++)
+      {
+        // Start each iteration with the default view scrolled to the top
+        controller.resetView();
+        Controller::setTableViewFontSize(&view, DEFAULT_FONT_POINT_SIZE);
+        frame(view, [&view]() {view.scrollToTop(); });
+        counter.reset();
+
+        (this->*scenario.second)(view, controller, frames);
+
+        for(int role = 0; role <= Qt::UserRole; role++)
+        {
+          qint64 count = counter.getCount(role);
+          dataCalls[role] += count;
+          allDataCalls += count;
+        }
+      }
+
+      QVector<qint64> sortedFrames = sorted(frames);
+      int numFrames = std::max(sortedFrames.size(), 1);
+
+      QJsonObject values = BenchmarkReport::timesToJson(frames);
+      values.insert("frames", frames.size());
+      values.insert("p95Ms", sortedFrames.isEmpty() ?
+                    0. : sortedFrames.at(sortedFrames.size() * 95 / 100) / 1000000.);
+      values.insert("maxMs", sortedFrames.isEmpty() ? 0. : sortedFrames.last() / 1000000.);
+      values.insert("loadedRows", model->rowCount());
+
+      qint64 otherDataCalls = allDataCalls;
+      for(const std::pair<const char *, int>& role : REPORTED_ROLES)
+      {
+        values.insert(QString("data%1PerFrame").arg(role.first),
+                      static_cast<double>(dataCalls.value(role.second)) / numFrames);
+        otherDataCalls -= dataCalls.value(role.second);
+      }
+      values.insert("dataOtherPerFrame", static_cast<double>(otherDataCalls) / numFrames);
+      values.insert("dataPerFrame", static_cast<double>(allDataCalls) / numFrames);
+
+      report.addResult("view/" + QString::number(size) + "/" + scenario.first, values);
+    }
+  }
+}
+
+qint64 ViewBenchmark::frame(QTableView& view, const std::function<void()>& action)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  action();
+
+  // Layout changes are delayed by the view - process them and paint synchronously
+  QApplication::processEvents();
+  view.viewport()->repaint();
+  return timer.nsecsElapsed();
+}
+
+void ViewBenchmark::runPageDown(QTableView& view, Controller& controller, QVector<qint64>& frames)
+{
+  Q_UNUSED(controller);
+  view.setCurrentIndex(view.model()->index(0, firstVisibleColumn(view)));
+
+  for(int i = 0; i < PAGE_DOWN_FRAMES; i++)
+    frames.append(frame(view, [&view]() {sendKey(view, Qt::Key_PageDown, Qt::NoModifier); }));
+}
+
+void ViewBenchmark::runEnd(QTableView& view, Controller& controller, QVector<qint64>& frames)
+{
+  Q_UNUSED(controller);
+  view.setCurrentIndex(view.model()->index(0, firstVisibleColumn(view)));
+
+  // Moving to the last loaded row lets the view fetch the next page
+  for(int i = 0; i < END_FRAMES; i++)
+    frames.append(frame(view, [&view]() {sendKey(view, Qt::Key_End, Qt::ControlModifier); }));
+}
+
+void ViewBenchmark::runSort(QTableView& view, Controller& controller, QVector<qint64>& frames)
+{
+  SqlModel *model = controller.getSqlModel();
+
+  for(int col = 0; col < model->columnCount(); col++)
+  {
+    const Column *column = controller.getColumn(col);
+    if(view.isColumnHidden(col) || column == nullptr || !column->isSort())
+      continue;
+
+    for(Qt::SortOrder order : {Qt::AscendingOrder, Qt::DescendingOrder})
+      frames.append(frame(view, [&view, col, order]() {view.sortByColumn(col, order); }));
+  }
+}
+
+void ViewBenchmark::runGroup(QTableView& view, Controller& controller, QVector<qint64>& frames)
+{
+  SqlModel *model = controller.getSqlModel();
+
+  // Column indexes change while grouped - remember names
+  QStringList groupColumns;
+  for(int col = 0; col < model->columnCount(); col++)
+  {
+    const Column *column = controller.getColumn(col);
+    if(!view.isColumnHidden(col) && column != nullptr && column->isGroup())
+      groupColumns.append(column->getColumnName());
+  }
+
+  for(const QString& name : groupColumns)
+  {
+    int col = model->record().indexOf(name);
+    frames.append(frame(view, [&controller, model, col]() {controller.groupByColumn(model->index(0, col)); }));
+    frames.append(frame(view, [&controller]() {controller.ungroup(); }));
+  }
+}
+
+void ViewBenchmark::runZoom(QTableView& view, Controller& controller, QVector<qint64>& frames)
+{
+  Q_UNUSED(controller);
+
+  for(int size = Controller::MIN_FONT_POINT_SIZE; size <= Controller::MAX_FONT_POINT_SIZE; size++)
+    frames.append(frame(view, [&view, size]() {Controller::setTableViewFontSize(&view, size); }));
+
+  for(int size = Controller::MAX_FONT_POINT_SIZE; size >= Controller::MIN_FONT_POINT_SIZE; size--)
+    frames.append(frame(view, [&view, size]() {Controller::setTableViewFontSize(&view, size); }));
+}
@@ -0,0 +1,65 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_VIEWBENCHMARK_H
+#define LITTLELOGBOOK_VIEWBENCHMARK_H
+
+#include <QString>
+#include <QVector>
+
+#include <functional>
+
+class BenchmarkReport;
+class Controller;
+class QTableView;
+
+/*
+ * Measures the table view with the real Controller and SqlModel on generated
+ * databases. Scrolling by page down and end keys, sorting by each column,
+ * grouping by each column and zooming through all font sizes are scripted.
+ * Each step is one frame which is the time for the action, processing of
+ * pending events and a synchronous repaint of the viewport.
+ *
+ * Reports frame times and the number of SqlModel::data() calls per frame and role
+ * as counted by a DataCallCounter proxy between view and model.
+ * Needs a QApplication and is meant to run on the offscreen platform.
+ */
+class ViewBenchmark
+{
+public:
+  ViewBenchmark(const QVector<int>& databaseSizes, const QString& sampleLogbookFile, int numIterations);
+
+  /* Run all measurements and add the results to the report */
+  void run(BenchmarkReport& report);
+
+private:
+  void runPageDown(QTableView& view, Controller& controller, QVector<qint64>& frames);
+  void runEnd(QTableView& view, Controller& controller, QVector<qint64>& frames);
+  void runSort(QTableView& view, Controller& controller, QVector<qint64>& frames);
+  void runGroup(QTableView& view, Controller& controller, QVector<qint64>& frames);
+  void runZoom(QTableView& view, Controller& controller, QVector<qint64>& frames);
+
+  /* Execute action, process events and paint the view.
+   * @return frame time in nanoseconds */
+  qint64 frame(QTableView& view, const std::function<void()>& action);
+
+  QVector<int> sizes;
+  QString sampleLogbook;
+  int iterations;
+};
+
+#endif // LITTLELOGBOOK_VIEWBENCHMARK_H
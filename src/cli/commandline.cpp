@@ -0,0 +1,668 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "cli/commandline.h"
+
+#include "bench/benchmarkreport.h"
+#include "bench/exportbenchmark.h"
+#include "bench/importbenchmark.h"
+#include "bench/logbookgenerator.h"
+#include "bench/querybenchmark.h"
+#include "bench/readerbenchmark.h"
+#include "bench/viewbenchmark.h"
+#include "cli/queryexportsource.h"
+#include "diag/slowquerylog.h"
+#include "export/csvexporter.h"
+#include "export/htmlexporter.h"
+#include "export/kmlexporter.h"
+#include "import/airportimporter.h"
+#include "import/logbookcrosscheck.h"
+#include "import/logbookimporter.h"
+#include "table/columnlist.h"
+#include "table/querybuilder.h"
+#include "gui/constants.h"
+#include "settings/settings.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlutil.h"
+#include "exception.h"
+#include "logging/loggingdefs.h"
+
+#include <QCoreApplication>
+#include <QDate>
+#include <QHash>
+#include <QLoggingCategory>
+
+#include <algorithm>
+#include <cstdio>
+
+using atools::sql::SqlDatabase;
+using atools::sql::SqlUtil;
+using atools::settings::Settings;
+
+namespace {
+
+/* Options that select a tool */
+const QStringList TOOL_OPTIONS({"--benchmark-reader", "--check-logbook", "--benchmark-query", "--benchmark-export",
+                                "--benchmark-import", "--benchmark-view", "--generate", "--import-logbook", "--import-runways",
+                                "--export-csv", "--export-html", "--export-kml"});
+
+/* Tools that need a QApplication. These run on the offscreen platform if no other is given. */
+const QStringList GUI_TOOL_OPTIONS({"--benchmark-query", "--benchmark-view"});
+
+/* Check if any of the options is given on the command line */
+bool hasOption(int argc, char *argv[], const QStringList& options)
+{
+  for(int i = 1; i < argc; i++)
+  {
+    QString arg = QString::fromLocal8Bit(argv[i]);
+    for(const QString& opt : options)
+      if(arg == opt || arg.startsWith(opt + "="))
+        return true;
+  }
+  return false;
+}
+
+/* Connection name used for imports and exports */
+const char *COMMANDLINE_CONNECTION = "commandline";
+
+const QCommandLineOption BENCHMARK_READER_OPTION("benchmark-reader",
+                                                 "Compare the memory mapped reader against the "
+                                                 "logbook loader for <logbook>.",
+                                                 "logbook");
+
+const QCommandLineOption CHECK_LOGBOOK_OPTION("check-logbook",
+                                              "Compare all records of the memory mapped reader and the "
+                                              "logbook loader for <logbook>. Fails on any difference.",
+                                              "logbook");
+
+const QCommandLineOption DATABASE_OPTION("database",
+                                         "Use database <file> instead of the one in the settings directory.",
+                                         "file");
+
+const QCommandLineOption SIMULATOR_OPTION("simulator",
+                                          "Simulator <type> for imports and the export filter. "
+                                          "One of fsx, fsxse, p3dv2 or p3dv3 (default fsx for imports).",
+                                          "type");
+
+const QCommandLineOption IMPORT_LOGBOOK_OPTION("import-logbook",
+                                               "Import <logbook> file into the database.",
+                                               "logbook");
+
+const QCommandLineOption IMPORT_RUNWAYS_OPTION("import-runways",
+                                               "Import airports from <runways> XML file into the database "
+                                               "before the logbook.",
+                                               "runways");
+
+const QCommandLineOption FILTER_OPTION("filter",
+                                       "Add a search <condition> like \"airport_from_icao=ED*\" using "
+                                       "the search field syntax. Use \"column==value\" for numbers "
+                                       "and \"column>=value\" or \"column<=value\" for ranges of "
+                                       "startdate (yyyy-MM-dd), distance and times (hours). "
+                                       "Can be given more than once.",
+                                       "condition");
+
+const QCommandLineOption FILTER_OPERATOR_OPTION("filter-operator",
+                                                "Combine filters with <operator> \"and\" (default) or \"or\".",
+                                                "operator", "and");
+
+const QCommandLineOption GROUP_BY_OPTION("group-by",
+                                         "Group the result by <column>. Up to three comma separated "
+                                         "columns create nested groups. Exports contain the groups of "
+                                         "the last column without subtotals.",
+                                         "column");
+
+const QCommandLineOption SORT_OPTION("sort",
+                                     "Sort by <column> with optional order like \"distance:desc\".",
+                                     "column");
+
+const QCommandLineOption EXPORT_CSV_OPTION("export-csv",
+                                           "Export the query result to CSV <file>.",
+                                           "file");
+
+const QCommandLineOption EXPORT_HTML_OPTION("export-html",
+                                            "Export the query result to HTML <file>.",
+                                            "file");
+
+const QCommandLineOption EXPORT_KML_OPTION("export-kml",
+                                           "Export the query result to Google Earth KML <file>.",
+                                           "file");
+
+const QCommandLineOption GENERATE_OPTION("generate",
+                                         "Write synthetic runways.xml files and a database with synthetic "
+                                         "logbook entries for all simulators (or the one given by --simulator) "
+                                         "into <directory>. Needs --sample-logbook.",
+                                         "directory");
+
+const QCommandLineOption SAMPLE_LOGBOOK_OPTION("sample-logbook",
+                                               "Recorded Logbook.BIN <file> that is imported to create the logbook "
+                                               "table for generated entries. Can be given more than once for "
+                                               "--benchmark-import.",
+                                               "file");
+
+const QCommandLineOption ENTRIES_OPTION("entries",
+                                        "Number of logbook <entries> to generate (default 10000).",
+                                        "entries", "10000");
+
+const QCommandLineOption AIRPORTS_OPTION("airports",
+                                         "Number of <airports> to generate (default 2000).",
+                                         "airports", "2000");
+
+const QCommandLineOption AIRCRAFT_OPTION("aircraft",
+                                         "Number of different <aircraft> to generate (default 25).",
+                                         "aircraft", "25");
+
+const QCommandLineOption AIRPORT_SKEW_OPTION("airport-skew",
+                                             "Zipf <exponent> for airport popularity. 0 is uniform "
+                                             "(default 1).",
+                                             "exponent", "1");
+
+const QCommandLineOption AIRCRAFT_MIX_OPTION("aircraft-mix",
+                                             "Comma separated <weights> for aircraft types unknown, glider, "
+                                             "fixed wing, amphibious and rotor (default 1,2,85,4,8).",
+                                             "weights", "1,2,85,4,8");
+
+const QCommandLineOption MULTI_ENGINE_OPTION("multi-engine-percent",
+                                             "<percent> of fixed wing and amphibious aircraft with "
+                                             "multiple engines (default 30).",
+                                             "percent", "30");
+
+const QCommandLineOption EMPTY_ICAO_OPTION("empty-icao-percent",
+                                           "<percent> of entries with empty airport ICAO codes (default 2).",
+                                           "percent", "2");
+
+const QCommandLineOption ZERO_DATE_OPTION("zero-date-percent",
+                                          "<percent> of entries without start date (default 1).",
+                                          "percent", "1");
+
+const QCommandLineOption SHORT_FLIGHT_OPTION("short-flight-percent",
+                                             "<percent> of entries with a flight time below five minutes "
+                                             "(default 3).",
+                                             "percent", "3");
+
+const QCommandLineOption SEED_OPTION("seed",
+                                     "Random <seed> for generated files (default 1).",
+                                     "seed", "1");
+
+const QCommandLineOption BENCHMARK_QUERY_OPTION("benchmark-query",
+                                                "Measure query building, counting, fetching, model data "
+                                                "and formatters on generated databases.");
+
+const QCommandLineOption BENCHMARK_EXPORT_OPTION("benchmark-export",
+                                                 "Measure CSV, HTML and KML exports of generated databases.");
+
+const QCommandLineOption BENCHMARK_IMPORT_OPTION("benchmark-import",
+                                                 "Measure full, reload and append imports of generated files.");
+
+const QCommandLineOption BENCHMARK_VIEW_OPTION("benchmark-view",
+                                               "Measure scrolling, sorting, grouping and zooming of the table "
+                                               "view on generated databases.");
+
+const QCommandLineOption SIZES_OPTION("sizes",
+                                      "Comma separated number of logbook entries for the generated "
+                                      "benchmark databases (default 10000,100000).",
+                                      "sizes", "10000,100000");
+
+const QCommandLineOption VERBOSE_OPTION("verbose",
+                                        "Print debug messages to stderr.");
+
+const QCommandLineOption ITERATIONS_OPTION("iterations",
+                                           "Number of <iterations> for benchmarks (default 5).",
+                                           "iterations", "5");
+
+const QCommandLineOption OUTPUT_OPTION("output",
+                                       "Write machine readable results to <file> instead of stdout.",
+                                       "file");
+
+}
+
+CommandLine::CommandLine(QCoreApplication& application)
+  : app(application)
+{
+  parser.setApplicationDescription(QCoreApplication::applicationName() + " command line tools");
+  parser.addHelpOption();
+  parser.addVersionOption();
+  parser.addOption(BENCHMARK_READER_OPTION);
+  parser.addOption(CHECK_LOGBOOK_OPTION);
+  parser.addOption(BENCHMARK_QUERY_OPTION);
+  parser.addOption(BENCHMARK_EXPORT_OPTION);
+  parser.addOption(BENCHMARK_IMPORT_OPTION);
+  parser.addOption(BENCHMARK_VIEW_OPTION);
+  parser.addOption(SIZES_OPTION);
+  parser.addOption(DATABASE_OPTION);
+  parser.addOption(SIMULATOR_OPTION);
+  parser.addOption(IMPORT_LOGBOOK_OPTION);
+  parser.addOption(IMPORT_RUNWAYS_OPTION);
+  parser.addOption(FILTER_OPTION);
+  parser.addOption(FILTER_OPERATOR_OPTION);
+  parser.addOption(GROUP_BY_OPTION);
+  parser.addOption(SORT_OPTION);
+  parser.addOption(EXPORT_CSV_OPTION);
+  parser.addOption(EXPORT_HTML_OPTION);
+  parser.addOption(EXPORT_KML_OPTION);
+  parser.addOption(GENERATE_OPTION);
+  parser.addOption(SAMPLE_LOGBOOK_OPTION);
+  parser.addOption(ENTRIES_OPTION);
+  parser.addOption(AIRPORTS_OPTION);
+  parser.addOption(AIRCRAFT_OPTION);
+  parser.addOption(AIRPORT_SKEW_OPTION);
+  parser.addOption(AIRCRAFT_MIX_OPTION);
+  parser.addOption(MULTI_ENGINE_OPTION);
+  parser.addOption(EMPTY_ICAO_OPTION);
+  parser.addOption(ZERO_DATE_OPTION);
+  parser.addOption(SHORT_FLIGHT_OPTION);
+  parser.addOption(SEED_OPTION);
+  parser.addOption(VERBOSE_OPTION);
+  parser.addOption(ITERATIONS_OPTION);
+  parser.addOption(OUTPUT_OPTION);
+}
+
+bool CommandLine::isToolMode(int argc, char *argv[])
+{
+  return hasOption(argc, argv, TOOL_OPTIONS);
+}
+
+bool CommandLine::needsGuiApplication(int argc, char *argv[])
+{
+  return hasOption(argc, argv, GUI_TOOL_OPTIONS);
+}
+
+int CommandLine::run()
+{
+  parser.process(app);
+
+  // Debug messages would distort the measurements and hide the results
+  if(!parser.isSet(VERBOSE_OPTION))
+    QLoggingCategory::setFilterRules("*.debug=false");
+
+  // Writing query plans would distort the measurements of the large benchmark databases
+  if(parser.isSet(BENCHMARK_READER_OPTION) || parser.isSet(BENCHMARK_QUERY_OPTION) ||
+     parser.isSet(BENCHMARK_EXPORT_OPTION) || parser.isSet(BENCHMARK_IMPORT_OPTION) ||
+     parser.isSet(BENCHMARK_VIEW_OPTION))
+    SlowQueryLog::setThresholdMs(0);
+
+  try
+  {
+    if(parser.isSet(BENCHMARK_READER_OPTION))
+      return runReaderBenchmark();
+    else if(parser.isSet(CHECK_LOGBOOK_OPTION))
+      return runLogbookCheck();
+    else if(parser.isSet(BENCHMARK_QUERY_OPTION))
+      return runQueryBenchmark();
+    else if(parser.isSet(BENCHMARK_EXPORT_OPTION))
+      return runExportBenchmark();
+    else if(parser.isSet(BENCHMARK_IMPORT_OPTION))
+      return runImportBenchmark();
+    else if(parser.isSet(BENCHMARK_VIEW_OPTION))
+      return runViewBenchmark();
+    else if(parser.isSet(GENERATE_OPTION))
+      return runGenerator();
+    else if(parser.isSet(IMPORT_LOGBOOK_OPTION) || parser.isSet(IMPORT_RUNWAYS_OPTION) ||
+            parser.isSet(EXPORT_CSV_OPTION) || parser.isSet(EXPORT_HTML_OPTION) ||
+            parser.isSet(EXPORT_KML_OPTION))
+      return runExport();
+  }
+  catch(std::exception& e)
+  {
+    std::fprintf(stderr, "Error: %s\n", e.what());
+    return 1;
+  }
+  catch(...)
+  {
+    std::fprintf(stderr, "Error: unknown exception\n");
+    return 1;
+  }
+
+  parser.showHelp(1);
+  return 1;
+}
+
+QVector<int> CommandLine::databaseSizes() const
+{
+  QVector<int> sizes;
+  for(const QString& size : parser.value(SIZES_OPTION).split(','))
+  {
+    bool ok;
+    int num = size.trimmed().toInt(&ok);
+    if(!ok || num <= 0)
+      throw atools::Exception("Invalid database size \"" + size + "\"");
+    sizes.append(num);
+  }
+  return sizes;
+}
+
+int CommandLine::runQueryBenchmark()
+{
+  int iterations = std::max(parser.value(ITERATIONS_OPTION).toInt(), 1);
+
+  BenchmarkReport report("query");
+  QueryBenchmark(databaseSizes(), sampleLogbook(), iterations).run(report);
+  report.log();
+  return report.write(parser.value(OUTPUT_OPTION)) ? 0 : 1;
+}
+
+int CommandLine::runExportBenchmark()
+{
+  int iterations = std::max(parser.value(ITERATIONS_OPTION).toInt(), 1);
+
+  BenchmarkReport report("export");
+  ExportBenchmark(databaseSizes(), sampleLogbook(), iterations).run(report);
+  report.log();
+  return report.write(parser.value(OUTPUT_OPTION)) ? 0 : 1;
+}
+
+int CommandLine::runImportBenchmark()
+{
+  int iterations = std::max(parser.value(ITERATIONS_OPTION).toInt(), 1);
+
+  BenchmarkReport report("import");
+  ImportBenchmark(databaseSizes(), sampleLogbooks(), parser.value(IMPORT_RUNWAYS_OPTION), iterations).run(report);
+  report.log();
+  return report.write(parser.value(OUTPUT_OPTION)) ? 0 : 1;
+}
+
+int CommandLine::runViewBenchmark()
+{
+  int iterations = std::max(parser.value(ITERATIONS_OPTION).toInt(), 1);
+
+  BenchmarkReport report("view");
+  ViewBenchmark(databaseSizes(), sampleLogbook(), iterations).run(report);
+  report.log();
+  return report.write(parser.value(OUTPUT_OPTION)) ? 0 : 1;
+}
+
+int CommandLine::runReaderBenchmark()
+{
+  int iterations = std::max(parser.value(ITERATIONS_OPTION).toInt(), 1);
+
+  BenchmarkReport report("reader");
+  ReaderBenchmark(parser.value(BENCHMARK_READER_OPTION), iterations).run(report);
+  report.log();
+  return report.write(parser.value(OUTPUT_OPTION)) ? 0 : 1;
+}
+
+int CommandLine::runLogbookCheck()
+{
+  LogbookCrossCheck check(parser.value(CHECK_LOGBOOK_OPTION));
+  bool equal = check.run();
+
+  for(const QString& mismatch : check.getMismatches())
+    std::printf("%s\n", qPrintable(mismatch));
+  std::printf("Compared %d records (reader %d, loader %d, skipped by loader %d, missing in reader %d) "
+              "with %d differences\n",
+              check.getNumCompared(), check.getNumReaderRecords(), check.getNumLoaderRecords(),
+              check.getNumReaderOnly(), check.getNumLoaderOnly(), check.getNumMismatches());
+  return equal ? 0 : 1;
+}
+
+QStringList CommandLine::sampleLogbooks() const
+{
+  if(!parser.isSet(SAMPLE_LOGBOOK_OPTION))
+    throw atools::Exception("Generated logbooks need a Logbook.BIN given by --sample-logbook");
+  return parser.values(SAMPLE_LOGBOOK_OPTION);
+}
+
+QString CommandLine::sampleLogbook() const
+{
+  return sampleLogbooks().first();
+}
+
+atools::fs::SimulatorType CommandLine::simulatorType() const
+{
+  QString name = parser.value(SIMULATOR_OPTION).toLower();
+  if(name.isEmpty() || name == "fsx")
+    return atools::fs::FSX;
+  else if(name == "fsxse")
+    return atools::fs::FSX_SE;
+  else if(name == "p3dv2")
+    return atools::fs::P3D_V2;
+  else if(name == "p3dv3")
+    return atools::fs::P3D_V3;
+
+  throw atools::Exception("Unknown simulator \"" + name + "\"");
+}
+
+void CommandLine::buildQuery(QueryBuilder& query)
+{
+  const ColumnList *columns = query.getColumnList();
+
+  // Same as the simulator combo box in the search bar
+  if(parser.isSet(SIMULATOR_OPTION))
+    query.filter("simulator_id", static_cast<int>(simulatorType()));
+
+  // Lower and upper bounds by column
+  QHash<QString, QPair<QVariant, QVariant> > ranges;
+
+  for(const QString& filter : parser.values(FILTER_OPTION))
+  {
+    int sep = filter.indexOf('=');
+    if(sep > 1 && (filter.at(sep - 1) == '>' || filter.at(sep - 1) == '<'))
+    {
+      // Range bound with ">=" or "<="
+      QString colName = filter.left(sep - 1).trimmed();
+      QString value = filter.mid(sep + 1).trimmed();
+      bool lower = filter.at(sep - 1) == '>';
+
+      const Column *col = columns->getColumn(colName);
+      if(col == nullptr || !col->isRange())
+        throw atools::Exception("Column \"" + colName + "\" cannot be filtered by range");
+
+      QVariant bound;
+      if(colName == "startdate")
+      {
+        QDate date = QDate::fromString(value, Qt::ISODate);
+        if(!date.isValid())
+          throw atools::Exception("Invalid date in filter \"" + filter + "\"");
+        bound = QueryBuilder::dateToTimeT(date, !lower);
+      }
+      else
+      {
+        bool ok;
+        bound = value.toDouble(&ok);
+        if(!ok)
+          throw atools::Exception("Invalid number in filter \"" + filter + "\"");
+      }
+
+      if(lower)
+        ranges[colName].first = bound;
+      else
+        ranges[colName].second = bound;
+      continue;
+    }
+
+    if(sep < 1)
+      throw atools::Exception("Invalid filter \"" + filter + "\"");
+
+    QString colName = filter.left(sep).trimmed();
+    QString value = filter.mid(sep + 1);
+
+    // Text filters need a search field - numbers can be used like the combo boxes
+    const Column *col = columns->getColumn(colName);
+    if(col == nullptr || (!col->isFilter() && !value.startsWith('=')))
+      throw atools::Exception("Column \"" + colName + "\" cannot be filtered");
+
+    if(value.startsWith('='))
+    {
+      // Number comparison with "=="
+      bool ok;
+      int number = value.mid(1).toInt(&ok);
+      if(!ok)
+        throw atools::Exception("Invalid number in filter \"" + filter + "\"");
+      query.filter(colName, number);
+    }
+    else
+      query.filter(colName, value);
+  }
+
+  for(auto it = ranges.constBegin(); it != ranges.constEnd(); ++it)
+    query.filterRange(it.key(), it.value().first, it.value().second);
+
+  QString op = parser.value(FILTER_OPERATOR_OPTION).toLower();
+  if(op != "and" && op != "or")
+    throw atools::Exception("Invalid filter operator \"" + op + "\"");
+  query.setWhereOperator(op);
+
+  if(parser.isSet(GROUP_BY_OPTION))
+  {
+    QStringList groupBy = parser.value(GROUP_BY_OPTION).split(',', QString::SkipEmptyParts);
+    if(groupBy.isEmpty() || groupBy.size() > QueryBuilder::MAX_GROUP_LEVELS)
+      throw atools::Exception("Invalid number of group by columns \"" + parser.value(GROUP_BY_OPTION) + "\"");
+
+    for(const QString& colName : groupBy)
+    {
+      const Column *col = columns->getColumn(colName);
+      if(col == nullptr || !col->isGroup() || groupBy.count(colName) > 1)
+        throw atools::Exception("Column \"" + colName + "\" cannot be grouped");
+
+      if(query.isGrouped())
+        query.addGroupBy(colName);
+      else
+        query.setGroupBy(colName);
+    }
+
+    // Same default order as grouping in the table view
+    query.setOrderBy(groupBy.first(), "asc");
+  }
+
+  if(parser.isSet(SORT_OPTION))
+  {
+    QStringList sort = parser.value(SORT_OPTION).split(':');
+    QString order = sort.size() > 1 ? sort.at(1).toLower() : "asc";
+    const Column *col = columns->getColumn(sort.first());
+
+    if(col == nullptr || !col->isSort())
+      throw atools::Exception("Column \"" + sort.first() + "\" cannot be sorted");
+    if(order != "asc" && order != "desc")
+      throw atools::Exception("Invalid sort order \"" + order + "\"");
+
+    query.setOrderBy(sort.first(), order);
+  }
+
+  query.build();
+}
+
+int CommandLine::runExport()
+{
+  QString databaseFile = parser.isSet(DATABASE_OPTION) ?
+                         parser.value(DATABASE_OPTION) : Settings::getConfigFilename(".sqlite");
+  {
+    SqlDatabase db = SqlDatabase::addDatabase(ll::constants::DATABASE_TYPE, COMMANDLINE_CONNECTION);
+    db.setDatabaseName(databaseFile);
+    db.open();
+    qDebug() << "Opened database" << databaseFile;
+
+    LogbookImporter::updateSchema(&db);
+
+    // Imports use the same loaders as the GUI - runways first for airport names and distances
+    if(parser.isSet(IMPORT_RUNWAYS_OPTION))
+    {
+      AirportImporter importer(&db);
+      importer.loadAirports(parser.value(IMPORT_RUNWAYS_OPTION));
+      std::printf("Imported %d airports\n", importer.getNumLoaded());
+    }
+
+    if(parser.isSet(IMPORT_LOGBOOK_OPTION))
+    {
+      atools::fs::lb::LogbookEntryFilter filter;
+      if(Settings::instance()->value(ll::constants::SETTINGS_FILTER_ENTRIES, false).toBool())
+        filter = LogbookImporter::filterFromSettings();
+
+      LogbookImporter importer(&db);
+      importer.loadLogbook(parser.value(IMPORT_LOGBOOK_OPTION), simulatorType(), filter);
+      std::printf("Imported %d logbook entries (%d duplicates removed)\n",
+                  importer.getNumLoaded(), importer.getNumDuplicates());
+    }
+
+    if(parser.isSet(EXPORT_CSV_OPTION) || parser.isSet(EXPORT_HTML_OPTION) || parser.isSet(EXPORT_KML_OPTION))
+    {
+      SqlUtil util(&db);
+      if(!util.hasTableAndRows("logbook"))
+        throw atools::Exception("Database contains no logbook entries");
+
+      ColumnList columns(util.hasTableAndRows("airport"));
+      QueryBuilder query(&columns);
+      buildQuery(query);
+
+      QueryExportSource source(&db, &query);
+
+      if(parser.isSet(EXPORT_CSV_OPTION))
+      {
+        CsvExporter exporter(&source);
+        int exported = exporter.exportAllTo(parser.value(EXPORT_CSV_OPTION));
+        std::printf("Exported %d rows to CSV\n", exported);
+      }
+
+      if(parser.isSet(EXPORT_HTML_OPTION))
+      {
+        int pageSize = Settings::instance().getAndStoreValue(
+          ll::constants::SETTINGS_EXPORT_HTML_PAGE_SIZE, 500).toInt();
+        HtmlExporter exporter(&source, pageSize);
+        int exported = exporter.exportAllTo(parser.value(EXPORT_HTML_OPTION));
+        std::printf("Exported %d rows to HTML\n", exported);
+      }
+
+      if(parser.isSet(EXPORT_KML_OPTION))
+      {
+        // Same restrictions as the export menu
+        if(query.isGrouped() || !util.hasTableAndRows("airport"))
+          throw atools::Exception("KML export needs airports and is not possible for grouped results");
+
+        KmlExporter exporter(&source);
+        int exported = exporter.exportAllTo(parser.value(EXPORT_KML_OPTION));
+        std::printf("Exported %d flights to KML (%d skipped)\n", exported, exporter.getNumSkipped());
+      }
+    }
+
+    db.close();
+  }
+  SqlDatabase::removeDatabase(COMMANDLINE_CONNECTION);
+  return 0;
+}
+
+int CommandLine::runGenerator()
+{
+  LogbookGeneratorConfig config;
+  config.numEntries = parser.value(ENTRIES_OPTION).toInt();
+  config.numAirports = parser.value(AIRPORTS_OPTION).toInt();
+  config.numAircraft = parser.value(AIRCRAFT_OPTION).toInt();
+  config.airportSkew = parser.value(AIRPORT_SKEW_OPTION).toDouble();
+  config.multiEnginePercent = parser.value(MULTI_ENGINE_OPTION).toDouble();
+  config.emptyIcaoPercent = parser.value(EMPTY_ICAO_OPTION).toDouble();
+  config.zeroDatePercent = parser.value(ZERO_DATE_OPTION).toDouble();
+  config.shortFlightPercent = parser.value(SHORT_FLIGHT_OPTION).toDouble();
+  config.seed = parser.value(SEED_OPTION).toUInt();
+  config.sampleLogbook = sampleLogbook();
+
+  config.aircraftTypeWeights.clear();
+  for(const QString& weight : parser.value(AIRCRAFT_MIX_OPTION).split(','))
+    config.aircraftTypeWeights.append(weight.toDouble());
+
+  QVector<atools::fs::SimulatorType> types;
+  if(parser.isSet(SIMULATOR_OPTION))
+    types.append(simulatorType());
+  else
+  {
+    for(atools::fs::SimulatorType type : atools::fs::ALL_SIMULATOR_TYPES)
+      types.append(type);
+  }
+
+  LogbookGenerator generator(config);
+  generator.generate(parser.value(GENERATE_OPTION), types);
+  std::printf("Generated %d entries (%d invalid in last logbook) and %d airports for %d simulators in \"%s\"\n",
+              config.numEntries, generator.getNumInvalid(), config.numAirports, types.size(),
+              qPrintable(parser.value(GENERATE_OPTION)));
+  return 0;
+}
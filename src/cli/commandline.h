@@ -0,0 +1,83 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_COMMANDLINE_H
+#define LITTLELOGBOOK_COMMANDLINE_H
+
+#include "fs/fspaths.h"
+
+#include <QCommandLineParser>
+#include <QVector>
+
+class QCoreApplication;
+class QueryBuilder;
+
+/*
+ * Runs the tools that do not need a GUI like benchmarks, imports and exports.
+ * These are selected by command line options and run within a plain
+ * QCoreApplication.
+ */
+class CommandLine
+{
+public:
+  CommandLine(QCoreApplication& application);
+
+  /* Check for tool options before any application object exists.
+   * @return true if a tool was requested and run() should be used instead of the GUI */
+  static bool isToolMode(int argc, char *argv[]);
+
+  /* @return true if the requested tool uses widgets or models and needs a QApplication */
+  static bool needsGuiApplication(int argc, char *argv[]);
+
+  /* Parse the command line and run the requested tool.
+   * @return process exit code */
+  int run();
+
+private:
+  int runReaderBenchmark();
+
+  /* Compare all records of reader and loader */
+  int runLogbookCheck();
+  int runQueryBenchmark();
+  int runExportBenchmark();
+  int runImportBenchmark();
+  int runViewBenchmark();
+
+  /* Database sizes for benchmarks from option */
+  QVector<int> databaseSizes() const;
+
+  /* Write synthetic runways files and a database with synthetic logbook entries */
+  int runGenerator();
+
+  /* Import files into the database and export the query result as CSV, HTML or KML */
+  int runExport();
+
+  /* Apply filter, group and sort options to the query builder */
+  void buildQuery(QueryBuilder& query);
+
+  /* Sample logbook files from option. Throws an exception if not given. */
+  QStringList sampleLogbooks() const;
+  QString sampleLogbook() const;
+
+  /* Get simulator from option. Throws an exception for unknown names. */
+  atools::fs::SimulatorType simulatorType() const;
+
+  QCoreApplication& app;
+  QCommandLineParser parser;
+};
+
+#endif // LITTLELOGBOOK_COMMANDLINE_H
@@ -0,0 +1,77 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "cli/queryexportsource.h"
+
+#include "table/columnlist.h"
+#include "table/querybuilder.h"
+#include "table/sqlmodel.h"
+#include "sql/sqlquery.h"
+
+using atools::sql::SqlQuery;
+using atools::sql::SqlDatabase;
+
+QueryExportSource::QueryExportSource(SqlDatabase *sqlDb, const QueryBuilder *queryBuilder)
+  : db(sqlDb), query(queryBuilder)
+{
+  SqlQuery countStmt(db);
+  countStmt.prepare(query->getCountQuery());
+  SelectStatement::bindValues(countStmt, query->getCountBinds());
+  countStmt.exec();
+  if(countStmt.next())
+    totalRowCount = countStmt.value(0).toInt();
+}
+
+QueryExportSource::~QueryExportSource()
+{
+}
+
+QString QueryExportSource::getCurrentSqlQuery() const
+{
+  return query->getSqlQuery();
+}
+
+QVariantMap QueryExportSource::getCurrentQueryBinds() const
+{
+  return query->getSqlBinds();
+}
+
+QString QueryExportSource::getQueryStateDescription() const
+{
+  return query->getStateDescription();
+}
+
+QString QueryExportSource::formatModelData(const QString& col, const QVariant& var) const
+{
+  return SqlModel::formatValue(col, var);
+}
+
+const Column *QueryExportSource::getColumn(int physicalIndex) const
+{
+  return query->getColumnList()->getColumn(query->getResultColumnNames().at(physicalIndex));
+}
+
+bool QueryExportSource::isColumnVisibleInView(int physicalIndex) const
+{
+  const Column *col = getColumn(physicalIndex);
+  return col != nullptr && !col->isHiddenCol();
+}
+
+QString QueryExportSource::getSortColumn() const
+{
+  return query->getOrderByCol();
+}
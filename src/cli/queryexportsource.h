@@ -0,0 +1,69 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_QUERYEXPORTSOURCE_H
+#define LITTLELOGBOOK_QUERYEXPORTSOURCE_H
+
+#include "export/exportsource.h"
+
+class QueryBuilder;
+
+/*
+ * Export source for the command line that runs the query of a QueryBuilder
+ * directly on a database. All query columns except hidden ones are exported
+ * in query order.
+ */
+class QueryExportSource :
+  public ExportSource
+{
+public:
+  /* Runs the count query of the already built query */
+  QueryExportSource(atools::sql::SqlDatabase *sqlDb, const QueryBuilder *queryBuilder);
+  virtual ~QueryExportSource();
+
+  virtual atools::sql::SqlDatabase *getReadDatabase() const override
+  {
+    return db;
+  }
+
+  virtual QString getCurrentSqlQuery() const override;
+  virtual QVariantMap getCurrentQueryBinds() const override;
+  virtual QString getQueryStateDescription() const override;
+
+  virtual int getTotalRowCount() const override
+  {
+    return totalRowCount;
+  }
+
+  virtual QString formatModelData(const QString& col, const QVariant& var) const override;
+  virtual const Column *getColumn(int physicalIndex) const override;
+
+  virtual int getColumnVisualIndex(int physicalIndex) const override
+  {
+    return physicalIndex;
+  }
+
+  virtual bool isColumnVisibleInView(int physicalIndex) const override;
+  virtual QString getSortColumn() const override;
+
+private:
+  atools::sql::SqlDatabase *db;
+  const QueryBuilder *query;
+  int totalRowCount = 0;
+};
+
+#endif // LITTLELOGBOOK_QUERYEXPORTSOURCE_H
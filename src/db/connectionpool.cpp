@@ -0,0 +1,116 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "db/connectionpool.h"
+
+#include "gui/constants.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "logging/loggingdefs.h"
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QSqlDatabase>
+#include <QThread>
+
+using atools::sql::SqlDatabase;
+using atools::sql::SqlQuery;
+
+ConnectionPool::ConnectionPool(const QString& databaseName, bool inMemory)
+  : dbName(databaseName), memory(inMemory)
+{
+}
+
+ConnectionPool::~ConnectionPool()
+{
+  QMutexLocker locker(&mutex);
+  for(const Connection& connection : connections)
+  {
+    QObject::disconnect(connection.finishedConnection);
+    closeConnection(connection);
+  }
+  connections.clear();
+}
+
+SqlDatabase *ConnectionPool::getReadConnection()
+{
+  QThread *thread = QThread::currentThread();
+
+  QMutexLocker locker(&mutex);
+  auto it = connections.constFind(thread);
+  if(it != connections.constEnd())
+    return it->db;
+
+  Connection connection;
+  connection.name = QString("readpool-%1").arg(nextId++);
+  connection.db = new SqlDatabase();
+
+  try
+  {
+    *connection.db = SqlDatabase::addDatabase(ll::constants::DATABASE_TYPE, connection.name);
+    connection.db->getQSqlDatabase().setConnectOptions(
+      memory ? "QSQLITE_OPEN_URI;QSQLITE_OPEN_READONLY" : "QSQLITE_OPEN_READONLY");
+    connection.db->setDatabaseName(dbName);
+    connection.db->open();
+
+    // Do not take table locks on the shared cache that would block imports
+    if(memory)
+      SqlQuery(connection.db).exec("pragma read_uncommitted = 1");
+  }
+  catch(...)
+  {
+    closeConnection(connection);
+    throw;
+  }
+
+  // Threads from thread pools come and go - remove the connection within the
+  // finishing thread since connections cannot be closed from other threads
+  if(thread != QCoreApplication::instance()->thread())
+    connection.finishedConnection = QObject::connect(thread, &QThread::finished,
+                                                     [ = ]() {removeConnection(thread); });
+
+  connections.insert(thread, connection);
+  qDebug() << "Opened read connection" << connection.name << "for thread" << thread;
+  return connection.db;
+}
+
+int ConnectionPool::getNumConnections() const
+{
+  QMutexLocker locker(&mutex);
+  return connections.size();
+}
+
+void ConnectionPool::removeConnection(QThread *thread)
+{
+  QMutexLocker locker(&mutex);
+  auto it = connections.find(thread);
+  if(it != connections.end())
+  {
+    QObject::disconnect(it->finishedConnection);
+    closeConnection(it.value());
+    connections.erase(it);
+  }
+}
+
+void ConnectionPool::closeConnection(const Connection& connection)
+{
+  qDebug() << "Closing read connection" << connection.name;
+  if(connection.db->getQSqlDatabase().isOpen())
+    connection.db->close();
+  delete connection.db;
+  SqlDatabase::removeDatabase(connection.name);
+}
@@ -0,0 +1,80 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_CONNECTIONPOOL_H
+#define LITTLELOGBOOK_CONNECTIONPOOL_H
+
+#include <QHash>
+#include <QMetaObject>
+#include <QMutex>
+#include <QString>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+} // namespace sql
+} // namespace atools
+
+class QThread;
+
+/*
+ * Hands out read-only connections to the database. Each thread gets its own
+ * connection which is opened on first use and closed when the thread finishes.
+ * This allows statistics, tooltips and exports to query in parallel to the
+ * main view without sharing a connection.
+ *
+ * File databases should be in WAL mode so readers do not block the writer.
+ * Shared in-memory databases are read uncommitted for the same reason.
+ */
+class ConnectionPool
+{
+public:
+  /*
+   * @param databaseName file name or URI of the database
+   * @param inMemory true if databaseName is a shared in-memory database URI
+   */
+  ConnectionPool(const QString& databaseName, bool inMemory);
+  ~ConnectionPool();
+
+  /* Get the read-only connection of the calling thread. Throws an exception if
+   * the connection cannot be opened. The connection must not be used by other threads. */
+  atools::sql::SqlDatabase *getReadConnection();
+
+  /* Number of currently open connections */
+  int getNumConnections() const;
+
+private:
+  struct Connection
+  {
+    atools::sql::SqlDatabase *db;
+    QString name;
+    QMetaObject::Connection finishedConnection;
+  };
+
+  /* Close and remove connection of the given thread */
+  void removeConnection(QThread *thread);
+  void closeConnection(const Connection& connection);
+
+  QString dbName;
+  bool memory;
+
+  mutable QMutex mutex;
+  QHash<QThread *, Connection> connections;
+  int nextId = 0;
+};
+
+#endif // LITTLELOGBOOK_CONNECTIONPOOL_H
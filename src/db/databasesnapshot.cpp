@@ -0,0 +1,143 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "db/databasesnapshot.h"
+
+#include "sql/sqldatabase.h"
+#include "exception.h"
+#include "logging/loggingdefs.h"
+
+#include <QElapsedTimer>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+
+#if defined(LITTLELOGBOOK_SQLITE_API)
+#include <sqlite3.h>
+#endif
+
+bool DatabaseSnapshot::isAvailable()
+{
+#if defined(LITTLELOGBOOK_SQLITE_API)
+  return true;
+#else
+  return false;
+#endif
+}
+
+#if defined(LITTLELOGBOOK_SQLITE_API)
+
+void DatabaseSnapshot::restore(atools::sql::SqlDatabase *db, const QString& filename)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  sqlite3 *fileDb = nullptr;
+  int rc = sqlite3_open_v2(filename.toUtf8().constData(), &fileDb, SQLITE_OPEN_READONLY, nullptr);
+  if(rc != SQLITE_OK)
+  {
+    QString err = fileDb != nullptr ? QString::fromUtf8(sqlite3_errmsg(fileDb)) : QString::number(rc);
+    sqlite3_close(fileDb);
+    throw atools::Exception(QString("Cannot open database \"%1\": %2").arg(filename).arg(err));
+  }
+
+  try
+  {
+    copy(handle(db), fileDb, "Cannot restore database from \"" + filename + "\"");
+  }
+  catch(...)
+  {
+    sqlite3_close(fileDb);
+    throw;
+  }
+  sqlite3_close(fileDb);
+
+  qInfo() << "Restored database from" << filename << "in" << timer.elapsed() << "ms";
+}
+
+void DatabaseSnapshot::save(atools::sql::SqlDatabase *db, const QString& filename)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  sqlite3 *fileDb = nullptr;
+  int rc = sqlite3_open_v2(filename.toUtf8().constData(), &fileDb,
+                           SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr);
+  if(rc != SQLITE_OK)
+  {
+    QString err = fileDb != nullptr ? QString::fromUtf8(sqlite3_errmsg(fileDb)) : QString::number(rc);
+    sqlite3_close(fileDb);
+    throw atools::Exception(QString("Cannot open database \"%1\": %2").arg(filename).arg(err));
+  }
+
+  try
+  {
+    copy(fileDb, handle(db), "Cannot save database to \"" + filename + "\"");
+  }
+  catch(...)
+  {
+    sqlite3_close(fileDb);
+    throw;
+  }
+  sqlite3_close(fileDb);
+
+  qInfo() << "Saved database to" << filename << "in" << timer.elapsed() << "ms";
+}
+
+sqlite3 *DatabaseSnapshot::handle(atools::sql::SqlDatabase *db)
+{
+  QVariant value = db->getQSqlDatabase().driver()->handle();
+  if(!value.isValid() || qstrcmp(value.typeName(), "sqlite3*") != 0)
+    throw atools::Exception("Database driver does not provide a SQLite handle");
+
+  sqlite3 *sqliteHandle = *static_cast<sqlite3 **>(value.data());
+  if(sqliteHandle == nullptr)
+    throw atools::Exception("Database is not open");
+  return sqliteHandle;
+}
+
+void DatabaseSnapshot::copy(sqlite3 *destination, sqlite3 *source, const QString& message)
+{
+  sqlite3_backup *backup = sqlite3_backup_init(destination, "main", source, "main");
+  if(backup == nullptr)
+    throw atools::Exception(message + ": " + QString::fromUtf8(sqlite3_errmsg(destination)));
+
+  // Copy all pages in one step - the source is not modified concurrently
+  int rc = sqlite3_backup_step(backup, -1);
+  sqlite3_backup_finish(backup);
+
+  if(rc != SQLITE_DONE)
+    throw atools::Exception(message + ": " + QString::fromUtf8(sqlite3_errstr(rc)));
+}
+
+#else
+
+void DatabaseSnapshot::restore(atools::sql::SqlDatabase *, const QString&)
+{
+  throw atools::Exception("Database snapshots are not available in this build");
+}
+
+void DatabaseSnapshot::save(atools::sql::SqlDatabase *, const QString&)
+{
+  throw atools::Exception("Database snapshots are not available in this build");
+}
+
+#endif
+
+QString DatabaseSnapshot::memoryDatabaseName()
+{
+  return "file:littlelogbook?mode=memory&cache=shared";
+}
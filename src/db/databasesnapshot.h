@@ -0,0 +1,65 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_DATABASESNAPSHOT_H
+#define LITTLELOGBOOK_DATABASESNAPSHOT_H
+
+#include <QString>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+} // namespace sql
+} // namespace atools
+
+struct sqlite3;
+
+/*
+ * Copies a whole SQLite database between an open connection and a file using
+ * the SQLite online backup API. Used to keep the working database in memory and
+ * persist it to the configuration directory.
+ *
+ * Only available if built with "CONFIG+=system_sqlite" which needs Qt to use the
+ * same SQLite library as the application (see BUILD.txt).
+ * All methods throw atools::Exception on error or if not available.
+ */
+class DatabaseSnapshot
+{
+public:
+  /* @return true if built with direct access to the SQLite library */
+  static bool isAvailable();
+
+  /* Replace the contents of the open database with the contents of the file */
+  static void restore(atools::sql::SqlDatabase *db, const QString& filename);
+
+  /* Replace the contents of the file with the contents of the open database.
+   * The file is created if it does not exist. */
+  static void save(atools::sql::SqlDatabase *db, const QString& filename);
+
+  /* URI for the shared in-memory database. Needs connect option QSQLITE_OPEN_URI. */
+  static QString memoryDatabaseName();
+
+private:
+  /* Get the native handle from the Qt driver */
+  static sqlite3 *handle(atools::sql::SqlDatabase *db);
+
+  /* Copy the main database of source into destination */
+  static void copy(sqlite3 *destination, sqlite3 *source, const QString& message);
+
+};
+
+#endif // LITTLELOGBOOK_DATABASESNAPSHOT_H
@@ -0,0 +1,208 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "diag/diagnosticswidget.h"
+
+#include "diag/memorystats.h"
+#include "diag/querystats.h"
+#include "bench/processmemory.h"
+
+#include <QApplication>
+#include <QLocale>
+#include <QPalette>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QTextEdit>
+#include <QVBoxLayout>
+
+namespace {
+
+/* Update interval of the report while visible */
+const int UPDATE_INTERVAL_MS = 1000;
+
+/* Format microseconds as milliseconds */
+QString formatMs(const QLocale& locale, double micros)
+{
+  return locale.toString(micros / 1000., 'f', 2);
+}
+
+/* Format bytes as kilobytes or "-" if not available */
+QString formatKb(const QLocale& locale, qint64 bytes)
+{
+  return bytes < 0 ? QString("-") : locale.toString((bytes + 512) / 1024);
+}
+
+}
+
+DiagnosticsWidget::DiagnosticsWidget(QWidget *parent)
+  : QWidget(parent)
+{
+  textEdit = new QTextEdit(this);
+  textEdit->setReadOnly(true);
+  textEdit->setUndoRedoEnabled(false);
+
+  QPushButton *resetButton = new QPushButton(tr("&Reset"), this);
+  resetButton->setToolTip(tr("Clear all collected values"));
+  resetButton->setStatusTip(resetButton->toolTip());
+
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->addWidget(textEdit);
+  layout->addWidget(resetButton, 0, Qt::AlignRight);
+
+  connect(resetButton, &QPushButton::clicked, this, &DiagnosticsWidget::resetStats);
+  connect(&updateTimer, &QTimer::timeout, this, &DiagnosticsWidget::updateReport);
+  updateTimer.setInterval(UPDATE_INTERVAL_MS);
+}
+
+DiagnosticsWidget::~DiagnosticsWidget()
+{
+  updateTimer.stop();
+}
+
+void DiagnosticsWidget::showEvent(QShowEvent *event)
+{
+  QWidget::showEvent(event);
+  updateReport();
+  updateTimer.start();
+}
+
+void DiagnosticsWidget::hideEvent(QHideEvent *event)
+{
+  QWidget::hideEvent(event);
+  updateTimer.stop();
+}
+
+void DiagnosticsWidget::resetStats()
+{
+  QueryStats::instance().reset();
+  MemoryStats::instance().resetPeaks();
+  ProcessMemory::resetPeakRss();
+  updateReport();
+}
+
+void DiagnosticsWidget::updateReport()
+{
+  // Keep the scroll position when updating
+  int scrollPos = textEdit->verticalScrollBar()->value();
+
+  textEdit->setHtml(
+    "<!DOCTYPE HTML PUBLIC \"-//W3C//DTD HTML 4.0//EN\" \"http://www.w3.org/TR/REC-html40/strict.dtd\">"
+    "<html><head></head>"
+    "<body style=\"font-family:'sans'; font-size:8pt; font-weight:400; font-style:normal;\">" +
+    createQueryReport() +
+    createMemoryReport() +
+    "</body></html>");
+
+  textEdit->verticalScrollBar()->setValue(scrollPos);
+}
+
+QString DiagnosticsWidget::createQueryReport() const
+{
+  QLocale l;
+  QString color = QApplication::palette().color(QPalette::Active, QPalette::Base).
+                  darker(105).name(QColor::HexRgb);
+  QString colorAlt = QApplication::palette().color(QPalette::Active, QPalette::AlternateBase).
+                     darker(105).name(QColor::HexRgb);
+
+  QString html("<p><b>" + tr("Query times in ms") + "</b></p>"
+               "<table border=\"0\" cellpadding=\"2\" cellspacing=\"0\"><tbody>"
+               "<tr><td><b>" + tr("Query") + "</b></td>"
+               "<td align=\"right\"><b>" + tr("Count") + "</b></td>"
+               "<td align=\"right\"><b>" + tr("Mean") + "</b></td>"
+               "<td align=\"right\"><b>" + tr("50%") + "</b></td>"
+               "<td align=\"right\"><b>" + tr("90%") + "</b></td>"
+               "<td align=\"right\"><b>" + tr("99%") + "</b></td>"
+               "<td align=\"right\"><b>" + tr("Max") + "</b></td>"
+               "<td align=\"right\"><b>" + tr("Rows") + "</b></td>"
+               "<td align=\"right\"><b>" + tr("Scanned") + "</b></td>"
+               "<td align=\"right\"><b>" + tr("Sorts") + "</b></td></tr>");
+
+  QVector<QueryStats::CategoryStats> stats = QueryStats::instance().getStats();
+  for(int i = 0; i < stats.size(); i++)
+  {
+    const QueryStats::CategoryStats& s = stats.at(i);
+    const LatencyHistogram& h = s.histogram;
+
+    html += "<tr bgcolor=\"" + (i % 2 == 0 ? color : colorAlt) + "\">";
+    html += "<td>" + QueryStats::categoryName(static_cast<QueryStats::Category>(i)) + "</td>";
+    html += "<td align=\"right\">" + l.toString(h.getCount()) + "</td>";
+    html += "<td align=\"right\">" + formatMs(l, h.getMeanUs()) + "</td>";
+    html += "<td align=\"right\">" + formatMs(l, h.getPercentileUs(50.)) + "</td>";
+    html += "<td align=\"right\">" + formatMs(l, h.getPercentileUs(90.)) + "</td>";
+    html += "<td align=\"right\">" + formatMs(l, h.getPercentileUs(99.)) + "</td>";
+    html += "<td align=\"right\">" + formatMs(l, h.getMaxUs()) + "</td>";
+    html += "<td align=\"right\">" + l.toString(s.rowsReturned) + "</td>";
+    html += "<td align=\"right\">" + l.toString(s.rowsScanned) + "</td>";
+    html += "<td align=\"right\">" + l.toString(s.sorts) + "</td>";
+    html += "</tr>";
+  }
+  html += "</tbody></table>";
+  html += "<p>" + tr("Scanned counts the steps in full table scans as reported by SQLite. "
+                     "Statistics, tooltip and export queries report returned rows only.") + "</p>";
+  return html;
+}
+
+QString DiagnosticsWidget::createMemoryReport() const
+{
+  QLocale l;
+  QString color = QApplication::palette().color(QPalette::Active, QPalette::Base).
+                  darker(105).name(QColor::HexRgb);
+  QString colorAlt = QApplication::palette().color(QPalette::Active, QPalette::AlternateBase).
+                     darker(105).name(QColor::HexRgb);
+
+  QString html("<p><b>" + tr("Memory") + "</b></p>"
+               "<table border=\"0\" cellpadding=\"2\" cellspacing=\"0\"><tbody>"
+               "<tr><td><b>" + tr("Used by") + "</b></td>"
+               "<td align=\"right\"><b>" + tr("Current") + "</b></td>"
+               "<td align=\"right\"><b>" + tr("Peak") + "</b></td></tr>");
+
+  int i = 0;
+  auto addRow = [&](const QString& name, const QString& current, const QString& peak) {
+    html += "<tr bgcolor=\"" + (i++ % 2 == 0 ? color : colorAlt) + "\">";
+    html += "<td>" + name + "</td>";
+    html += "<td align=\"right\">" + current + "</td>";
+    html += "<td align=\"right\">" + peak + "</td>";
+    html += "</tr>";
+  };
+
+  const MemoryStats& stats = MemoryStats::instance();
+  for(int g = 0; g < MemoryStats::NUM_GAUGES; g++)
+  {
+    MemoryStats::Gauge gauge = static_cast<MemoryStats::Gauge>(g);
+    if(MemoryStats::isBytes(gauge))
+      addRow(MemoryStats::gaugeName(gauge) + tr(" (kB)"),
+             formatKb(l, stats.getValue(gauge)), formatKb(l, stats.getPeak(gauge)));
+    else
+      addRow(MemoryStats::gaugeName(gauge), l.toString(stats.getValue(gauge)), l.toString(stats.getPeak(gauge)));
+  }
+
+  MemoryStats::SqliteStatus sqlite = MemoryStats::getSqliteStatus();
+  if(sqlite.available)
+  {
+    addRow(tr("SQLite heap (kB)"), formatKb(l, sqlite.heapBytes), formatKb(l, sqlite.heapPeakBytes));
+    addRow(tr("SQLite page cache (pages)"), l.toString(sqlite.pageCachePages),
+           l.toString(sqlite.pageCachePeakPages));
+    addRow(tr("SQLite page cache overflow (kB)"), formatKb(l, sqlite.pageCacheOverflowBytes),
+           formatKb(l, sqlite.pageCacheOverflowPeakBytes));
+  }
+  addRow(tr("Process resident (kB)"), formatKb(l, ProcessMemory::currentRss()), formatKb(l, ProcessMemory::peakRss()));
+
+  html += "</tbody></table>";
+  html += "<p>" + tr("Table cache sizes are estimated. A cache limit can be set with "
+                     "\"Database/ModelCacheLimitMb\" in the configuration file.") + "</p>";
+  return html;
+}
@@ -0,0 +1,61 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_DIAGNOSTICSWIDGET_H
+#define LITTLELOGBOOK_DIAGNOSTICSWIDGET_H
+
+#include <QTimer>
+#include <QWidget>
+
+class QTextEdit;
+
+/*
+ * Content of the diagnostics dock window. Shows query latency percentiles,
+ * returned rows and SQLite scan counters per query category as collected by
+ * QueryStats and the memory usage from MemoryStats. Updated periodically while
+ * visible.
+ */
+class DiagnosticsWidget :
+  public QWidget
+{
+  Q_OBJECT
+
+public:
+  DiagnosticsWidget(QWidget *parent);
+  virtual ~DiagnosticsWidget();
+
+  /* Refresh the report now */
+  void updateReport();
+
+private:
+  virtual void showEvent(QShowEvent *event) override;
+  virtual void hideEvent(QHideEvent *event) override;
+
+  /* Clear all collected values */
+  void resetStats();
+
+  /* HTML table for all query categories */
+  QString createQueryReport() const;
+
+  /* HTML table for memory consumers, SQLite and the process */
+  QString createMemoryReport() const;
+
+  QTextEdit *textEdit = nullptr;
+  QTimer updateTimer;
+};
+
+#endif // LITTLELOGBOOK_DIAGNOSTICSWIDGET_H
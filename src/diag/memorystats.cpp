@@ -0,0 +1,161 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "diag/memorystats.h"
+
+#include "bench/processmemory.h"
+#include "logging/loggingdefs.h"
+
+#include <QObject>
+
+#if defined(LITTLELOGBOOK_SQLITE_API)
+#include <sqlite3.h>
+#endif
+
+namespace {
+
+/* Header of QString and QByteArray data blocks */
+const qint64 ARRAY_DATA_HEADER_BYTES = 24;
+
+#if defined(LITTLELOGBOOK_SQLITE_API)
+/* Get current and highwater value of a sqlite3_status parameter */
+void sqliteStatus(int op, qint64& current, qint64& highwater)
+{
+  int cur = 0, high = 0;
+  if(sqlite3_status(op, &cur, &high, 0) == SQLITE_OK)
+  {
+    current = cur;
+    highwater = high;
+  }
+}
+
+#endif
+
+}
+
+MemoryStats::MemoryStats()
+{
+  for(int i = 0; i < NUM_GAUGES; i++)
+  {
+    values[i].store(0);
+    peaks[i].store(0);
+  }
+}
+
+MemoryStats& MemoryStats::instance()
+{
+  static MemoryStats memoryStats;
+  return memoryStats;
+}
+
+void MemoryStats::set(Gauge gauge, qint64 value)
+{
+  values[gauge].store(value, std::memory_order_relaxed);
+
+  qint64 peak = peaks[gauge].load(std::memory_order_relaxed);
+  while(value > peak && !peaks[gauge].compare_exchange_weak(peak, value, std::memory_order_relaxed))
+    ;
+}
+
+void MemoryStats::resetPeaks()
+{
+  for(int i = 0; i < NUM_GAUGES; i++)
+    peaks[i].store(values[i].load());
+}
+
+MemoryStats::SqliteStatus MemoryStats::getSqliteStatus()
+{
+  SqliteStatus status;
+#if defined(LITTLELOGBOOK_SQLITE_API)
+  status.available = true;
+  sqliteStatus(SQLITE_STATUS_MEMORY_USED, status.heapBytes, status.heapPeakBytes);
+  sqliteStatus(SQLITE_STATUS_PAGECACHE_USED, status.pageCachePages, status.pageCachePeakPages);
+  sqliteStatus(SQLITE_STATUS_PAGECACHE_OVERFLOW, status.pageCacheOverflowBytes,
+               status.pageCacheOverflowPeakBytes);
+
+  qint64 unused = 0;
+  sqliteStatus(SQLITE_STATUS_MALLOC_COUNT, status.allocations, unused);
+#endif
+  return status;
+}
+
+void MemoryStats::log() const
+{
+  for(int i = 0; i < NUM_GAUGES; i++)
+    qInfo().nospace() << "Memory " << gaugeName(static_cast<Gauge>(i))
+                      << ": " << getValue(static_cast<Gauge>(i))
+                      << " peak " << getPeak(static_cast<Gauge>(i));
+
+  SqliteStatus s = getSqliteStatus();
+  if(s.available)
+    qInfo().nospace() << "Memory SQLite: heap " << s.heapBytes << " peak " << s.heapPeakBytes
+                      << " page cache pages " << s.pageCachePages << " peak " << s.pageCachePeakPages
+                      << " page cache overflow " << s.pageCacheOverflowBytes
+                      << " peak " << s.pageCacheOverflowPeakBytes
+                      << " allocations " << s.allocations;
+
+  qInfo().nospace() << "Memory process: resident " << ProcessMemory::currentRss()
+                    << " peak " << ProcessMemory::peakRss();
+}
+
+QString MemoryStats::gaugeName(Gauge gauge)
+{
+  switch(gauge)
+  {
+    case MODEL_ROWS:
+      return QObject::tr("Table rows cached");
+
+    case MODEL_BYTES:
+      return QObject::tr("Table cache");
+
+    case MODEL_EVICTED_ROWS:
+      return QObject::tr("Table rows released");
+
+    case FORMATTED_BYTES:
+      return QObject::tr("Formatted text");
+
+    case IMPORT_MAPPED_BYTES:
+      return QObject::tr("Import logbook file");
+
+    case FILTER_CACHE_BYTES:
+      return QObject::tr("Filter cache");
+
+    case NUM_GAUGES:
+      break;
+  }
+  return QString();
+}
+
+qint64 MemoryStats::estimateBytes(const QVariant& value)
+{
+  // QList keeps a pointer to each heap allocated QVariant
+  qint64 size = static_cast<qint64>(sizeof(void *) + sizeof(QVariant));
+
+  if(value.type() == QVariant::String)
+    size += ARRAY_DATA_HEADER_BYTES + value.toString().size() * static_cast<qint64>(sizeof(QChar));
+  else if(value.type() == QVariant::ByteArray)
+    size += ARRAY_DATA_HEADER_BYTES + value.toByteArray().size();
+  return size;
+}
+
+qint64 MemoryStats::estimateBytes(const QVariantList& list)
+{
+  qint64 size = static_cast<qint64>(sizeof(QVariantList)) + ARRAY_DATA_HEADER_BYTES;
+  for(const QVariant& value : list)
+    size += estimateBytes(value);
+  return size;
+}
@@ -0,0 +1,95 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_MEMORYSTATS_H
+#define LITTLELOGBOOK_MEMORYSTATS_H
+
+#include <QString>
+#include <QVariantList>
+
+#include <atomic>
+
+/*
+ * Current and peak values of the main memory consumers. Sizes of Qt containers
+ * are estimated from the payload and the per element overhead. Thread safe.
+ */
+class MemoryStats
+{
+public:
+  enum Gauge
+  {
+    MODEL_ROWS, /* Rows cached in the table model */
+    MODEL_BYTES, /* Estimated size of all cached rows */
+    MODEL_EVICTED_ROWS, /* Rows released because of the cache limit */
+    FORMATTED_BYTES, /* Formatted strings held at once like a clipboard copy */
+    IMPORT_MAPPED_BYTES, /* Memory mapped logbook file */
+    FILTER_CACHE_BYTES, /* Row id bitmaps of the filter cache */
+    NUM_GAUGES
+  };
+
+  /* Memory used by SQLite as reported by sqlite3_status. Not available if not
+   * built with "CONFIG+=system_sqlite". */
+  struct SqliteStatus
+  {
+    bool available = false;
+    qint64 heapBytes = 0, heapPeakBytes = 0;
+    qint64 pageCachePages = 0, pageCachePeakPages = 0;
+    qint64 pageCacheOverflowBytes = 0, pageCacheOverflowPeakBytes = 0;
+    qint64 allocations = 0;
+  };
+
+  static MemoryStats& instance();
+
+  void set(Gauge gauge, qint64 value);
+
+  qint64 getValue(Gauge gauge) const
+  {
+    return values[gauge].load(std::memory_order_relaxed);
+  }
+
+  qint64 getPeak(Gauge gauge) const
+  {
+    return peaks[gauge].load(std::memory_order_relaxed);
+  }
+
+  /* Set all peaks back to the current values */
+  void resetPeaks();
+
+  /* Write all values, SQLite status and process memory to the log */
+  void log() const;
+
+  static SqliteStatus getSqliteStatus();
+
+  static QString gaugeName(Gauge gauge);
+
+  /* true if the gauge counts bytes and not rows */
+  static bool isBytes(Gauge gauge)
+  {
+    return gauge != MODEL_ROWS && gauge != MODEL_EVICTED_ROWS;
+  }
+
+  /* Estimated heap size of a value or a list of values */
+  static qint64 estimateBytes(const QVariant& value);
+  static qint64 estimateBytes(const QVariantList& list);
+
+private:
+  MemoryStats();
+
+  std::atomic<qint64> values[NUM_GAUGES], peaks[NUM_GAUGES];
+};
+
+#endif // LITTLELOGBOOK_MEMORYSTATS_H
@@ -0,0 +1,282 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "diag/querystats.h"
+#include "diag/slowquerylog.h"
+
+#include "logging/loggingdefs.h"
+
+#include <QMutexLocker>
+#include <QObject>
+#include <QSqlQuery>
+#include <QSqlResult>
+#include <QVariant>
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(LITTLELOGBOOK_SQLITE_API)
+#include <sqlite3.h>
+#endif
+
+namespace {
+
+/* Each power of two is split into 16 linear buckets */
+const int SUB_BUCKET_BITS = 5;
+const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+const int HALF_SUB_BUCKETS = SUB_BUCKETS / 2;
+
+/* Highest bit of the largest value - about 25 days in microseconds */
+const int MAX_BIT = 40;
+const int NUM_BUCKETS = SUB_BUCKETS + (MAX_BIT - SUB_BUCKET_BITS + 1) * HALF_SUB_BUCKETS;
+
+/* Index of the highest set bit */
+int highestBit(qint64 value)
+{
+  int bit = 0;
+  while(value >>= 1)
+    bit++;
+  return bit;
+}
+
+}
+
+LatencyHistogram::LatencyHistogram()
+  : buckets(NUM_BUCKETS, 0)
+{
+}
+
+int LatencyHistogram::bucketIndex(qint64 value)
+{
+  if(value < SUB_BUCKETS)
+    return static_cast<int>(value);
+
+  // Shift the value so that it falls into the upper half of the sub buckets
+  int shift = highestBit(value) - SUB_BUCKET_BITS + 1;
+  int sub = static_cast<int>(value >> shift);
+  return SUB_BUCKETS + (shift - 1) * HALF_SUB_BUCKETS + (sub - HALF_SUB_BUCKETS);
+}
+
+qint64 LatencyHistogram::bucketValue(int index)
+{
+  if(index < SUB_BUCKETS)
+    return index;
+
+  int shift = (index - SUB_BUCKETS) / HALF_SUB_BUCKETS + 1;
+  qint64 sub = (index - SUB_BUCKETS) % HALF_SUB_BUCKETS + HALF_SUB_BUCKETS;
+
+  // Middle of the bucket range
+  return (sub << shift) + (Q_INT64_C(1) << shift) / 2;
+}
+
+void LatencyHistogram::record(qint64 nanos)
+{
+  qint64 us = std::min(std::max(nanos / 1000, Q_INT64_C(0)), (Q_INT64_C(1) << (MAX_BIT + 1)) - 1);
+
+  buckets[bucketIndex(us)]++;
+
+  if(count == 0 || us < minUs)
+    minUs = us;
+  maxUs = std::max(maxUs, us);
+  sumUs += us;
+  count++;
+}
+
+void LatencyHistogram::clear()
+{
+  buckets.fill(0);
+  count = sumUs = minUs = maxUs = 0;
+}
+
+qint64 LatencyHistogram::getPercentileUs(double percentile) const
+{
+  if(count == 0)
+    return 0;
+
+  qint64 target = std::max(static_cast<qint64>(std::ceil(percentile / 100. * count)), Q_INT64_C(1));
+  qint64 sum = 0;
+  for(int i = 0; i < buckets.size(); i++)
+  {
+    sum += buckets.at(i);
+    if(sum >= target)
+      return std::min(std::max(bucketValue(i), minUs), maxUs);
+  }
+  return maxUs;
+}
+
+QueryStats::QueryStats()
+  : stats(NUM_CATEGORIES)
+{
+}
+
+QueryStats& QueryStats::instance()
+{
+  static QueryStats queryStats;
+  return queryStats;
+}
+
+void QueryStats::record(Category category, qint64 nanos, qint64 rowsReturned, qint64 rowsScanned,
+                        qint64 sorts)
+{
+  QMutexLocker locker(&mutex);
+  CategoryStats& s = stats[category];
+  s.histogram.record(nanos);
+  s.rowsReturned += rowsReturned;
+  s.rowsScanned += rowsScanned;
+  s.sorts += sorts;
+}
+
+QVector<QueryStats::CategoryStats> QueryStats::getStats() const
+{
+  QMutexLocker locker(&mutex);
+  return stats;
+}
+
+void QueryStats::reset()
+{
+  QMutexLocker locker(&mutex);
+  stats = QVector<CategoryStats>(NUM_CATEGORIES);
+}
+
+void QueryStats::log() const
+{
+  QVector<CategoryStats> current = getStats();
+  for(int i = 0; i < NUM_CATEGORIES; i++)
+  {
+    const CategoryStats& s = current.at(i);
+    if(s.histogram.getCount() > 0)
+      qInfo().nospace() << "Queries " << categoryName(static_cast<Category>(i))
+                        << ": count " << s.histogram.getCount()
+                        << " mean " << s.histogram.getMeanUs() << " us"
+                        << " p50 " << s.histogram.getPercentileUs(50.) << " us"
+                        << " p99 " << s.histogram.getPercentileUs(99.) << " us"
+                        << " max " << s.histogram.getMaxUs() << " us"
+                        << " rows " << s.rowsReturned
+                        << " scanned " << s.rowsScanned
+                        << " sorts " << s.sorts;
+  }
+}
+
+QString QueryStats::categoryName(Category category)
+{
+  switch(category)
+  {
+    case COUNT:
+      return QObject::tr("Count");
+
+    case PAGE_FETCH:
+      return QObject::tr("Page fetch");
+
+    case STATS:
+      return QObject::tr("Statistics");
+
+    case TOOLTIP:
+      return QObject::tr("Tooltip");
+
+    case EXPORT:
+      return QObject::tr("Export");
+
+    case IMPORT:
+      return QObject::tr("Import");
+
+    case FILTER:
+      return QObject::tr("Filter");
+
+    case NUM_CATEGORIES:
+      break;
+  }
+  return QString();
+}
+
+QueryTimer::QueryTimer(QueryStats::Category queryCategory)
+  : category(queryCategory)
+{
+  timer.start();
+}
+
+QueryTimer::~QueryTimer()
+{
+  pause();
+  QueryStats::instance().record(category, elapsedNs, rows, scanned, sorts);
+
+  if(slowQueryDb != nullptr && SlowQueryLog::isEnabled() && elapsedNs >= SlowQueryLog::getThresholdNs())
+  {
+    SlowQueryLog::Entry entry;
+    entry.category = QueryStats::categoryName(category);
+    entry.sql = slowQuerySql;
+    entry.state = slowQueryState;
+    entry.binds = slowQueryBinds;
+    entry.nanos = elapsedNs;
+    entry.rows = rows;
+    entry.scanned = scanned;
+    entry.sorts = sorts;
+    SlowQueryLog::write(slowQueryDb, entry);
+  }
+}
+
+void QueryTimer::setQueryInfo(atools::sql::SqlDatabase *db, const QString& sql, const QString& state,
+                              const QVariantMap& binds)
+{
+  if(SlowQueryLog::isEnabled())
+  {
+    slowQueryDb = db;
+    slowQuerySql = sql;
+    slowQueryState = state;
+    slowQueryBinds = binds;
+  }
+}
+
+void QueryTimer::addStatementCounters(const QSqlQuery& query)
+{
+#if defined(LITTLELOGBOOK_SQLITE_API)
+  const QSqlResult *result = query.result();
+  if(result == nullptr)
+    return;
+
+  QVariant handle = result->handle();
+  if(handle.isValid() && qstrcmp(handle.typeName(), "sqlite3_stmt*") == 0)
+  {
+    sqlite3_stmt *stmt = *static_cast<sqlite3_stmt *const *>(handle.constData());
+    if(stmt != nullptr)
+    {
+      // Reset counters so the next call gets only the new steps of the statement
+      scanned += sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+      sorts += sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_SORT, 1);
+    }
+  }
+#else
+  Q_UNUSED(query);
+#endif
+}
+
+void QueryTimer::pause()
+{
+  if(running)
+  {
+    elapsedNs += timer.nsecsElapsed();
+    running = false;
+  }
+}
+
+void QueryTimer::resume()
+{
+  if(!running)
+  {
+    timer.restart();
+    running = true;
+  }
+}
@@ -0,0 +1,189 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_QUERYSTATS_H
+#define LITTLELOGBOOK_QUERYSTATS_H
+
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+}
+
+class QSqlQuery;
+
+/*
+ * Latency histogram with logarithmic buckets that are split linearly like a
+ * HDR histogram. Values are stored in microseconds with a precision of about
+ * 3 to 6 percent. Values below 32 microseconds are exact.
+ */
+class LatencyHistogram
+{
+public:
+  LatencyHistogram();
+
+  /* Add a value in nanoseconds */
+  void record(qint64 nanos);
+
+  void clear();
+
+  qint64 getCount() const
+  {
+    return count;
+  }
+
+  /* Values in microseconds. All are 0 if the histogram is empty. */
+  qint64 getMinUs() const
+  {
+    return count > 0 ? minUs : 0;
+  }
+
+  qint64 getMaxUs() const
+  {
+    return maxUs;
+  }
+
+  double getMeanUs() const
+  {
+    return count > 0 ? static_cast<double>(sumUs) / count : 0.;
+  }
+
+  /* Value at percentile (0 to 100) in microseconds */
+  qint64 getPercentileUs(double percentile) const;
+
+private:
+  static int bucketIndex(qint64 value);
+  static qint64 bucketValue(int index);
+
+  QVector<qint64> buckets;
+  qint64 count = 0, sumUs = 0, minUs = 0, maxUs = 0;
+};
+
+/*
+ * Collects the execution times of all SQL queries by category together with
+ * the number of rows returned and SQLite counters for full scan steps and sorts.
+ * Thread safe. Use QueryTimer to record a query.
+ */
+class QueryStats
+{
+public:
+  enum Category
+  {
+    COUNT, /* Count query of the table view */
+    PAGE_FETCH, /* First page and further pages of the table view */
+    STATS, /* Statistics dock */
+    TOOLTIP, /* Airport tooltips */
+    EXPORT, /* Queries of all exporters */
+    IMPORT, /* Inserts and other statements of the bulk loader */
+    FILTER, /* Evaluation of single filter conditions for the filter cache */
+    NUM_CATEGORIES
+  };
+
+  struct CategoryStats
+  {
+    LatencyHistogram histogram;
+    qint64 rowsReturned = 0;
+    qint64 rowsScanned = 0; /* Steps in full table scans */
+    qint64 sorts = 0; /* Sort operations */
+  };
+
+  static QueryStats& instance();
+
+  void record(Category category, qint64 nanos, qint64 rowsReturned, qint64 rowsScanned, qint64 sorts);
+
+  /* Copy of the statistics of all categories indexed by Category */
+  QVector<CategoryStats> getStats() const;
+
+  /* Remove all collected values */
+  void reset();
+
+  /* Write a summary of all categories to the log */
+  void log() const;
+
+  static QString categoryName(Category category);
+
+private:
+  QueryStats();
+
+  mutable QMutex mutex;
+  QVector<CategoryStats> stats;
+};
+
+/*
+ * Measures the time from construction to destruction and records it in
+ * QueryStats. The timer can be paused to leave out time used for processing
+ * the rows, e.g. by iterating with next().
+ *
+ * Queries exceeding the threshold of SlowQueryLog are written to the slow query
+ * log if setQueryInfo() was called.
+ */
+class QueryTimer
+{
+public:
+  QueryTimer(QueryStats::Category queryCategory);
+  ~QueryTimer();
+
+  void addRows(qint64 numRows)
+  {
+    rows += numRows;
+  }
+
+  /* Read and reset the full scan and sort counters of the SQLite statement.
+   * Has to be called before the query is finished. Does nothing if not built
+   * with "CONFIG+=system_sqlite". */
+  void addStatementCounters(const QSqlQuery& query);
+
+  /* Statement, bound values and a description of the filter or grouping state
+   * for the slow query log. db has to be the connection of the calling thread and
+   * has to be valid until the timer is destroyed. Does nothing if the slow query
+   * log is disabled. */
+  void setQueryInfo(atools::sql::SqlDatabase *db, const QString& sql, const QString& state = QString(),
+                    const QVariantMap& binds = QVariantMap());
+
+  /* Stop or continue measuring */
+  void pause();
+  void resume();
+
+  /* Fetch the next row with the timer running and count it */
+  template<typename QUERY>
+  bool next(QUERY& query)
+  {
+    resume();
+    bool hasNext = query.next();
+    pause();
+    if(hasNext)
+      rows++;
+    return hasNext;
+  }
+
+private:
+  QueryStats::Category category;
+  QElapsedTimer timer;
+  atools::sql::SqlDatabase *slowQueryDb = nullptr;
+  QString slowQuerySql, slowQueryState;
+  QVariantMap slowQueryBinds;
+  qint64 elapsedNs = 0, rows = 0, scanned = 0, sorts = 0;
+  bool running = true;
+};
+
+#endif // LITTLELOGBOOK_QUERYSTATS_H
@@ -0,0 +1,180 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "diag/slowquerylog.h"
+
+#include "gui/constants.h"
+#include "settings/settings.h"
+#include "sql/sqldatabase.h"
+#include "logging/loggingdefs.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QTextStream>
+
+using atools::settings::Settings;
+
+std::atomic<qint64> SlowQueryLog::thresholdNs(0);
+
+namespace {
+
+/* Default threshold for the setting */
+const int DEFAULT_THRESHOLD_MS = 250;
+
+/* Roll the file over when reaching this size and keep two backups like the log file */
+const qint64 MAX_FILE_SIZE = 1024 * 1024;
+const int MAX_BACKUP_FILES = 2;
+
+QMutex mutex;
+
+/* Move filename to filename.1, filename.1 to filename.2 and so on */
+void rollFiles(const QString& filename)
+{
+  QFile::remove(filename + "." + QString::number(MAX_BACKUP_FILES));
+  for(int i = MAX_BACKUP_FILES - 1; i > 0; i--)
+    QFile::rename(filename + "." + QString::number(i), filename + "." + QString::number(i + 1));
+  QFile::rename(filename, filename + ".1");
+}
+
+/* Get query plan lines indented by depth. fullScan and tempBTree are set if
+ * any step scans a table without index or sorts into a temporary B-tree. */
+QStringList queryPlan(atools::sql::SqlDatabase *db, const QString& sql, const QVariantMap& binds,
+                      bool& fullScan, bool& tempBTree)
+{
+  QStringList plan;
+  QSqlQuery query(db->getQSqlDatabase());
+  if(!query.prepare("explain query plan " + sql))
+  {
+    plan.append("Error: " + query.lastError().text());
+    return plan;
+  }
+
+  for(auto it = binds.constBegin(); it != binds.constEnd(); ++it)
+    query.bindValue(it.key(), it.value());
+
+  if(!query.exec())
+  {
+    plan.append("Error: " + query.lastError().text());
+    return plan;
+  }
+
+  // Columns are id, parent, notused and detail - parent is used for indentation
+  QHash<int, int> depths;
+  while(query.next())
+  {
+    int depth = depths.value(query.value(1).toInt(), -1) + 1;
+    depths.insert(query.value(0).toInt(), depth);
+
+    QString detail = query.value(3).toString();
+    QString flag;
+    if(detail.startsWith("SCAN") && !detail.contains("USING INDEX") &&
+       !detail.contains("USING COVERING INDEX") && !detail.contains("USING INTEGER PRIMARY KEY"))
+    {
+      fullScan = true;
+      flag = "  <-- full scan";
+    }
+    else if(detail.contains("TEMP B-TREE"))
+    {
+      tempBTree = true;
+      flag = "  <-- temp b-tree";
+    }
+    plan.append(QString(depth * 2, ' ') + detail + flag);
+  }
+  query.finish();
+  return plan;
+}
+
+QString bindsText(const QVariantMap& binds)
+{
+  if(binds.isEmpty())
+    return "none";
+
+  QStringList list;
+  for(auto it = binds.constBegin(); it != binds.constEnd(); ++it)
+    list.append(it.key() + "=" + (it.value().isNull() ? QString("null") : "\"" + it.value().toString() + "\""));
+  return list.join(", ");
+}
+
+}
+
+void SlowQueryLog::configure()
+{
+  int ms = Settings::instance().getAndStoreValue(ll::constants::SETTINGS_SLOW_QUERY_MS,
+                                                 DEFAULT_THRESHOLD_MS).toInt();
+  setThresholdMs(ms);
+  if(isEnabled())
+    qInfo() << "Logging queries slower than" << ms << "ms to" << getFilename();
+}
+
+void SlowQueryLog::setThresholdMs(int ms)
+{
+  thresholdNs.store(ms > 0 ? static_cast<qint64>(ms) * 1000000L : 0L);
+}
+
+QString SlowQueryLog::getFilename()
+{
+  return QDir(QStandardPaths::writableLocation(QStandardPaths::TempLocation)).
+         filePath("littlelogbook-slowqueries.log");
+}
+
+void SlowQueryLog::write(atools::sql::SqlDatabase *db, const Entry& entry)
+{
+  bool fullScan = false, tempBTree = false;
+  QStringList plan = queryPlan(db, entry.sql, entry.binds, fullScan, tempBTree);
+
+  QString flags;
+  if(fullScan)
+    flags += " [FULL SCAN]";
+  if(tempBTree)
+    flags += " [TEMP B-TREE]";
+
+  QString filename = getFilename();
+
+  QMutexLocker locker(&mutex);
+  if(QFileInfo(filename).size() > MAX_FILE_SIZE)
+    rollFiles(filename);
+
+  QFile file(filename);
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text))
+  {
+    qWarning() << "Cannot write slow query log" << filename << file.errorString();
+    return;
+  }
+
+  QTextStream stream(&file);
+  stream << QDateTime::currentDateTime().toString("yyyy-MM-dd hh:mm:ss.zzz") << " "
+         << entry.category << " " << QString::number(entry.nanos / 1000000., 'f', 1) << " ms"
+         << " rows " << entry.rows << " scanned " << entry.scanned << " sorts " << entry.sorts
+         << flags << endl;
+  stream << "state: " << (entry.state.isEmpty() ? QString("none") : entry.state) << endl;
+  stream << "binds: " << bindsText(entry.binds) << endl;
+  stream << "sql: " << entry.sql.simplified() << endl;
+  stream << "plan:" << endl;
+  for(const QString& line : plan)
+    stream << "  " << line << endl;
+  stream << endl;
+
+  qWarning().noquote() << "Slow query" << entry.category << entry.nanos / 1000000 << "ms" << flags;
+}
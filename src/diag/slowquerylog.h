@@ -0,0 +1,78 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_SLOWQUERYLOG_H
+#define LITTLELOGBOOK_SLOWQUERYLOG_H
+
+#include <QString>
+#include <QVariantMap>
+
+#include <atomic>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+}
+
+/*
+ * Writes queries that took longer than a threshold into a rolling log file
+ * together with the query plan, bound values, row counts and the filter and
+ * grouping state of the caller. Plan steps that scan a whole table or use a
+ * temporary B-tree for sorting or grouping are flagged.
+ *
+ * Queries are passed by QueryTimer if the caller added the query information.
+ */
+class SlowQueryLog
+{
+public:
+  /* A finished query exceeding the threshold */
+  struct Entry
+  {
+    QString category, sql, state;
+    QVariantMap binds;
+    qint64 nanos = 0, rows = 0, scanned = 0, sorts = 0;
+  };
+
+  /* Read threshold from the setting "Diagnostics/SlowQueryMs". A value of 0 or
+   * less disables the log. */
+  static void configure();
+
+  static bool isEnabled()
+  {
+    return thresholdNs.load(std::memory_order_relaxed) > 0;
+  }
+
+  /* Threshold in nanoseconds or 0 if disabled */
+  static qint64 getThresholdNs()
+  {
+    return thresholdNs.load(std::memory_order_relaxed);
+  }
+
+  static void setThresholdMs(int ms);
+
+  /* Runs "explain query plan" for the entry on db, which has to be the
+   * connection of the calling thread, and appends everything to the log file */
+  static void write(atools::sql::SqlDatabase *db, const Entry& entry);
+
+  static QString getFilename();
+
+private:
+  static std::atomic<qint64> thresholdNs;
+};
+
+#endif // LITTLELOGBOOK_SLOWQUERYLOG_H
@@ -0,0 +1,167 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "diag/tracer.h"
+
+#include "gui/constants.h"
+#include "settings/settings.h"
+#include "logging/loggingdefs.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QThread>
+#include <QVector>
+
+using atools::settings::Settings;
+
+std::atomic<bool> Tracer::enabled(false);
+
+namespace {
+
+struct TraceEvent
+{
+  const char *name, *category;
+  qint64 startUs, durationUs, rows;
+  int threadId;
+};
+
+/* Environment variable containing the trace filename */
+const char *TRACE_ENV_VAR = "LITTLELOGBOOK_TRACE";
+
+QMutex mutex;
+QElapsedTimer traceTimer;
+QString traceFile;
+QVector<TraceEvent> events;
+
+/* Small thread numbers in order of appearance and the thread names */
+QHash<Qt::HANDLE, int> threadIds;
+QVector<QString> threadNames;
+
+/* Get the number for the current thread. Mutex has to be locked. */
+int currentThreadId()
+{
+  Qt::HANDLE handle = QThread::currentThreadId();
+  auto it = threadIds.constFind(handle);
+  if(it != threadIds.constEnd())
+    return it.value();
+
+  QThread *thread = QThread::currentThread();
+  QString name = thread->objectName();
+  if(thread == QCoreApplication::instance()->thread())
+    name = "main";
+  else if(name.isEmpty())
+    name = QString("thread %1").arg(threadIds.size() + 1);
+
+  int id = threadIds.size() + 1;
+  threadIds.insert(handle, id);
+  threadNames.append(name);
+  return id;
+}
+
+}
+
+void Tracer::startIfConfigured()
+{
+  QString filename = QString::fromLocal8Bit(qgetenv(TRACE_ENV_VAR));
+  if(filename.isEmpty())
+    filename = Settings::instance()->value(ll::constants::SETTINGS_TRACE_FILE).toString();
+
+  if(!filename.isEmpty())
+    start(filename);
+}
+
+void Tracer::start(const QString& filename)
+{
+  QMutexLocker locker(&mutex);
+  traceFile = filename;
+  events.clear();
+  threadIds.clear();
+  threadNames.clear();
+  traceTimer.start();
+  enabled.store(true);
+  qInfo() << "Tracing to" << filename;
+}
+
+bool Tracer::stop()
+{
+  if(!enabled.exchange(false))
+    return true;
+
+  QMutexLocker locker(&mutex);
+  qint64 pid = QCoreApplication::applicationPid();
+
+  QJsonArray traceEvents;
+  for(int i = 0; i < threadNames.size(); i++)
+  {
+    QJsonObject meta;
+    meta.insert("name", QString("thread_name"));
+    meta.insert("ph", QString("M"));
+    meta.insert("pid", pid);
+    meta.insert("tid", i + 1);
+    meta.insert("args", QJsonObject({{"name", threadNames.at(i)}}));
+    traceEvents.append(meta);
+  }
+
+  for(const TraceEvent& event : events)
+  {
+    QJsonObject obj;
+    obj.insert("name", QString(event.name));
+    obj.insert("cat", QString(event.category));
+    obj.insert("ph", QString("X"));
+    obj.insert("ts", event.startUs);
+    obj.insert("dur", event.durationUs);
+    obj.insert("pid", pid);
+    obj.insert("tid", event.threadId);
+    if(event.rows >= 0)
+      obj.insert("args", QJsonObject({{"rows", event.rows}}));
+    traceEvents.append(obj);
+  }
+  events.clear();
+
+  QJsonObject root;
+  root.insert("traceEvents", traceEvents);
+  root.insert("displayTimeUnit", QString("ms"));
+
+  QFile file(traceFile);
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qWarning() << "Cannot write trace file" << traceFile << file.errorString();
+    return false;
+  }
+  file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+  qInfo() << "Trace written to" << traceFile;
+  return true;
+}
+
+qint64 Tracer::nowUs()
+{
+  return traceTimer.nsecsElapsed() / 1000;
+}
+
+void Tracer::addSpan(const char *name, const char *category, qint64 startUs, qint64 durationUs, qint64 rows)
+{
+  QMutexLocker locker(&mutex);
+  if(enabled.load())
+    events.append({name, category, startUs, durationUs, rows, currentThreadId()});
+}
@@ -0,0 +1,98 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_TRACER_H
+#define LITTLELOGBOOK_TRACER_H
+
+#include <QString>
+
+#include <atomic>
+
+/*
+ * Collects trace spans and writes them as Chrome trace event JSON which can be
+ * loaded into chrome://tracing or the Perfetto UI. Spans carry the thread and
+ * an optional row count.
+ *
+ * Disabled by default. Only a single atomic flag is checked by TraceSpan if not
+ * enabled so spans can stay in release builds.
+ */
+class Tracer
+{
+public:
+  /* Start collecting if the environment variable LITTLELOGBOOK_TRACE or the
+   * setting "Diagnostics/TraceFile" contains a filename */
+  static void startIfConfigured();
+
+  /* Start collecting spans that are written to filename by stop() */
+  static void start(const QString& filename);
+
+  /* Stop collecting and write all spans. Does nothing if not started.
+   * @return false if the file could not be written */
+  static bool stop();
+
+  static bool isEnabled()
+  {
+    return enabled.load(std::memory_order_relaxed);
+  }
+
+  /* Microseconds since start */
+  static qint64 nowUs();
+
+  /* Add a finished span. rows is omitted if negative. */
+  static void addSpan(const char *name, const char *category, qint64 startUs, qint64 durationUs, qint64 rows);
+
+private:
+  static std::atomic<bool> enabled;
+};
+
+/*
+ * Adds a span from construction to destruction to the trace if tracing is
+ * enabled. name and category have to be string literals.
+ */
+class TraceSpan
+{
+public:
+  TraceSpan(const char *spanName, const char *spanCategory = "app")
+  {
+    if(Tracer::isEnabled())
+    {
+      name = spanName;
+      category = spanCategory;
+      startUs = Tracer::nowUs();
+      active = true;
+    }
+  }
+
+  ~TraceSpan()
+  {
+    if(active)
+      Tracer::addSpan(name, category, startUs, Tracer::nowUs() - startUs, rows);
+  }
+
+  /* Number of rows processed within the span */
+  void setRows(qint64 value)
+  {
+    rows = value;
+  }
+
+private:
+  const char *name = nullptr, *category = nullptr;
+  qint64 startUs = 0, rows = -1;
+  bool active = false;
+};
+
+#endif // LITTLELOGBOOK_TRACER_H
@@ -17,6 +17,9 @@
 
 #include "export/csvexporter.h"
 
+#include "diag/memorystats.h"
+#include "diag/querystats.h"
+#include "diag/tracer.h"
 #include "gui/constants.h"
 
 #include "gui/errorhandler.h"
@@ -24,6 +27,7 @@
 #include "gui/dialog.h"
 #include "sql/sqlexport.h"
 #include "table/controller.h"
+#include "table/selectstatement.h"
 
 #include "logging/loggingdefs.h"
 
@@ -41,6 +45,16 @@ CsvExporter::CsvExporter(QWidget *parent, Controller *controller) :
 {
 }
 
+CsvExporter::CsvExporter(ExportSource *source) :
+  Exporter(source)
+{
+}
+
+CsvExporter::CsvExporter(QWidget *parent, ExportSource *source) :
+  Exporter(parent, source)
+{
+}
+
 CsvExporter::~CsvExporter()
 {
 }
@@ -59,48 +73,66 @@ int CsvExporter::exportAll(bool open)
 
   if(!filename.isEmpty())
   {
-    qDebug() << "exportAllCsv" << filename;
-    QFile file(filename);
-
-    if(file.open(QIODevice::WriteOnly | QIODevice::Text))
-    {
-      QTextStream stream(&file);
-      qDebug() << "Used codec" << stream.codec()->name();
+    exported = exportAllTo(filename);
 
-      // Run the current query to get all results - not only the visible
-      atools::sql::SqlDatabase *db = controller->getSqlDatabase();
-      SqlQuery query(db);
-      query.exec(controller->getCurrentSqlQuery());
-
-      SqlExport sqlExport;
-      sqlExport.setSeparatorChar(';');
-      QVariantList values;
-
-      int row = 0;
-      while(query.next())
-      {
-        QSqlRecord rec = query.record();
-        if(row == 0)
-          stream << sqlExport.getResultSetHeader(headerNames(rec.count()));
-
-        // Write all columns
-        values.clear();
-        for(int col = 0; col < rec.count(); ++col)
-          // Get data formatted as shown in the table
-          values.append(controller->formatModelData(rec.fieldName(col), rec.value(col)));
-        stream << sqlExport.getResultSetRow(values);
-        row++;
-        exported++;
-      }
+    if(exported == -1)
+      exported = 0;
+    else if(open)
+      openDocument(filename);
+  }
+  return exported;
+}
 
-      stream.flush();
-      file.close();
+int CsvExporter::exportAllTo(const QString& filename)
+{
+  int exported = 0;
+  qDebug() << "exportAllCsv" << filename;
+  QFile file(filename);
 
-      if(open)
-        openDocument(filename);
+  if(file.open(QIODevice::WriteOnly | QIODevice::Text))
+  {
+    QTextStream stream(&file);
+    qDebug() << "Used codec" << stream.codec()->name();
+
+    // Run the current query to get all results - not only the visible
+    atools::sql::SqlDatabase *db = source->getReadDatabase();
+    QueryTimer timer(QueryStats::EXPORT);
+    SqlQuery query(db);
+    query.prepare(source->getCurrentSqlQuery());
+    SelectStatement::bindValues(query, source->getCurrentQueryBinds());
+    query.exec();
+    timer.pause();
+
+    SqlExport sqlExport;
+    sqlExport.setSeparatorChar(';');
+    QVariantList values;
+
+    int row = 0;
+    TraceSpan span("csvExportAll", "export");
+    while(timer.next(query))
+    {
+      QSqlRecord rec = query.record();
+      if(row == 0)
+        stream << sqlExport.getResultSetHeader(headerNames(rec.count()));
+
+      // Write all columns
+      values.clear();
+      for(int col = 0; col < rec.count(); ++col)
+        // Get data formatted as shown in the table
+        values.append(source->formatModelData(rec.fieldName(col), rec.value(col)));
+      stream << sqlExport.getResultSetRow(values);
+      row++;
+      exported++;
     }
-    else
-      errorHandler->handleIOError(file);
+    span.setRows(exported);
+
+    stream.flush();
+    file.close();
+  }
+  else
+  {
+    handleIOError(file);
+    return -1;
   }
   return exported;
 }
@@ -135,6 +167,9 @@ int CsvExporter::exportSelectedToString(QString *string)
       exported++;
     }
   stream.flush();
+
+  // The whole selection is kept as text and copied to the clipboard
+  MemoryStats::instance().set(MemoryStats::FORMATTED_BYTES, string->size() * static_cast<qint64>(sizeof(QChar)));
   return exported;
 }
 
@@ -162,6 +197,10 @@ int CsvExporter::exportSelected(bool open)
 
       stream << sqlExport.getResultSetHeader(headerNames(columnList.size()));
 
+      // Collapsed columns are not fetched by the model
+      controller->loadAllColumns();
+
+      TraceSpan span("csvExportSelected", "export");
       for(QItemSelectionRange rng : sel)
         for(int row = rng.top(); row <= rng.bottom(); ++row)
         {
@@ -169,6 +208,8 @@ int CsvExporter::exportSelected(bool open)
           stream << sqlExport.getResultSetRow(controller->getFormattedModelData(row));
           exported++;
         }
+      span.setRows(exported);
+      controller->updateCollapsedColumns();
 
       stream.flush();
       file.close();
@@ -177,7 +218,7 @@ int CsvExporter::exportSelected(bool open)
         openDocument(filename);
     }
     else
-      errorHandler->handleIOError(file);
+      handleIOError(file);
   }
   return exported;
 }
@@ -41,6 +41,13 @@ class CsvExporter :
 
 public:
   CsvExporter(QWidget *parentWidget, Controller *controller);
+
+  /* Exporter without widgets. Only exportAllTo() can be used. */
+  explicit CsvExporter(ExportSource *source);
+
+  /* Exporter with dialogs for a source other than the table view. Only exportAll() and
+   * exportAllTo() can be used. */
+  CsvExporter(QWidget *parentWidget, ExportSource *source);
   virtual ~CsvExporter();
 
   /* Export all rows.
@@ -57,6 +64,12 @@ public:
    */
   virtual int exportSelected(bool open);
 
+  /* Export all rows to the given file without dialogs.
+   *
+   * @return number of rows exported or -1 if the file could not be written.
+   */
+  virtual int exportAllTo(const QString& filename) override;
+
   /*
    * Export the selected rows to a string in CSV format. Uses view column
    * order and appearance like HTML export.
@@ -19,11 +19,13 @@
 #include "table/controller.h"
 #include "gui/dialog.h"
 #include "gui/errorhandler.h"
+#include "exception.h"
 #include "logging/loggingdefs.h"
 
 #include <QUrl>
 #include <QDesktopServices>
 #include <QApplication>
+#include <QFile>
 #include <QSqlField>
 #include <QSqlRecord>
 
@@ -31,7 +33,19 @@ using atools::gui::Dialog;
 using atools::gui::ErrorHandler;
 
 Exporter::Exporter(QWidget *parent, Controller *controllerObj)
-  : parentWidget(parent), controller(controllerObj)
+  : parentWidget(parent), controller(controllerObj), source(controllerObj)
+{
+  dialog = new Dialog(parent);
+  errorHandler = new ErrorHandler(parent);
+}
+
+Exporter::Exporter(ExportSource *exportSource)
+  : source(exportSource)
+{
+}
+
+Exporter::Exporter(QWidget *parent, ExportSource *exportSource)
+  : parentWidget(parent), source(exportSource)
 {
   dialog = new Dialog(parent);
   errorHandler = new ErrorHandler(parent);
@@ -50,11 +64,11 @@ void Exporter::createVisualColumnIndex(int cnt, QVector<int>& visualToIndex)
 
   for(int i = 0; i < cnt; ++i)
   {
-    int vindex = controller->getColumnVisualIndex(i);
+    int vindex = source->getColumnVisualIndex(i);
 
     Q_ASSERT(vindex >= 0);
 
-    if(controller->isColumnVisibleInView(i))
+    if(source->isColumnVisibleInView(i))
       visualToIndex[vindex] = i;
   }
 }
@@ -65,7 +79,7 @@ QStringList Exporter::headerNames(int cnt, const QVector<int>& visualToIndex)
 
   for(int i = 0; i < cnt; ++i)
     if(visualToIndex[i] != -1)
-      columnNames.append(controller->getColumn(visualToIndex[i])->getDisplayName().
+      columnNames.append(source->getColumn(visualToIndex[i])->getDisplayName().
                          replace("-\n", "").replace("\n", " "));
   return columnNames;
 }
@@ -75,11 +89,19 @@ QStringList Exporter::headerNames(int cnt)
   QStringList columnNames;
 
   for(int i = 0; i < cnt; ++i)
-    columnNames.append(controller->getColumn(i)->getDisplayName().
+    columnNames.append(source->getColumn(i)->getDisplayName().
                        replace("-\n", "").replace("\n", " "));
   return columnNames;
 }
 
+void Exporter::handleIOError(const QFile& file)
+{
+  if(errorHandler != nullptr)
+    errorHandler->handleIOError(file);
+  else
+    throw atools::Exception(QString("Cannot write file \"%1\": %2").arg(file.fileName()).arg(file.errorString()));
+}
+
 void Exporter::openDocument(const QString& file)
 {
   QUrl url(QUrl::fromLocalFile(file));
@@ -28,6 +28,8 @@ class ErrorHandler;
 }
 
 class Controller;
+class ExportSource;
+class QFile;
 class QWidget;
 class QSqlRecord;
 
@@ -41,14 +43,29 @@ class Exporter :
 
 public:
   Exporter(QWidget *parentWidget, Controller *controllerObj);
+
+  /* Creates an exporter without any widgets, dialogs or selection. Only
+   * exportAllTo() can be used. File errors are thrown as exceptions. */
+  explicit Exporter(ExportSource *exportSource);
+
+  /* Creates an exporter with dialogs for a source other than the table view.
+   * Only exportAll() and exportAllTo() can be used. */
+  Exporter(QWidget *parentWidget, ExportSource *exportSource);
   virtual ~Exporter();
 
   virtual int exportAll(bool open) = 0;
   virtual int exportSelected(bool open) = 0;
 
+  /* Export all rows of the current query to the given file without any dialogs.
+   *
+   * @return number of rows exported or -1 if the file could not be written.
+   */
+  virtual int exportAllTo(const QString& filename) = 0;
+
 protected:
   QWidget *parentWidget = nullptr;
   Controller *controller = nullptr;
+  ExportSource *source = nullptr;
   atools::gui::Dialog *dialog = nullptr;
   atools::gui::ErrorHandler *errorHandler = nullptr;
 
@@ -56,6 +73,9 @@ protected:
   QStringList headerNames(int cnt);
   QStringList headerNames(int cnt, const QVector<int>& visualToIndex);
 
+  /* Show an error dialog or throw an exception if running without widgets */
+  void handleIOError(const QFile& file);
+
   /* Open document with application */
   void openDocument(const QString& file);
 
@@ -0,0 +1,77 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_EXPORTSOURCE_H
+#define LITTLELOGBOOK_EXPORTSOURCE_H
+
+#include <QString>
+#include <QVariant>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+}
+
+class Column;
+
+/*
+ * Everything the exporters need to export all rows of the current query.
+ * Implemented by the Controller for the table view and by the command line
+ * export which runs without any widgets.
+ */
+class ExportSource
+{
+public:
+  virtual ~ExportSource()
+  {
+  }
+
+  /* Read-only connection of the calling thread */
+  virtual atools::sql::SqlDatabase *getReadDatabase() const = 0;
+
+  /* Full select statement including filters, grouping and order */
+  virtual QString getCurrentSqlQuery() const = 0;
+
+  /* Bind values for the select statement. The query has to be prepared. */
+  virtual QVariantMap getCurrentQueryBinds() const = 0;
+
+  /* Filters, grouping and order of the query for diagnostics */
+  virtual QString getQueryStateDescription() const = 0;
+
+  /* Total number of rows returned by the query */
+  virtual int getTotalRowCount() const = 0;
+
+  /* Return field data formatted as in the table view */
+  virtual QString formatModelData(const QString& col, const QVariant& var) const = 0;
+
+  /* Get descriptor for the query column at physical index */
+  virtual const Column *getColumn(int physicalIndex) const = 0;
+
+  /* Get the visual index for the column which is affected by column reordering */
+  virtual int getColumnVisualIndex(int physicalIndex) const = 0;
+
+  /* @return true if column at physical index should be exported where the
+   * visible columns are used */
+  virtual bool isColumnVisibleInView(int physicalIndex) const = 0;
+
+  /* Column name for sorted column */
+  virtual QString getSortColumn() const = 0;
+
+};
+
+#endif // LITTLELOGBOOK_EXPORTSOURCE_H
@@ -17,6 +17,8 @@
 
 #include "export/htmlexporter.h"
 
+#include "diag/querystats.h"
+#include "diag/tracer.h"
 #include "gui/constants.h"
 
 #include "gui/errorhandler.h"
@@ -24,6 +26,7 @@
 #include "gui/dialog.h"
 #include "settings/settings.h"
 #include "table/controller.h"
+#include "table/selectstatement.h"
 #include "sql/sqlquery.h"
 #include "logging/loggingdefs.h"
 
@@ -47,6 +50,16 @@ HtmlExporter::HtmlExporter(QWidget *parent, Controller *controller, int rowsPerP
 {
 }
 
+HtmlExporter::HtmlExporter(ExportSource *source, int rowsPerPage)
+  : Exporter(source), pageSize(rowsPerPage)
+{
+}
+
+HtmlExporter::HtmlExporter(QWidget *parent, ExportSource *source, int rowsPerPage)
+  : Exporter(parent, source), pageSize(rowsPerPage)
+{
+}
+
 HtmlExporter::~HtmlExporter()
 {
 }
@@ -60,7 +73,8 @@ QString HtmlExporter::saveHtmlFileDialog()
 
 bool HtmlExporter::askOverwriteDialog(const QString& basename, int totalPages)
 {
-  if(totalPages == 1)
+  // Always overwrite if running without widgets
+  if(totalPages == 1 || dialog == nullptr)
     return true;
 
   QStringList existingFiles;
@@ -95,32 +109,51 @@ bool HtmlExporter::askOverwriteDialog(const QString& basename, int totalPages)
 
 int HtmlExporter::exportAll(bool open)
 {
-  int exported = 0, totalToExport = 0, currentPage = 0, totalPages = 0, exportedPage = 0;
-
   QString filename = saveHtmlFileDialog();
-  QString basename = QFileInfo(filename).fileName();
-  qDebug() << "exportAllHtml" << filename;
 
   if(filename.isEmpty())
     return 0;
 
+  int exported = exportAllTo(filename);
+
+  if(exported == -1)
+    return 0;
+
+  if(open)
+    openDocument(filename);
+
+  return exported;
+}
+
+int HtmlExporter::exportAllTo(const QString& filename)
+{
+  int exported = 0, totalToExport = 0, currentPage = 0, totalPages = 0, exportedPage = 0;
+
+  QString basename = QFileInfo(filename).fileName();
+  qDebug() << "exportAllHtml" << filename;
+
   // Run the current query to get all results - not only the visible
-  atools::sql::SqlDatabase *db = controller->getSqlDatabase();
+  atools::sql::SqlDatabase *db = source->getReadDatabase();
+  QueryTimer timer(QueryStats::EXPORT);
   SqlQuery query(db);
-  query.exec(controller->getCurrentSqlQuery());
-  totalToExport = controller->getTotalRowCount();
+  query.prepare(source->getCurrentSqlQuery());
+  SelectStatement::bindValues(query, source->getCurrentQueryBinds());
+  query.exec();
+  timer.pause();
+  totalToExport = source->getTotalRowCount();
   totalPages = (int)ceil((double)totalToExport / (double)pageSize);
 
   if(!askOverwriteDialog(filename, totalPages))
-    return exported;
+    return -1;
 
   QFile file(filename);
   QXmlStreamWriter stream;
   if(!startFile(file, basename, stream, currentPage, totalPages))
-    return exported;
+    return -1;
 
   QVector<int> visualColumnIndex;
-  while(query.next())
+  TraceSpan span("htmlExportAll", "export");
+  while(timer.next(query))
   {
     QSqlRecord rec = query.record();
 
@@ -156,15 +189,13 @@ int HtmlExporter::exportAll(bool open)
 
       file.setFileName(filenameForPage(filename, currentPage));
       if(!startFile(file, basename, stream, currentPage, totalPages))
-        return exported;
+        return -1;
     }
   }
+  span.setRows(exported);
 
   endFile(file, basename, stream, currentPage, totalPages);
 
-  if(open)
-    openDocument(filename);
-
   return exported;
 }
 
@@ -196,6 +227,7 @@ int HtmlExporter::exportSelected(bool open)
 
   QVector<int> visualColumnIndex;
 
+  TraceSpan span("htmlExportSelected", "export");
   for(QItemSelectionRange rng : sel)
     for(int row = rng.top(); row <= rng.bottom(); ++row)
     {
@@ -236,6 +268,7 @@ int HtmlExporter::exportSelected(bool open)
           return exported;
       }
     }
+  span.setRows(exported);
 
   endFile(file, basename, stream, currentPage, totalPages);
 
@@ -253,7 +286,7 @@ bool HtmlExporter::startFile(QFile& file,
 {
   if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
   {
-    errorHandler->handleIOError(file);
+    handleIOError(file);
     return false;
   }
 
@@ -301,7 +334,7 @@ void HtmlExporter::writeHtmlStart(QXmlStreamWriter& stream, const QString& cssFi
     cssFile.close();
   }
   else
-    errorHandler->handleIOError(cssFile);
+    handleIOError(cssFile);
 
   stream.writeStartDocument();
   stream.writeStartElement("html");
@@ -430,7 +463,7 @@ void HtmlExporter::writeHtmlTableCellFormatted(QXmlStreamWriter& stream,
                                                QVariant value,
                                                int row)
 {
-  QString fmtVal = controller->formatModelData(fieldName, value);
+  QString fmtVal = source->formatModelData(fieldName, value);
   writeHtmlTableCellRaw(stream, fieldName, fmtVal, row);
 }
 
@@ -440,7 +473,7 @@ void HtmlExporter::writeHtmlTableCellRaw(QXmlStreamWriter& stream,
                                          int row)
 {
   stream.writeStartElement("td");
-  if(fieldName == controller->getSortColumn())
+  if(fieldName == source->getSortColumn())
   {
     // Change table field background color to darker if it is the sorting
     // columns
@@ -39,6 +39,14 @@ class HtmlExporter :
 
 public:
   HtmlExporter(QWidget *parentWidget, Controller *controller, int rowsPerPage);
+
+  /* Exporter without widgets. Only exportAllTo() can be used. Existing page
+   * files are overwritten. */
+  HtmlExporter(ExportSource *source, int rowsPerPage);
+
+  /* Exporter with dialogs for a source other than the table view. Only exportAll() and
+   * exportAllTo() can be used. */
+  HtmlExporter(QWidget *parentWidget, ExportSource *source, int rowsPerPage);
   virtual ~HtmlExporter();
 
   /* Export all rows.
@@ -55,6 +63,13 @@ public:
    */
   virtual int exportSelected(bool open);
 
+  /* Export all rows to the given file and additional page files without dialogs.
+   *
+   * @return number of rows exported or -1 if a file could not be written or
+   * the user declined to overwrite existing page files.
+   */
+  virtual int exportAllTo(const QString& filename) override;
+
 private:
   int pageSize = 500;
 
@@ -16,11 +16,14 @@
 *****************************************************************************/
 
 #include "export/kmlexporter.h"
+#include "diag/querystats.h"
+#include "diag/tracer.h"
 #include "gui/dialog.h"
 #include "gui/constants.h"
 #include "logging/loggingdefs.h"
 #include "gui/errorhandler.h"
 #include "table/controller.h"
+#include "table/selectstatement.h"
 #include "sql/sqlquery.h"
 #include "sql/sqldatabase.h"
 #include "table/formatter.h"
@@ -40,6 +43,17 @@ using atools::settings::Settings;
 
 KmlExporter::KmlExporter(QWidget *parent, Controller *controller)
   : Exporter(parent, controller)
+{
+  readSettings();
+}
+
+KmlExporter::KmlExporter(ExportSource *source)
+  : Exporter(source)
+{
+  readSettings();
+}
+
+void KmlExporter::readSettings()
 {
   Settings& s = Settings::instance();
 
@@ -84,13 +98,30 @@ void KmlExporter::skippedEntriesDialog(int skipped)
 
 int KmlExporter::exportAll(bool open)
 {
-  int exported = 0, skipped = 0;
   QString filename = saveKmlFileDialog();
-  qDebug() << "exportAllKml" << filename;
 
   if(filename.isEmpty())
     return 0;
 
+  int exported = exportAllTo(filename);
+
+  if(exported == -1)
+    return 0;
+
+  skippedEntriesDialog(numSkipped);
+
+  if(open)
+    openDocument(filename);
+
+  return exported;
+}
+
+int KmlExporter::exportAllTo(const QString& filename)
+{
+  int exported = 0;
+  numSkipped = 0;
+  qDebug() << "exportAllKml" << filename;
+
   prepareQuery();
 
   // Open file and write all headers including styles
@@ -99,11 +130,18 @@ int KmlExporter::exportAll(bool open)
   if(startFile(file, stream))
   {
     // Run the current query to get all results - not only the visible
-    SqlDatabase *db = controller->getSqlDatabase();
+    SqlDatabase *db = source->getReadDatabase();
+    QueryTimer timer(QueryStats::EXPORT);
+    timer.setQueryInfo(db, source->getCurrentSqlQuery(), source->getQueryStateDescription(),
+                       source->getCurrentQueryBinds());
     SqlQuery query(db);
-    query.exec(controller->getCurrentSqlQuery());
+    query.prepare(source->getCurrentSqlQuery());
+    SelectStatement::bindValues(query, source->getCurrentQueryBinds());
+    query.exec();
+    timer.pause();
 
-    while(query.next())
+    TraceSpan span("kmlExportAll", "export");
+    while(timer.next(query))
     {
       QSqlRecord rec = query.record();
       if(!(rec.isNull("airport_from_name") || rec.isNull("airport_to_name")))
@@ -112,16 +150,15 @@ int KmlExporter::exportAll(bool open)
         exported++;
       }
       else
-        skipped++;
+        numSkipped++;
     }
+    span.setRows(exported);
 
     endFile(file, stream);
-
-    skippedEntriesDialog(skipped);
-
-    if(open)
-      openDocument(filename);
   }
+  else
+    exported = -1;
+
   deleteQuery();
   return exported;
 }
@@ -144,6 +181,11 @@ int KmlExporter::exportSelected(bool open)
   {
     QSqlRecord rec;
     const QItemSelection sel = controller->getSelection();
+
+    // Coordinates and airport names might be in collapsed columns
+    controller->loadAllColumns();
+
+    TraceSpan span("kmlExportSelected", "export");
     for(QItemSelectionRange rng : sel)
       for(int row = rng.top(); row <= rng.bottom(); ++row)
       {
@@ -156,6 +198,8 @@ int KmlExporter::exportSelected(bool open)
         else
           skipped++;
       }
+    span.setRows(exported);
+    controller->updateCollapsedColumns();
 
     endFile(file, stream);
 
@@ -173,7 +217,7 @@ void KmlExporter::prepareQuery()
 {
   if(airportDetailQuery == nullptr)
   {
-    airportDetailQuery = new SqlQuery(controller->getSqlDatabase());
+    airportDetailQuery = new SqlQuery(source->getReadDatabase());
     airportDetailQuery->prepare(
       "select longitude, latitude, altitude, max_runway_length, has_lights, has_ils "
       "from airport "
@@ -194,7 +238,7 @@ bool KmlExporter::startFile(QFile& file, QXmlStreamWriter& stream)
 {
   if(!file.open(QIODevice::WriteOnly | QIODevice::Text))
   {
-    errorHandler->handleIOError(file);
+    handleIOError(file);
     return false;
   }
 
@@ -375,11 +419,11 @@ QString KmlExporter::flightDescription(QSqlRecord rec)
   retval += "<table border=\"1\" cellpadding=\"2\" cellspacing=\"0\"><tbody>";
 
   retval += "<tr><td>" + tr("Simulator:") + "</td><td>" +
-            controller->formatModelData("simulator_id", rec.value("simulator_id")) + "</td>";
+            source->formatModelData("simulator_id", rec.value("simulator_id")) + "</td>";
   retval += "<tr><td>" + tr("Logbook ID:") + "</td><td>" +
-            controller->formatModelData("logbook_id", rec.value("logbook_id")) + "</td>";
+            source->formatModelData("logbook_id", rec.value("logbook_id")) + "</td>";
   retval += "<tr><td>" + tr("Start Time:") + "</td><td>" +
-            controller->formatModelData("startdate", rec.value("startdate")) + "</td>";
+            source->formatModelData("startdate", rec.value("startdate")) + "</td>";
 
   retval += "<tr><td>" + tr("Distance:") + "</td><td>" +
             l.toString(rec.value("distance").toDouble(), 'f', 0) + " NM</td>";
@@ -398,7 +442,7 @@ QString KmlExporter::flightDescription(QSqlRecord rec)
   retval += "<tr><td>" + tr("Aircraft Description:") + "</td><td>" +
             rec.value("aircraft_descr").toString() + "</td>";
   retval += "<tr><td>" + tr("Aircraft Type:") + "</td><td>" +
-            controller->formatModelData("aircraft_type", rec.value("aircraft_type")) + "</td>";
+            source->formatModelData("aircraft_type", rec.value("aircraft_type")) + "</td>";
 
   retval += "</tbody></table>";
   return retval;
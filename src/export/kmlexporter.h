@@ -42,6 +42,9 @@ class KmlExporter :
 
 public:
   KmlExporter(QWidget *parent, Controller *controller);
+
+  /* Exporter without widgets. Only exportAllTo() can be used. */
+  explicit KmlExporter(ExportSource *source);
   virtual ~KmlExporter();
 
   /* Export all rows.
@@ -58,13 +61,30 @@ public:
    */
   virtual int exportSelected(bool open);
 
+  /* Export all rows to the given file without dialogs. Entries without
+   * airport coordinates are skipped.
+   *
+   * @return number of rows exported or -1 if the file could not be written.
+   */
+  virtual int exportAllTo(const QString& filename) override;
+
+  /* Number of entries skipped by the last exportAllTo() call */
+  int getNumSkipped() const
+  {
+    return numSkipped;
+  }
+
 private:
   atools::sql::SqlQuery *airportDetailQuery = nullptr;
+  int numSkipped = 0;
 
   QString lineColor, startIcon, destIcon;
   double startScale, destScale;
   int lineWidth, startXHotspot, startYHotspot, destXHotspot, destYHotspot;
 
+  /* Read line and icon styles from the settings */
+  void readSettings();
+
   /* Show save file dialog */
   QString saveKmlFileDialog();
 
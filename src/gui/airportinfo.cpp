@@ -17,6 +17,7 @@
 
 #include "gui/airportinfo.h"
 
+#include "diag/querystats.h"
 #include "sql/sqlquery.h"
 #include "sql/sqlutil.h"
 
@@ -37,12 +38,13 @@ AirportInfo::~AirportInfo()
 
 QString AirportInfo::createAirportHtml(const QString& icao) const
 {
+  QueryTimer timer(QueryStats::TOOLTIP);
   SqlQuery query(db);
   query.prepare(SqlUtil(db).buildSelectStatement("airport") + " where icao = :icao");
   query.bindValue(":icao", icao);
   query.exec();
 
-  if(query.next())
+  if(timer.next(query))
   {
     QLocale l;
     // Use plain text to build the HTML code. No need for XML stream classes
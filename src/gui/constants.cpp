@@ -22,6 +22,7 @@ namespace constants {
 
 const char *SETTINGS_FIRST_START = "MainWindow/FirstStart";
 const char *SETTINGS_TABLE = "MainWindow/TableView";
+const char *SETTINGS_TABLE_COLUMNS = "MainWindow/TableViewColumns";
 const char *SETTINGS_LOGBOOK_FILE_DIALOG = "MainWindow/Logbook";
 const char *SETTINGS_LANGUAGE = "MainWindow/Language";
 const char *SETTINGS_TABLE_VIEW_ZOOM = "MainWindow/TableViewZoom";
@@ -38,6 +39,11 @@ const char *SETTINGS_MAINWINDOW_SIZE = "MainWindow/Size";
 const char *SETTINGS_MAINWINDOW_STATE = "MainWindow/Properties";
 const char *SETTINGS_SHOW_STATUSBAR = "MainWindow/StatusBar";
 const char *SETTINGS_SHOW_SEARCHOOL = "MainWindow/SearchTool";
+const char *SETTINGS_DATABASE_IN_MEMORY = "Database/InMemory";
+const char *SETTINGS_MODEL_CACHE_LIMIT_MB = "Database/ModelCacheLimitMb";
+const char *SETTINGS_FILTER_CACHE_MB = "Database/FilterCacheMb";
+const char *SETTINGS_TRACE_FILE = "Diagnostics/TraceFile";
+const char *SETTINGS_SLOW_QUERY_MS = "Diagnostics/SlowQueryMs";
 
 const char *SETTINGS_FILTER_ENTRIES = "Filter/FilterEntries";
 const char *SETTINGS_FILTER_INVALID_DATE = "Filter/InvalidDate";
@@ -48,6 +54,10 @@ const char *SETTINGS_FILTER_MIN_FLIGH_TIME = "Filter/MinFlightTime";
 
 const char *SETTINGS_EXPORT_OPEN = "File/OpenAfterExport";
 const char *SETTINGS_EXPORT_FILE_DIALOG = "MainWindow/Export";
+const char *SETTINGS_PIVOT_ROWS = "Pivot/Rows";
+const char *SETTINGS_PIVOT_COLUMNS = "Pivot/Columns";
+const char *SETTINGS_PIVOT_MEASURE = "Pivot/Measure";
+const char *SETTINGS_PIVOT_DIALOG_SIZE = "Pivot/DialogSize";
 
 const char *EXPORT_HTML_CSS_FILE = ":/littlelogbook/resources/css/export.css";
 const char *EXPORT_HTML_CODEC = "UTF-8";
@@ -24,6 +24,7 @@ namespace constants {
 /* Settings keys */
 extern const char *SETTINGS_FIRST_START;
 extern const char *SETTINGS_TABLE;
+extern const char *SETTINGS_TABLE_COLUMNS;
 extern const char *SETTINGS_LOGBOOK_FILE_DIALOG;
 extern const char *SETTINGS_LANGUAGE;
 extern const char *SETTINGS_TABLE_VIEW_ZOOM;
@@ -40,9 +41,18 @@ extern const char *SETTINGS_MAINWINDOW_SIZE;
 extern const char *SETTINGS_MAINWINDOW_STATE;
 extern const char *SETTINGS_SHOW_STATUSBAR;
 extern const char *SETTINGS_SHOW_SEARCHOOL;
+extern const char *SETTINGS_DATABASE_IN_MEMORY;
+extern const char *SETTINGS_MODEL_CACHE_LIMIT_MB;
+extern const char *SETTINGS_FILTER_CACHE_MB;
+extern const char *SETTINGS_TRACE_FILE;
+extern const char *SETTINGS_SLOW_QUERY_MS;
 extern const char *SETTINGS_EXPORT_OPEN;
 extern const char *SETTINGS_EXPORT_HTML_PAGE_SIZE;
 extern const char *SETTINGS_EXPORT_FILE_DIALOG;
+extern const char *SETTINGS_PIVOT_ROWS;
+extern const char *SETTINGS_PIVOT_COLUMNS;
+extern const char *SETTINGS_PIVOT_MEASURE;
+extern const char *SETTINGS_PIVOT_DIALOG_SIZE;
 
 extern const char *SETTINGS_FILTER_ENTRIES;
 extern const char *SETTINGS_FILTER_INVALID_DATE;
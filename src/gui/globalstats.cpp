@@ -17,6 +17,9 @@
 
 #include "gui/globalstats.h"
 
+#include "db/connectionpool.h"
+#include "diag/querystats.h"
+#include "diag/tracer.h"
 #include "table/formatter.h"
 #include "sql/sqlquery.h"
 
@@ -24,8 +27,8 @@
 
 using atools::sql::SqlQuery;
 
-GlobalStats::GlobalStats(QWidget *parent, atools::sql::SqlDatabase *sqlDb)
-  : QObject(parent), db(sqlDb)
+GlobalStats::GlobalStats(QWidget *parent, ConnectionPool *connectionPool)
+  : QObject(parent), pool(connectionPool)
 {
   // Create darker colors dynamically from default palette
   color = QApplication::palette().color(QPalette::Active, QPalette::Base).
@@ -51,6 +54,7 @@ QString GlobalStats::createGlobalStatsReport(atools::fs::SimulatorType type,
                                              bool hasLogbook,
                                              bool hasAirports)
 {
+  TraceSpan span("createGlobalStatsReport", "stats");
   QLocale l;
   QString html(
     "<!DOCTYPE HTML PUBLIC \"-//W3C//DTD HTML 4.0//EN\" \"http://www.w3.org/TR/REC-html40/strict.dtd\">"
@@ -66,8 +70,12 @@ QString GlobalStats::createGlobalStatsReport(atools::fs::SimulatorType type,
     if(type != atools::fs::ALL_SIMULATORS)
       queryStr += " where simulator_id = " + QString::number(type);
 
+    atools::sql::SqlDatabase *db = pool->getReadConnection();
+    QueryTimer timer(QueryStats::STATS);
+    timer.setQueryInfo(db, queryStr, "simulator: " + QString::number(type));
     SqlQuery query(db);
     query.exec(queryStr);
+    bool hasResult = timer.next(query);
 
     SqlQuery startDateQuery(db);
 
@@ -79,9 +87,11 @@ QString GlobalStats::createGlobalStatsReport(atools::fs::SimulatorType type,
     if(type != atools::fs::ALL_SIMULATORS)
       countQueryStr += " and simulator_id = " + QString::number(type);
 
+    timer.resume();
     startDateQuery.exec(countQueryStr);
+    bool hasStartDate = timer.next(startDateQuery);
 
-    if(query.next())
+    if(hasResult)
     {
       if(query.value("num_flights").toInt() > 0)
       {
@@ -92,7 +102,7 @@ QString GlobalStats::createGlobalStatsReport(atools::fs::SimulatorType type,
         html += alt(i++, tableRow).arg(bold(tr("Number of flights:"))).
                 arg(l.toString(query.value("num_flights").toInt()));
 
-        if(startDateQuery.next())
+        if(hasStartDate)
         {
           html += alt(i++, tableRow).arg(bold(tr("Earliest flight:"))).
                   arg(formatter::formatDateLong(startDateQuery.value("earliest_flight").toInt()));
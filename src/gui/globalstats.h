@@ -23,15 +23,13 @@
 #include <QObject>
 #include <QWidget>
 
-namespace atools {
-namespace sql {
-class SqlDatabase;
-} // namespace sql
-} // namespace atools
+class ConnectionPool;
 
 /*
  * Runs a query in the logbook table and creates an HTML document with
  * overall logbook statistics.
+ * The report can be created in any thread since it uses the read connection
+ * of the calling thread.
  */
 class GlobalStats :
   public QObject
@@ -39,7 +37,7 @@ class GlobalStats :
   Q_OBJECT
 
 public:
-  GlobalStats(QWidget *parent, atools::sql::SqlDatabase *sqlDb);
+  GlobalStats(QWidget *parent, ConnectionPool *connectionPool);
   virtual ~GlobalStats();
 
   /*
@@ -54,7 +52,7 @@ public:
   QString createGlobalStatsReport(atools::fs::SimulatorType type, bool hasLogbook, bool hasAirports);
 
 private:
-  atools::sql::SqlDatabase *db;
+  ConnectionPool *pool;
 
   QString color, colorAlt, tableRowHeader;
   QStringList tableRow, tableRowAlignRight;
@@ -17,12 +17,20 @@
 
 #include "mainwindow.h"
 #include "pathdialog.h"
+#include "pivotdialog.h"
 
 #include "table/colum.h"
 #include "table/controller.h"
 #include "fs/ap/airportloader.h"
 #include "fs/lb/logbookloader.h"
-#include "fs/lb/logbookentryfilter.h"
+#include "db/connectionpool.h"
+#include "db/databasesnapshot.h"
+#include "diag/diagnosticswidget.h"
+#include "diag/memorystats.h"
+#include "diag/querystats.h"
+#include "diag/tracer.h"
+#include "import/airportimporter.h"
+#include "import/logbookimporter.h"
 #include "fs/lb/types.h"
 #include "fs/fspaths.h"
 #include "globalstats.h"
@@ -35,24 +43,24 @@
 #include "logging/logginghandler.h"
 #include "settings/settings.h"
 #include "table/sqlmodel.h"
+#include "sql/sqlquery.h"
 #include "sql/sqlutil.h"
 #include "ui_mainwindow.h"
 #include "constants.h"
 #include "logging/loggingdefs.h"
 
 #include <QClipboard>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QCloseEvent>
 #include <QDir>
+#include <QDockWidget>
 #include <QFile>
 #include <QFileInfo>
 #include <QSettings>
 #include <QStandardPaths>
 
-const int SECTION_TO_FONT_SIZE = 2;
-const int MIN_TABLE_VIEW_FONT_POINT_SIZE = 7;
-const int MAX_TABLE_VIEW_FONT_POINT_SIZE = 16;
-
 using atools::sql::SqlDatabase;
+using atools::sql::SqlQuery;
 using atools::settings::Settings;
 using atools::gui::ErrorHandler;
 using atools::gui::Dialog;
@@ -77,7 +85,17 @@ MainWindow::MainWindow() :
   readSettings();
   pathSettings.readSettings();
 
-  controller = new Controller(this, &db, ui->tableView);
+  if(reloadAllFiles)
+  {
+    // Tables were recreated or snapshot is missing - force reload of all files
+    pathSettings.invalidateAllLogbookFiles();
+    pathSettings.invalidateAllRunwayFiles();
+  }
+
+  connectionPool = new ConnectionPool(inMemoryDatabase ? DatabaseSnapshot::memoryDatabaseName() : databaseFile,
+                                      inMemoryDatabase);
+  controller = new Controller(this, &db, connectionPool, ui->tableView);
+  controller->setGroupTreeView(ui->groupTreeView);
 
   csvExporter = new CsvExporter(this, controller);
   kmlExporter = new KmlExporter(this, controller);
@@ -85,7 +103,7 @@ MainWindow::MainWindow() :
     ll::constants::SETTINGS_EXPORT_HTML_PAGE_SIZE, 500).toInt();
   htmlExporter = new HtmlExporter(this, controller, pageSize);
 
-  globalStats = new GlobalStats(this, &db);
+  globalStats = new GlobalStats(this, connectionPool);
   helpHandler = new HelpHandler(this);
 
   updateDatabaseStatus();
@@ -108,6 +126,14 @@ MainWindow::~MainWindow()
 {
   qDebug() << "MainWindow destructor";
 
+  // Import and statistics may still be running in the background
+  importWatcher.waitForFinished();
+  statsWatcher.waitForFinished();
+
+  // Leave query times in the log file for problem reports
+  QueryStats::instance().log();
+  MemoryStats::instance().log();
+
   delete globalStats;
   delete csvExporter;
   delete htmlExporter;
@@ -117,6 +143,9 @@ MainWindow::~MainWindow()
   delete dialog;
   delete errorHandler;
 
+  // Close read connections before the main connection
+  delete connectionPool;
+
   Settings::shutdown();
   atools::gui::Translator::unload();
 
@@ -142,9 +171,14 @@ void MainWindow::setupUi()
   ui->mainToolBar->insertWidget(ui->actionShowSearch, simulatorComboBox);
   ui->mainToolBar->insertSeparator(ui->actionShowSearch);
 
+  // Default custom date range is the last 30 days
+  ui->fromDateEdit->setDate(QDate::currentDate().addDays(-30));
+  ui->toDateEdit->setDate(QDate::currentDate());
+
   // Can not be set in Qt Designer
   ui->tableView->horizontalHeader()->setSectionsMovable(true);
   ui->tableView->addAction(ui->actionTableCopy);
+  ui->groupTreeView->addAction(ui->actionTableCopy);
 
   // Create label for the statusbar
   selectionLabelText = tr("%1 of %2 entries selected, %3 visible.");
@@ -153,6 +187,20 @@ void MainWindow::setupUi()
 
   // Avoid stealing of Ctrl-C from other default menus
   ui->actionTableCopy->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+
+  // Diagnostics dock is hidden by default and tabbed with the statistics dock
+  diagnosticsDockWidget = new QDockWidget(tr("Diagnostics"), this);
+  diagnosticsDockWidget->setObjectName("diagnosticsDockWidget");
+  diagnosticsDockWidget->setWidget(new DiagnosticsWidget(diagnosticsDockWidget));
+  addDockWidget(dockWidgetArea(ui->dockWidget), diagnosticsDockWidget);
+  tabifyDockWidget(ui->dockWidget, diagnosticsDockWidget);
+  diagnosticsDockWidget->hide();
+  ui->dockWidget->raise();
+
+  QAction *diagnosticsAction = diagnosticsDockWidget->toggleViewAction();
+  diagnosticsAction->setText(tr("Show &Diagnostics"));
+  diagnosticsAction->setStatusTip(tr("Show or hide query times and other diagnostic information"));
+  ui->menuView->insertAction(ui->actionShowSearch, diagnosticsAction);
 }
 
 void MainWindow::initTableViewZoom()
@@ -162,7 +210,7 @@ void MainWindow::initTableViewZoom()
 
   int newPointSize = Settings::instance()->value(ll::constants::SETTINGS_TABLE_VIEW_ZOOM,
                                                  defaultTableViewFontPointSize).toInt();
-  setTableViewFontSize(newPointSize);
+  Controller::setTableViewFontSize(ui->tableView, newPointSize);
 }
 
 void MainWindow::zoomTableView(int value)
@@ -172,33 +220,18 @@ void MainWindow::zoomTableView(int value)
   if(value != 0)
     newPointSize = ui->tableView->font().pointSize() + value;
 
-  setTableViewFontSize(newPointSize);
+  Controller::setTableViewFontSize(ui->tableView, newPointSize);
+  ui->groupTreeView->setFont(ui->tableView->font());
 
   Settings::instance()->setValue(ll::constants::SETTINGS_TABLE_VIEW_ZOOM, ui->tableView->font().pointSize());
   enableDisableZoomActions();
 }
 
-void MainWindow::setTableViewFontSize(int pointSize)
-{
-  QFont newFont(ui->tableView->font());
-  newFont.setPointSize(pointSize);
-
-  int newFontHeight = QFontMetrics(newFont).height();
-
-  qDebug() << "new font height" << newFontHeight << "point size" << newFont.pointSize();
-
-  ui->tableView->setFont(newFont);
-
-  // Adjust the cell height - default is too big
-  ui->tableView->verticalHeader()->setDefaultSectionSize(newFontHeight + SECTION_TO_FONT_SIZE);
-  ui->tableView->verticalHeader()->setMinimumSectionSize(newFontHeight + SECTION_TO_FONT_SIZE);
-}
-
 void MainWindow::enableDisableZoomActions()
 {
   ui->actionZoomDefault->setEnabled(ui->tableView->font().pointSize() != defaultTableViewFontPointSize);
-  ui->actionZoomIn->setEnabled(ui->tableView->font().pointSize() < MAX_TABLE_VIEW_FONT_POINT_SIZE);
-  ui->actionZoomOut->setEnabled(ui->tableView->font().pointSize() > MIN_TABLE_VIEW_FONT_POINT_SIZE);
+  ui->actionZoomIn->setEnabled(ui->tableView->font().pointSize() < Controller::MAX_FONT_POINT_SIZE);
+  ui->actionZoomOut->setEnabled(ui->tableView->font().pointSize() > Controller::MIN_FONT_POINT_SIZE);
 }
 
 void MainWindow::updateActionStates()
@@ -237,6 +270,8 @@ void MainWindow::connectAllSlots()
 {
   qDebug() << "Connecting slots";
   connect(ui->tableView, &QTableView::customContextMenuRequested, this, &MainWindow::tableContextMenu);
+  connect(ui->groupTreeView, &QTreeView::customContextMenuRequested, this, &MainWindow::tableContextMenu);
+  connect(controller, &Controller::groupTreeSelectionChanged, this, &MainWindow::updateWidgetsOnSelection);
 
   // Use this event to show path dialog after main windows is shown
   connect(this, &MainWindow::windowShown, this, &MainWindow::startupChecks, Qt::QueuedConnection);
@@ -285,10 +320,44 @@ void MainWindow::connectAllSlots()
                                                        index == 0); });
   connect(ui->conditionComboBox, activatedPtr,
           [=](int index) { controller->filterOperator(index == 0); });
+
+  connect(ui->dateRangeComboBox, activatedPtr, [=](int /*index*/) {
+            rangeFilterChanged("startdate");
+            applyRangeFilters();
+          });
+  connect(ui->fromDateEdit, &QDateEdit::dateChanged, [=](const QDate&) { rangeFilterChanged("startdate"); });
+  connect(ui->toDateEdit, &QDateEdit::dateChanged, [=](const QDate&) { rangeFilterChanged("startdate"); });
+
+  void (QSpinBox::* intValueChangedPtr)(int) = &QSpinBox::valueChanged;
+  void (QDoubleSpinBox::* doubleValueChangedPtr)(double) = &QDoubleSpinBox::valueChanged;
+  connect(ui->minDistanceSpinBox, intValueChangedPtr, [=](int) { rangeFilterChanged("distance"); });
+  connect(ui->maxDistanceSpinBox, intValueChangedPtr, [=](int) { rangeFilterChanged("distance"); });
+  connect(ui->minTotalTimeSpinBox, doubleValueChangedPtr, [=](double) { rangeFilterChanged("total_time"); });
+  connect(ui->maxTotalTimeSpinBox, doubleValueChangedPtr, [=](double) { rangeFilterChanged("total_time"); });
+  connect(ui->minNightTimeSpinBox, doubleValueChangedPtr, [=](double) { rangeFilterChanged("night_time"); });
+  connect(ui->maxNightTimeSpinBox, doubleValueChangedPtr, [=](double) { rangeFilterChanged("night_time"); });
+  connect(ui->minInstrumentTimeSpinBox, doubleValueChangedPtr,
+          [=](double) { rangeFilterChanged("instrument_time"); });
+  connect(ui->maxInstrumentTimeSpinBox, doubleValueChangedPtr,
+          [=](double) { rangeFilterChanged("instrument_time"); });
   connect(simulatorComboBox, activatedPtr,
           [=](int /*index*/) { updateGlobalStats(); });
   /* *INDENT-ON* */
 
+  // Search at once when leaving a range widget or pressing return
+  const QList<QAbstractSpinBox *> rangeWidgets =
+  {
+    ui->fromDateEdit, ui->toDateEdit, ui->minDistanceSpinBox, ui->maxDistanceSpinBox,
+    ui->minTotalTimeSpinBox, ui->maxTotalTimeSpinBox, ui->minNightTimeSpinBox, ui->maxNightTimeSpinBox,
+    ui->minInstrumentTimeSpinBox, ui->maxInstrumentTimeSpinBox
+  };
+  for(QAbstractSpinBox *spinBox : rangeWidgets)
+    connect(spinBox, &QAbstractSpinBox::editingFinished, this, &MainWindow::applyRangeFilters);
+
+  rangeFilterTimer.setSingleShot(true);
+  rangeFilterTimer.setInterval(RANGE_FILTER_DELAY_MS);
+  connect(&rangeFilterTimer, &QTimer::timeout, this, &MainWindow::applyRangeFilters);
+
   assignSearchFieldsToController();
 
   // Need extra action connected to catch the default Ctrl-C in the table view
@@ -312,6 +381,7 @@ void MainWindow::connectAllSlots()
   connect(ui->actionResetSearch, &QAction::triggered, this, &MainWindow::resetSearch);
   connect(ui->actionResetView, &QAction::triggered, this, &MainWindow::resetView);
   connect(ui->actionUngroup, &QAction::triggered, this, &MainWindow::ungroup);
+  connect(ui->actionPivotTable, &QAction::triggered, this, &MainWindow::showPivotTable);
   connect(ui->actionShowToolbar, &QAction::toggled, ui->mainToolBar, &QToolBar::setVisible);
   connect(ui->actionShowStatusbar, &QAction::toggled, ui->statusBar, &QStatusBar::setVisible);
   connect(ui->actionShowStatistics, &QAction::toggled, ui->dockWidget, &QDockWidget::setVisible);
@@ -333,6 +403,10 @@ void MainWindow::connectAllSlots()
   connect(ui->actionAboutQt, &QAction::triggered, helpHandler, &HelpHandler::aboutQt);
   connect(ui->actionHelp, &QAction::triggered, helpHandler, &HelpHandler::help);
 
+  connect(&statsWatcher, &QFutureWatcher<QString>::finished, this, &MainWindow::globalStatsFinished);
+  connect(&importWatcher, &QFutureWatcher<BackgroundImport::Result>::finished,
+          this, &MainWindow::backgroundImportFinished);
+
   // Connect widget status to actions
   connect(ui->mainToolBar, &QToolBar::visibilityChanged, ui->actionShowToolbar, &QAction::setChecked);
   connect(ui->dockWidget, &QDockWidget::visibilityChanged, ui->actionShowStatistics, &QAction::setChecked);
@@ -340,6 +414,11 @@ void MainWindow::connectAllSlots()
 
 void MainWindow::checkAllFiles(bool notifyReload)
 {
+  if(isBackgroundImportRunning())
+    return;
+
+  TraceSpan span("checkAllFiles");
+
   if(pathSettings.hasAnyLogbookFileChanged() || pathSettings.hasAnyRunwaysFileChanged())
   {
     preDatabaseLoad();
@@ -354,6 +433,9 @@ void MainWindow::checkAllFiles(bool notifyReload)
         checkLogbookFile(type, notifyReload);
     updateDatabaseStatus();
     postDatabaseLoad();
+
+    if(databaseChanged)
+      saveDatabaseSnapshot();
   }
   else
     ui->statusBar->showMessage(QString(tr("No changed Logbooks found.")));
@@ -366,6 +448,9 @@ void MainWindow::reloadChanged()
 
 void MainWindow::resetDatabase()
 {
+  if(isBackgroundImportRunning())
+    return;
+
   int result = dialog->showQuestionMsgBox(ll::constants::SETTINGS_SHOW_RESET_DATABASE,
                                           tr("Delete all Logbooks and Airports from internal Database "
                                              "and reload all available files?"),
@@ -379,8 +464,12 @@ void MainWindow::resetDatabase()
     QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
 
     preDatabaseLoad();
+    // Tables are dropped - nothing to keep from the current model
+    controller->resetSearch();
+    controller->clearModel();
     atools::fs::ap::AirportLoader(&db).dropDatabase();
     atools::fs::lb::LogbookLoader(&db).dropDatabase();
+    databaseChanged = true;
     updateDatabaseStatus();
     // postDatabaseLoad();
 
@@ -392,6 +481,9 @@ void MainWindow::resetDatabase()
 
 void MainWindow::pathDialog()
 {
+  if(isBackgroundImportRunning())
+    return;
+
   PathDialog d(this, &pathSettings);
   int retval = d.exec();
 
@@ -428,7 +520,145 @@ void MainWindow::startupChecks()
   QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
 
   // Check for change files - even if dialog was cancelled
-  checkAllFiles(notifyReload);
+  if(inMemoryDatabase)
+    // Writing locks the tables of the shared in-memory database for the main connection
+    checkAllFiles(notifyReload);
+  else
+    // The table is usable at once and gets the changes when the import is done
+    startBackgroundImport(notifyReload);
+}
+
+void MainWindow::startBackgroundImport(bool notifyReload)
+{
+  importNotifyReload = notifyReload;
+
+  /* All entries pass default filter */
+  atools::fs::lb::LogbookEntryFilter filter;
+  if(ui->actionFilterLogbookEntries->isChecked())
+    filter = LogbookImporter::filterFromSettings();
+
+  ui->statusBar->showMessage(tr("Checking for changed files."));
+
+  // Settings cannot be read in the worker thread
+  PathSettings paths = pathSettings;
+  QString file = databaseFile;
+  importWatcher.setFuture(QtConcurrent::run([ = ]() -> BackgroundImport::Result
+                                            {
+                                              return BackgroundImport::run(paths, filter, file);
+                                            }));
+}
+
+void MainWindow::backgroundImportFinished()
+{
+  BackgroundImport::Result result = importWatcher.result();
+
+  bool anyRunwaysLoaded = false;
+  for(SimulatorType type : atools::fs::ALL_SIMULATOR_TYPES)
+  {
+    if(result.runwaysLoaded[type])
+    {
+      pathSettings.setRunwaysFileLoaded(type);
+      anyRunwaysLoaded = true;
+    }
+  }
+
+  // Runways loading invalidates all logbooks
+  if(anyRunwaysLoaded)
+    pathSettings.invalidateAllLogbookFiles();
+
+  for(SimulatorType type : atools::fs::ALL_SIMULATOR_TYPES)
+    if(result.logbookLoaded[type])
+      pathSettings.setLogbookFileLoaded(type);
+
+  if(result.hasChanges())
+  {
+    // Tables were changed by the import connection - update the model like after a reload
+    databaseChanged = true;
+    preDatabaseLoad();
+    postDatabaseLoad();
+
+    // Opening the database failed before any file was imported
+    if(result.error != nullptr && (result.files.isEmpty() || !result.files.last().failed))
+      handleBackgroundImportError(result);
+
+    // Report files in import order like the synchronous check does
+    for(const BackgroundImport::FileResult& file : result.files)
+      reportBackgroundImport(file, result);
+  }
+  else
+    ui->statusBar->showMessage(QString(tr("No changed Logbooks found.")));
+}
+
+void MainWindow::handleBackgroundImportError(const BackgroundImport::Result& result)
+{
+  try
+  {
+    std::rethrow_exception(result.error);
+  }
+  catch(std::exception& e)
+  {
+    errorHandler->handleException(e, result.errorContext);
+  }
+  catch(...)
+  {
+    errorHandler->handleUnknownException(result.errorContext);
+  }
+}
+
+void MainWindow::reportBackgroundImport(const BackgroundImport::FileResult& file,
+                                        const BackgroundImport::Result& result)
+{
+  if(importNotifyReload)
+  {
+    if(file.runways)
+      dialog->showInfoMsgBox(ll::constants::SETTINGS_SHOW_RELOAD_RUNWAYS,
+                             QString(tr("<p>Runways file</p><p><i>%1</i></p><p>is new or has changed.</p>"
+                                          "<p>Was reloaded.</p>")).
+                             arg(QDir::toNativeSeparators(file.file)),
+                             tr("Do not &show this dialog again."));
+    else
+      dialog->showInfoMsgBox(ll::constants::SETTINGS_SHOW_RELOAD,
+                             QString(tr("<p>Logbook file</p><p><i>%1</i></p><p>is new or has changed.</p>"
+                                          "<p>Was reloaded.</p>")).
+                             arg(QDir::toNativeSeparators(file.file)),
+                             tr("Do not &show this dialog again."));
+  }
+
+  if(file.failed)
+  {
+    handleBackgroundImportError(result);
+
+    if(file.runways)
+    {
+      qDebug() << "Airport import failed" << file.file << PathSettings::getSimulatorName(file.type);
+      ui->statusBar->showMessage(QString(tr("Airport import failed.")));
+    }
+    else
+    {
+      qDebug() << "Logbook import failed" << file.file << PathSettings::getSimulatorName(file.type);
+      ui->statusBar->showMessage(QString(tr("Logbook import failed.")));
+    }
+  }
+  else if(file.runways)
+  {
+    qDebug() << "Airport import done" << file.file << PathSettings::getSimulatorName(file.type);
+    ui->statusBar->showMessage(QString(tr("Loaded %1 airports.")).arg(file.numLoaded));
+  }
+  else
+  {
+    qDebug() << "logbook import done" << file.file << PathSettings::getSimulatorName(file.type);
+    ui->statusBar->showMessage(QString(tr("Loaded %1 logbook entries.")).arg(file.numLoaded));
+  }
+}
+
+bool MainWindow::isBackgroundImportRunning()
+{
+  if(importWatcher.isRunning())
+  {
+    ui->statusBar->showMessage(tr("Files are being loaded. Try again when done."));
+    return true;
+  }
+  return false;
 }
 
 void MainWindow::checkRunwaysFile()
@@ -488,7 +718,33 @@ void MainWindow::updateGlobalStats()
     type = atools::fs::ALL_SIMULATORS;
   else
     type = static_cast<SimulatorType>(idx - 1);
-  ui->globalStatsTextEdit->setHtml(globalStats->createGlobalStatsReport(type, hasLogbook, hasAirports));
+
+  if(statsWatcher.isRunning())
+  {
+    // Run again with current parameters when finished
+    statsUpdatePending = true;
+    return;
+  }
+
+  // Create report in background using an own read connection
+  bool logbook = hasLogbook, airports = hasAirports;
+  GlobalStats *stats = globalStats;
+  statsWatcher.setFuture(QtConcurrent::run([ = ]() -> QString
+                                           {
+                                             return stats->createGlobalStatsReport(type, logbook, airports);
+                                           }));
+}
+
+void MainWindow::globalStatsFinished()
+{
+  if(statsUpdatePending)
+  {
+    // Parameters changed while running - discard result
+    statsUpdatePending = false;
+    updateGlobalStats();
+  }
+  else
+    ui->globalStatsTextEdit->setHtml(statsWatcher.result());
 }
 
 void MainWindow::resetView()
@@ -503,6 +759,7 @@ void MainWindow::resetView()
   {
     qDebug() << "resetView";
 
+    clearRangeWidgets();
     controller->resetView();
     ui->statusBar->showMessage(tr("View reset to default."));
     ui->actionUngroup->setEnabled(false);
@@ -511,9 +768,102 @@ void MainWindow::resetView()
   }
 }
 
+void MainWindow::filterByDateRange()
+{
+  QDate today = QDate::currentDate();
+  bool customRange = ui->dateRangeComboBox->currentIndex() == 4;
+  ui->fromDateEdit->setEnabled(hasLogbook && customRange);
+  ui->toDateEdit->setEnabled(hasLogbook && customRange);
+
+  QVariant minValue, maxValue;
+  switch(ui->dateRangeComboBox->currentIndex())
+  {
+    case 1:
+      minValue = QueryBuilder::dateToTimeT(today.addDays(-7));
+      break;
+    case 2:
+      minValue = QueryBuilder::dateToTimeT(today.addDays(-30));
+      break;
+    case 3:
+      minValue = QueryBuilder::dateToTimeT(today.addDays(-365));
+      break;
+    case 4:
+      minValue = QueryBuilder::dateToTimeT(ui->fromDateEdit->date());
+      maxValue = QueryBuilder::dateToTimeT(ui->toDateEdit->date(), true);
+      break;
+  }
+  controller->filterByRange("startdate", minValue, maxValue);
+}
+
+void MainWindow::filterByValueRange(const QString& colName, double minValue, double maxValue)
+{
+  controller->filterByRange(colName,
+                            minValue > 0. ? QVariant(minValue) : QVariant(),
+                            maxValue > 0. ? QVariant(maxValue) : QVariant());
+}
+
+void MainWindow::rangeFilterChanged(const QString& colName)
+{
+  changedRangeFilters.insert(colName);
+  rangeFilterTimer.start();
+}
+
+void MainWindow::applyRangeFilters()
+{
+  rangeFilterTimer.stop();
+
+  QSet<QString> changed;
+  changed.swap(changedRangeFilters);
+
+  if(changed.contains("startdate"))
+    filterByDateRange();
+  if(changed.contains("distance"))
+    filterByValueRange("distance", ui->minDistanceSpinBox->value(), ui->maxDistanceSpinBox->value());
+  if(changed.contains("total_time"))
+    filterByValueRange("total_time", ui->minTotalTimeSpinBox->value(), ui->maxTotalTimeSpinBox->value());
+  if(changed.contains("night_time"))
+    filterByValueRange("night_time", ui->minNightTimeSpinBox->value(), ui->maxNightTimeSpinBox->value());
+  if(changed.contains("instrument_time"))
+    filterByValueRange("instrument_time", ui->minInstrumentTimeSpinBox->value(),
+                       ui->maxInstrumentTimeSpinBox->value());
+}
+
+void MainWindow::clearRangeWidgets()
+{
+  rangeFilterTimer.stop();
+  changedRangeFilters.clear();
+
+  for(int i = 0; i < ui->gridLayoutSearch3->count(); ++i)
+  {
+    QWidget *w = ui->gridLayoutSearch3->itemAt(i)->widget();
+    if(w != nullptr)
+      w->blockSignals(true);
+  }
+
+  ui->dateRangeComboBox->setCurrentIndex(0);
+  ui->fromDateEdit->setEnabled(false);
+  ui->toDateEdit->setEnabled(false);
+  ui->minDistanceSpinBox->setValue(0);
+  ui->maxDistanceSpinBox->setValue(0);
+  ui->minTotalTimeSpinBox->setValue(0.);
+  ui->maxTotalTimeSpinBox->setValue(0.);
+  ui->minNightTimeSpinBox->setValue(0.);
+  ui->maxNightTimeSpinBox->setValue(0.);
+  ui->minInstrumentTimeSpinBox->setValue(0.);
+  ui->maxInstrumentTimeSpinBox->setValue(0.);
+
+  for(int i = 0; i < ui->gridLayoutSearch3->count(); ++i)
+  {
+    QWidget *w = ui->gridLayoutSearch3->itemAt(i)->widget();
+    if(w != nullptr)
+      w->blockSignals(false);
+  }
+}
+
 void MainWindow::resetSearch()
 {
   qDebug() << "resetSearch";
+  clearRangeWidgets();
   controller->resetSearch();
   ui->statusBar->showMessage(tr("Search filters cleared."));
 }
@@ -602,18 +952,57 @@ void MainWindow::openDatabase()
     // specific name (i.e. Linux: ~/.config/ABarthel/little_logbook.sqlite)
     databaseFile = atools::settings::Settings::getConfigFilename(".sqlite");
 
-    qDebug() << "Opening database" << databaseFile;
+    atools::settings::Settings& s = Settings::instance();
+    inMemoryDatabase = s.getAndStoreValue(ll::constants::SETTINGS_DATABASE_IN_MEMORY, false).toBool();
+    if(inMemoryDatabase && !DatabaseSnapshot::isAvailable())
+    {
+      // Snapshots need the SQLite backup API - fall back to the database file
+      qWarning() << "In-memory database is not available in this build. Using database file.";
+      inMemoryDatabase = false;
+    }
+
     db = SqlDatabase::addDatabase(ll::constants::DATABASE_TYPE);
-    db.setDatabaseName(databaseFile);
-    db.open();
+    if(inMemoryDatabase)
+    {
+      // Keep the database in memory and use the file only as snapshot
+      qDebug() << "Opening in-memory database with snapshot" << databaseFile;
+      db.getQSqlDatabase().setConnectOptions("QSQLITE_OPEN_URI");
+      db.setDatabaseName(DatabaseSnapshot::memoryDatabaseName());
+      db.open();
+
+      try
+      {
+        if(QFile::exists(databaseFile))
+          DatabaseSnapshot::restore(&db, databaseFile);
+        else
+          reloadAllFiles = true;
+      }
+      catch(std::exception& e)
+      {
+        // Start with an empty database and load all files again
+        qWarning() << "Restoring database snapshot failed" << e.what();
+        reloadAllFiles = true;
+      }
+    }
+    else
+    {
+      qDebug() << "Opening database" << databaseFile;
+      db.setDatabaseName(databaseFile);
+      db.open();
+
+      // Allow read connections to query while the database is changed
+      SqlQuery(&db).exec("pragma journal_mode = wal");
+    }
 
     // On first startup of this version clean the database from the old schema
-    atools::settings::Settings& s = Settings::instance();
     if(s->value(ll::constants::SETTINGS_FIRST_START, true).toBool())
     {
       atools::fs::ap::AirportLoader(&db).dropDatabase();
       atools::fs::lb::LogbookLoader(&db).dropDatabase();
     }
+
+    // Add calendar columns and keys to logbooks loaded by older versions
+    LogbookImporter::updateSchema(&db);
   }
   catch(std::exception& e)
   {
@@ -644,6 +1033,28 @@ void MainWindow::closeDatabase()
   }
 }
 
+void MainWindow::saveDatabaseSnapshot()
+{
+  databaseChanged = false;
+  if(!inMemoryDatabase)
+    return;
+
+  QGuiApplication::setOverrideCursor(Qt::WaitCursor);
+  try
+  {
+    DatabaseSnapshot::save(&db, databaseFile);
+  }
+  catch(std::exception& e)
+  {
+    errorHandler->handleException(e, "While saving database");
+  }
+  catch(...)
+  {
+    errorHandler->handleUnknownException("While saving database");
+  }
+  QGuiApplication::restoreOverrideCursor();
+}
+
 void MainWindow::checkRunwaysFile(SimulatorType type, bool notifyChange)
 {
   if(!pathSettings.isRunwaysFileValid(type))
@@ -735,6 +1146,16 @@ void MainWindow::updateWidgetStatus()
       w->setEnabled(hasLogbook);
   }
 
+  // Date edits are enabled only for a custom date range
+  for(int i = 0; i < ui->gridLayoutSearch3->count(); ++i)
+  {
+    QWidget *w = ui->gridLayoutSearch3->itemAt(i)->widget();
+    if(w != nullptr)
+      w->setEnabled(hasLogbook);
+  }
+  ui->fromDateEdit->setEnabled(hasLogbook && ui->dateRangeComboBox->currentIndex() == 4);
+  ui->toDateEdit->setEnabled(hasLogbook && ui->dateRangeComboBox->currentIndex() == 4);
+
   // Only enable these if there are logbook entries
   ui->actionShowAll->setEnabled(hasLogbook);
   ui->actionResetSearch->setEnabled(hasLogbook);
@@ -747,6 +1168,7 @@ void MainWindow::updateWidgetStatus()
   simulatorComboBox->setEnabled(hasLogbook);
 
   ui->actionUngroup->setEnabled(hasLogbook && controller->isGrouped());
+  ui->actionPivotTable->setEnabled(hasLogbook);
 
   updateWidgetsOnSelection();
 }
@@ -761,7 +1183,7 @@ void MainWindow::tableSelectionChanged(const QItemSelection& selected, const QIt
 void MainWindow::updateWidgetsOnSelection()
 {
   // Update export menu if there is a selection in the table view
-  QItemSelectionModel *sm = ui->tableView->selectionModel();
+  QItemSelectionModel *sm = controller->getSelectionModel();
   ui->actionExportSelectedCsv->setEnabled(hasLogbook && sm != nullptr && sm->hasSelection());
   ui->actionExportSelectedHtml->setEnabled(hasLogbook && sm != nullptr && sm->hasSelection());
   ui->actionExportSelectedKml->setEnabled(hasLogbook && hasAirports && sm != nullptr &&
@@ -799,6 +1221,14 @@ void MainWindow::showSearchBar(bool visible)
       w->setVisible(visible);
   }
 
+  // Show or hide date and value ranges
+  for(int i = 0; i < ui->gridLayoutSearch3->count(); ++i)
+  {
+    QWidget *w = ui->gridLayoutSearch3->itemAt(i)->widget();
+    if(w != nullptr)
+      w->setVisible(visible);
+  }
+
   // Hide additional edits if runways.xml is not available
   showHideAirportLineEdits(visible);
 }
@@ -814,11 +1244,15 @@ void MainWindow::showHideAirportLineEdits(bool visible)
   ui->toCityLineEdit->setVisible(show);
   ui->toStateLineEdit->setVisible(show);
   ui->toCountryLineEdit->setVisible(show);
+
+  // Distance is calculated from airport coordinates
+  ui->minDistanceSpinBox->setVisible(show);
+  ui->maxDistanceSpinBox->setVisible(show);
 }
 
 void MainWindow::filterLogbookEntries()
 {
-  if(hasLogbook)
+  if(hasLogbook && !isBackgroundImportRunning())
   {
     dialog->showInfoMsgBox(ll::constants::SETTINGS_SHOW_FILTER_RELOAD,
                            tr("Logbooks will be reloaded."),
@@ -848,8 +1282,11 @@ void MainWindow::preDatabaseLoad()
   if(!hasDatabaseLoadStatus)
   {
     hasDatabaseLoadStatus = true;
-    controller->resetSearch();
-    controller->clearModel();
+    // Keep model and view but release all queries to avoid locks
+    controller->detachModel();
+
+    // Do not change tables while statistics are read
+    statsWatcher.waitForFinished();
   }
   else
     qDebug() << "Already in database loading status";
@@ -862,12 +1299,22 @@ void MainWindow::postDatabaseLoad(bool force)
     // Check if there are any logbook entries at all to disable most GUI elements
     updateDatabaseStatus();
 
-    controller->setHasLogbook(hasLogbook);
-    controller->setHasAirports(hasAirports);
+    if(!force && controller->canApplyModelDelta(hasLogbook, hasAirports))
+      // Same columns - update only the changed rows and keep search, scroll position and selection
+      controller->applyModelDelta();
+    else
+    {
+      clearRangeWidgets();
+      controller->resetSearch();
+      controller->clearModel();
+
+      controller->setHasLogbook(hasLogbook);
+      controller->setHasAirports(hasAirports);
 
-    controller->prepareModel();
-    connectControllerSlots();
-    assignSearchFieldsToController();
+      controller->prepareModel();
+      connectControllerSlots();
+      assignSearchFieldsToController();
+    }
 
     updateWidgetsOnSelection();
     updateWidgetStatus();
@@ -922,7 +1369,7 @@ bool MainWindow::loadAirports(SimulatorType type)
 
   QGuiApplication::setOverrideCursor(Qt::WaitCursor);
 
-  atools::fs::ap::AirportLoader apLoader(&db);
+  AirportImporter apLoader(&db);
 
   try
   {
@@ -930,7 +1377,9 @@ bool MainWindow::loadAirports(SimulatorType type)
     ui->statusBar->showMessage(QString(tr("Loading airports from \"%1\" (%2).")).
                                arg(QDir::toNativeSeparators(file)).
                                arg(PathSettings::getSimulatorName(type)));
+    TraceSpan span("loadAirports", "import");
     apLoader.loadAirports(file);
+    span.setRows(apLoader.getNumLoaded());
   }
   catch(std::exception& e)
   {
@@ -945,6 +1394,9 @@ bool MainWindow::loadAirports(SimulatorType type)
 
   QGuiApplication::restoreOverrideCursor();
 
+  // Also a failed import leaves changes behind
+  databaseChanged = true;
+
   if(success)
   {
     qDebug() << "Airport import done";
@@ -965,40 +1417,18 @@ bool MainWindow::loadAirports(SimulatorType type)
 
 bool MainWindow::loadLogbookDatabase(SimulatorType type)
 {
-  using namespace atools::fs::lb;
-
   bool success = true;
   qDebug() << "Starting logbook import...";
 
   QGuiApplication::setOverrideCursor(Qt::WaitCursor);
 
   /* All entries pass default filter */
-  LogbookEntryFilter filter;
+  atools::fs::lb::LogbookEntryFilter filter;
 
   if(ui->actionFilterLogbookEntries->isChecked())
-  {
-  Settings& s = Settings::instance();
+    filter = LogbookImporter::filterFromSettings();
 
-  if(s.getAndStoreValue(ll::constants::SETTINGS_FILTER_INVALID_DATE, true).toBool())
-    filter.invalidDate();
-
-  if(s.getAndStoreValue(ll::constants::SETTINGS_FILTER_START_AND_DEST_EMPTY, true).toBool())
-    filter.startAndDestEmpty();
-
-  if(s.getAndStoreValue(ll::constants::SETTINGS_FILTER_START_OR_DEST_EMPTY, false).toBool())
-    filter.startOrDestEmpty();
-
-  if(s.getAndStoreValue(ll::constants::SETTINGS_FILTER_START_DEST_SAME, true).toBool())
-    filter.startAndDestSame();
-
-  int minFlightTimeMins = s.getAndStoreValue(ll::constants::SETTINGS_FILTER_MIN_FLIGH_TIME, 5).toInt();
-  if(minFlightTimeMins)
-    filter.flightTimeLowerThan(minFlightTimeMins);
-
-  s.syncSettings();
-  }
-
-  LogbookLoader importer(&db);
+  LogbookImporter importer(&db);
 
   try
   {
@@ -1007,7 +1437,9 @@ bool MainWindow::loadLogbookDatabase(SimulatorType type)
                                arg(QDir::toNativeSeparators(file)).
                                arg(PathSettings::getSimulatorName(type)));
 
-    importer.loadLogbook(file, type, filter, false /* append */);
+    TraceSpan span("loadLogbookDatabase", "import");
+    importer.loadLogbook(file, type, filter);
+    span.setRows(importer.getNumLoaded());
   }
   catch(std::exception& e)
   {
@@ -1022,6 +1454,8 @@ bool MainWindow::loadLogbookDatabase(SimulatorType type)
 
   QGuiApplication::restoreOverrideCursor();
 
+  databaseChanged = true;
+
   if(success)
   {
     qDebug() << "logbook import done";
@@ -1036,6 +1470,18 @@ bool MainWindow::loadLogbookDatabase(SimulatorType type)
   return success;
 }
 
+void MainWindow::showPivotTable()
+{
+  SqlModel *model = controller->getSqlModel();
+  if(model == nullptr)
+    return;
+
+  // Uses the filter of the table view
+  PivotDialog dialog(this, connectionPool->getReadConnection(), model->getQueryBuilder(),
+                     ui->actionOpenAfterExport->isChecked());
+  dialog.exec();
+}
+
 void MainWindow::tableCopyCipboard()
 {
   qDebug() << "tableCopyCipboard";
@@ -1111,8 +1557,23 @@ void MainWindow::tableContextMenu(const QPoint& pos)
     menu.addAction(ui->actionFilterExcluding);
     menu.addSeparator();
 
+    // Nested group levels can be added for all groupable columns
+    QMenu subgroupMenu(tr("Add &Subgroup"));
+    subgroupMenu.setIcon(ui->actionGroupByCol->icon());
+    QHash<QAction *, QString> subgroupActions;
+
     if(controller->isGrouped())
+    {
+      for(const Column *col : controller->getSubgroupColumns())
+      {
+        QString name = col->getDisplayName();
+        name.replace("-\n", "").replace("\n", " ");
+        subgroupActions.insert(subgroupMenu.addAction(name), col->getColumnName());
+      }
+      subgroupMenu.setEnabled(!subgroupActions.isEmpty());
+      menu.addMenu(&subgroupMenu);
       menu.addAction(ui->actionUngroup);
+    }
     else
       menu.addAction(ui->actionGroupByCol);
 
@@ -1120,7 +1581,9 @@ void MainWindow::tableContextMenu(const QPoint& pos)
     if(a != nullptr)
     {
       // A menu item was selected
-      if(a == ui->actionFilterIncluding)
+      if(subgroupActions.contains(a))
+        controller->addGroupByColumn(subgroupActions.value(a));
+      else if(a == ui->actionFilterIncluding)
         controller->filterIncluding(index);
       else if(a == ui->actionFilterExcluding)
         controller->filterExcluding(index);
@@ -1177,6 +1640,9 @@ void MainWindow::closeEvent(QCloseEvent *event)
                ui->actionShowToolbar, &QAction::setChecked);
     writeSettings();
     pathSettings.writeSettings();
+
+    if(databaseChanged)
+      saveDatabaseSnapshot();
   }
 }
 
@@ -23,9 +23,13 @@
 #include "export/kmlexporter.h"
 #include "export/csvexporter.h"
 #include "gui/pathsettings.h"
+#include "import/backgroundimport.h"
 
 #include <QDateTime>
+#include <QFutureWatcher>
 #include <QMainWindow>
+#include <QSet>
+#include <QTimer>
 
 namespace Ui {
 class MainWindow;
@@ -40,10 +44,12 @@ class ErrorHandler;
 } // namespace atools
 
 class CsvExporter;
+class ConnectionPool;
 class Controller;
 class GlobalStats;
 class HelpHandler;
 
+class QDockWidget;
 class QItemSelection;
 class QLabel;
 class QComboBox;
@@ -78,13 +84,46 @@ private:
   QLabel *selectionLabel = nullptr;
   QComboBox *simulatorComboBox = nullptr;
 
+  /* Query times and other diagnostics - tabbed with the statistics dock */
+  QDockWidget *diagnosticsDockWidget = nullptr;
+
   atools::sql::SqlDatabase db;
   QString databaseFile;
 
+  /* Read-only connections for statistics, tooltips and exports */
+  ConnectionPool *connectionPool = nullptr;
+
+  /* Statistics report created in background */
+  QFutureWatcher<QString> statsWatcher;
+  bool statsUpdatePending = false;
+
+  /* Changed files loaded in background after startup */
+  QFutureWatcher<BackgroundImport::Result> importWatcher;
+  bool importNotifyReload = true;
+
+  /* Delays the search while range widgets are edited. Date edits and spin boxes
+   * send a value for each key press and step. */
+  QTimer rangeFilterTimer;
+
+  /* Columns of the range widgets changed since the last search */
+  QSet<QString> changedRangeFilters;
+
+  /* Delay after the last change of a range widget */
+  static const int RANGE_FILTER_DELAY_MS = 500;
+
   bool hasAirports = false;
   bool hasLogbook = false;
   bool hasDatabaseLoadStatus = false;
 
+  /* Set if tables had to be recreated or could not be restored on opening the database */
+  bool reloadAllFiles = false;
+
+  /* Keep the database in memory and persist it as a snapshot file */
+  bool inMemoryDatabase = false;
+
+  /* Database was changed since the last snapshot */
+  bool databaseChanged = false;
+
   QString selectionLabelText;
   int defaultTableViewFontPointSize;
 
@@ -131,6 +170,10 @@ private:
   void openDatabase();
   void closeDatabase();
 
+  /* Write the in-memory database to the database file. Does nothing if the
+   * database is not kept in memory. */
+  void saveDatabaseSnapshot();
+
   /* Connect everything */
   void connectAllSlots();
 
@@ -154,6 +197,21 @@ private:
   /* Clear search */
   void resetSearch();
 
+  /* Pass the date range selected in the search bar to the controller */
+  void filterByDateRange();
+
+  /* Pass a value range from the search bar spin boxes to the controller. 0 means no limit. */
+  void filterByValueRange(const QString& colName, double minValue, double maxValue);
+
+  /* Remember a changed range widget and start the delay for searching */
+  void rangeFilterChanged(const QString& colName);
+
+  /* Pass all range filters changed since the last call to the controller */
+  void applyRangeFilters();
+
+  /* Reset all range widgets of the search bar without searching */
+  void clearRangeWidgets();
+
   /* Reset table view to default values after question dialog */
   void resetView();
 
@@ -167,12 +225,18 @@ private:
   /* Release table group by */
   void ungroup();
 
+  /* Show the pivot table dialog for the current search */
+  void showPivotTable();
+
   /* Update show toolbar, statusbar, etc. action states */
   void updateActionStates();
 
-  /* Update the statistics dock window */
+  /* Update the statistics dock window. The report is created in background. */
   void updateGlobalStats();
 
+  /* Show finished statistics report */
+  void globalStatsFinished();
+
   /* Update actions depending on loaded logbook, runways.xml etc. */
   void updateWidgetStatus();
 
@@ -182,15 +246,32 @@ private:
   /* Open the path management dialog and reload database if needed */
   void pathDialog();
 
-  /* Clean model and queries before changing the database to avoid locks */
+  /* Release model queries before changing the database to avoid locks */
   void preDatabaseLoad();
 
-  /* Restore view and model after database changes */
+  /* Update view and model after database changes. Only changed rows are updated
+   * if the table layout is the same. force creates a new model. */
   void postDatabaseLoad(bool force = false);
 
   /* Check for first start (show dialog then) or file changes (reload these) */
   void startupChecks();
 
+  /* Check and load changed files in background while the table is usable.
+   * notifyReload shows the change dialogs for the loaded files when done. */
+  void startBackgroundImport(bool notifyReload);
+
+  /* Mark loaded files, apply the changes to the model and report each file */
+  void backgroundImportFinished();
+
+  /* Show change dialog, error and status message for one imported file */
+  void reportBackgroundImport(const BackgroundImport::FileResult& file,
+                              const BackgroundImport::Result& result);
+  void handleBackgroundImportError(const BackgroundImport::Result& result);
+
+  /* Shows a message in the status bar if true. Database changes are not
+   * allowed while importing in background. */
+  bool isBackgroundImportRunning();
+
   void assignSearchFieldsToController();
 
   /* Update flags based on table presence */
@@ -208,9 +289,6 @@ private:
   /* Init table row height according to font size (smaller than default) */
   void initTableViewZoom();
 
-  /* Change font size and adjust row height accordingly */
-  void setTableViewFontSize(int pointSize);
-
   /* Reload all changed files */
   void checkAllFiles(bool notifyReload);
   void reloadChanged();
@@ -0,0 +1,192 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "gui/pivotdialog.h"
+#include "gui/constants.h"
+#include "gui/errorhandler.h"
+#include "export/csvexporter.h"
+#include "export/htmlexporter.h"
+#include "table/columnlist.h"
+#include "table/pivotmodel.h"
+#include "table/querybuilder.h"
+#include "settings/settings.h"
+#include "logging/loggingdefs.h"
+
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QFormLayout>
+#include <QHeaderView>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableView>
+#include <QVBoxLayout>
+
+using atools::settings::Settings;
+using atools::gui::ErrorHandler;
+
+PivotDialog::PivotDialog(QWidget *parent, atools::sql::SqlDatabase *sqlDb, const QueryBuilder& filterQuery,
+                         bool openAfterExport)
+  : QDialog(parent), openExported(openAfterExport)
+{
+  setWindowTitle(tr("Pivot Table"));
+
+  const ColumnList *columns = filterQuery.getColumnList();
+  model = new PivotModel(this, sqlDb, columns);
+  model->getQuery().setFilter(filterQuery.getPredicates(), filterQuery.getWhereOperator() == "or");
+
+  int pageSize = Settings::instance().getAndStoreValue(
+    ll::constants::SETTINGS_EXPORT_HTML_PAGE_SIZE, 500).toInt();
+  csvExporter = new CsvExporter(this, model);
+  htmlExporter = new HtmlExporter(this, model, pageSize);
+
+  rowComboBox = new QComboBox(this);
+  columnComboBox = new QComboBox(this);
+  measureComboBox = new QComboBox(this);
+
+  measureComboBox->addItem(tr("Number of Flights"), QString());
+  for(const Column& col : columns->getColumns())
+  {
+    if(col.isHiddenCol())
+      continue;
+
+    QString name = col.getDisplayName();
+    name.replace("-\n", "").replace("\n", " ");
+    if(col.isGroup())
+    {
+      rowComboBox->addItem(name, col.getColumnName());
+      columnComboBox->addItem(name, col.getColumnName());
+    }
+    if(col.isSum())
+      measureComboBox->addItem(name, col.getColumnName());
+  }
+
+  Settings& s = Settings::instance();
+  selectColumn(rowComboBox, s->value(ll::constants::SETTINGS_PIVOT_ROWS, "aircraft_reg").toString());
+  selectColumn(columnComboBox, s->value(ll::constants::SETTINGS_PIVOT_COLUMNS, "start_year").toString());
+  selectColumn(measureComboBox, s->value(ll::constants::SETTINGS_PIVOT_MEASURE, "total_time").toString());
+
+  statusLabel = new QLabel(this);
+
+  tableView = new QTableView(this);
+  tableView->setModel(model);
+  tableView->setAlternatingRowColors(true);
+  tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+  tableView->setSelectionBehavior(QAbstractItemView::SelectRows);
+  tableView->setWordWrap(false);
+  tableView->horizontalHeader()->setStretchLastSection(false);
+
+  QDialogButtonBox *buttonBox = new QDialogButtonBox(QDialogButtonBox::Close, this);
+  QPushButton *csvButton = buttonBox->addButton(tr("Export &CSV ..."), QDialogButtonBox::ActionRole);
+  QPushButton *htmlButton = buttonBox->addButton(tr("Export &HTML ..."), QDialogButtonBox::ActionRole);
+
+  QFormLayout *formLayout = new QFormLayout;
+  formLayout->addRow(tr("&Rows:"), rowComboBox);
+  formLayout->addRow(tr("C&olumns:"), columnComboBox);
+  formLayout->addRow(tr("&Values:"), measureComboBox);
+
+  QVBoxLayout *layout = new QVBoxLayout(this);
+  layout->addLayout(formLayout);
+  layout->addWidget(tableView);
+  layout->addWidget(statusLabel);
+  layout->addWidget(buttonBox);
+
+  resize(s->value(ll::constants::SETTINGS_PIVOT_DIALOG_SIZE, QSize(900, 600)).toSize());
+
+  void (QComboBox::*indexChangedPtr)(int) = &QComboBox::currentIndexChanged;
+  connect(rowComboBox, indexChangedPtr, this, &PivotDialog::updatePivot);
+  connect(columnComboBox, indexChangedPtr, this, &PivotDialog::updatePivot);
+  connect(measureComboBox, indexChangedPtr, this, &PivotDialog::updatePivot);
+  connect(csvButton, &QPushButton::clicked, this, &PivotDialog::exportCsv);
+  connect(htmlButton, &QPushButton::clicked, this, &PivotDialog::exportHtml);
+  connect(buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+  updatePivot();
+}
+
+PivotDialog::~PivotDialog()
+{
+  Settings& s = Settings::instance();
+  s->setValue(ll::constants::SETTINGS_PIVOT_ROWS, rowComboBox->currentData().toString());
+  s->setValue(ll::constants::SETTINGS_PIVOT_COLUMNS, columnComboBox->currentData().toString());
+  s->setValue(ll::constants::SETTINGS_PIVOT_MEASURE, measureComboBox->currentData().toString());
+  s->setValue(ll::constants::SETTINGS_PIVOT_DIALOG_SIZE, size());
+
+  delete csvExporter;
+  delete htmlExporter;
+}
+
+void PivotDialog::selectColumn(QComboBox *comboBox, const QString& colName)
+{
+  int index = comboBox->findData(colName);
+  if(index != -1)
+    comboBox->setCurrentIndex(index);
+}
+
+void PivotDialog::updatePivot()
+{
+  PivotQuery& query = model->getQuery();
+  query.setRowColumn(rowComboBox->currentData().toString());
+  query.setColumnColumn(columnComboBox->currentData().toString());
+  query.setMeasure(measureComboBox->currentData().toString());
+
+  try
+  {
+    model->update();
+  }
+  catch(std::exception& e)
+  {
+    ErrorHandler(this).handleException(e, "While creating pivot table");
+  }
+  catch(...)
+  {
+    ErrorHandler(this).handleUnknownException("While creating pivot table");
+  }
+
+  tableView->resizeColumnsToContents();
+
+  QString text = tr("%1 rows.").arg(model->rowCount());
+  if(query.isTruncated())
+    text += tr(" Only the first %1 columns are shown. The total contains all flights.").
+            arg(PivotQuery::MAX_PIVOT_COLUMNS);
+  statusLabel->setText(text);
+}
+
+void PivotDialog::exportCsv()
+{
+  try
+  {
+    int exported = csvExporter->exportAll(openExported);
+    statusLabel->setText(tr("Exported %1 rows to CSV document.").arg(exported));
+  }
+  catch(std::exception& e)
+  {
+    ErrorHandler(this).handleException(e, "While exporting pivot table");
+  }
+}
+
+void PivotDialog::exportHtml()
+{
+  try
+  {
+    int exported = htmlExporter->exportAll(openExported);
+    statusLabel->setText(tr("Exported %1 rows to HTML document.").arg(exported));
+  }
+  catch(std::exception& e)
+  {
+    ErrorHandler(this).handleException(e, "While exporting pivot table");
+  }
+}
@@ -0,0 +1,76 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_PIVOTDIALOG_H
+#define LITTLELOGBOOK_PIVOTDIALOG_H
+
+#include <QDialog>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+}
+
+class CsvExporter;
+class HtmlExporter;
+class PivotModel;
+class QueryBuilder;
+class QComboBox;
+class QLabel;
+class QTableView;
+
+/*
+ * Shows a pivot table for the flights of the table view. Rows, columns and the
+ * measure (number of flights or a sum) can be selected. The table can be exported
+ * to CSV or HTML.
+ */
+class PivotDialog :
+  public QDialog
+{
+  Q_OBJECT
+
+public:
+  /*
+   * @param filterQuery Query of the table view. Its filter is used for the pivot table.
+   * @param sqlDb Database for the pivot query and exports
+   */
+  PivotDialog(QWidget *parent, atools::sql::SqlDatabase *sqlDb, const QueryBuilder& filterQuery,
+              bool openAfterExport);
+  virtual ~PivotDialog();
+
+private:
+  /* Run the query for the selected rows, columns and measure */
+  void updatePivot();
+
+  void exportCsv();
+  void exportHtml();
+
+  /* Select the combo box entry having the column name from the settings */
+  void selectColumn(QComboBox *comboBox, const QString& colName);
+
+  QComboBox *rowComboBox = nullptr, *columnComboBox = nullptr, *measureComboBox = nullptr;
+  QLabel *statusLabel = nullptr;
+  QTableView *tableView = nullptr;
+
+  PivotModel *model = nullptr;
+  CsvExporter *csvExporter = nullptr;
+  HtmlExporter *htmlExporter = nullptr;
+  bool openExported = false;
+};
+
+#endif // LITTLELOGBOOK_PIVOTDIALOG_H
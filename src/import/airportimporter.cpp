@@ -0,0 +1,58 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "import/airportimporter.h"
+
+#include "import/bulkloader.h"
+#include "fs/ap/airportloader.h"
+#include "sql/sqldatabase.h"
+#include "logging/loggingdefs.h"
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+
+using atools::sql::SqlDatabase;
+
+namespace {
+
+/* Approximate size of an airport with its runways in runways.xml used to estimate the number of airports */
+const qint64 AVERAGE_AIRPORT_BYTES = 1000;
+
+}
+
+AirportImporter::AirportImporter(SqlDatabase *sqlDb)
+  : db(sqlDb)
+{
+}
+
+void AirportImporter::loadAirports(const QString& filename)
+{
+  QElapsedTimer timer;
+  timer.start();
+  numLoaded = 0;
+
+  BulkLoader loader(db, "airport");
+  loader.begin(static_cast<int>(QFileInfo(filename).size() / AVERAGE_AIRPORT_BYTES));
+
+  atools::fs::ap::AirportLoader airportLoader(db);
+  airportLoader.loadAirports(filename);
+  numLoaded = airportLoader.getNumLoaded();
+
+  loader.finish();
+
+  qInfo() << "Loaded" << numLoaded << "airports from" << filename << "in" << timer.elapsed() << "ms";
+}
@@ -0,0 +1,54 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_AIRPORTIMPORTER_H
+#define LITTLELOGBOOK_AIRPORTIMPORTER_H
+
+#include <QString>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+} // namespace sql
+} // namespace atools
+
+/*
+ * Loads a runways.xml file with the atools AirportLoader into its airport table.
+ * The load runs within a BulkLoader which defers the index updates for large
+ * files and commits once.
+ */
+class AirportImporter
+{
+public:
+  AirportImporter(atools::sql::SqlDatabase *sqlDb);
+
+  /* Replace the airport table contents with the ones from the file.
+   * Throws an exception on error. */
+  void loadAirports(const QString& filename);
+
+  /* Number of airports loaded by last call */
+  int getNumLoaded() const
+  {
+    return numLoaded;
+  }
+
+private:
+  atools::sql::SqlDatabase *db;
+  int numLoaded = 0;
+};
+
+#endif // LITTLELOGBOOK_AIRPORTIMPORTER_H
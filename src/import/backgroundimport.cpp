@@ -0,0 +1,127 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "import/backgroundimport.h"
+
+#include "import/airportimporter.h"
+#include "diag/tracer.h"
+#include "gui/constants.h"
+#include "sql/sqldatabase.h"
+#include "logging/loggingdefs.h"
+
+using atools::sql::SqlDatabase;
+using atools::fs::SimulatorType;
+
+namespace {
+
+/* Name of the write connection used by the worker thread */
+const char *CONNECTION_NAME = "backgroundimport";
+
+BackgroundImport::FileResult fileResult(bool runways, SimulatorType type, const QString& file)
+{
+  BackgroundImport::FileResult result;
+  result.runways = runways;
+  result.type = type;
+  result.file = file;
+  return result;
+}
+
+}
+
+bool BackgroundImport::Result::hasChanges() const
+{
+  for(SimulatorType type : atools::fs::ALL_SIMULATOR_TYPES)
+    if(runwaysLoaded[type] || logbookLoaded[type])
+      return true;
+
+  // A failed import can leave changes behind
+  return error != nullptr;
+}
+
+BackgroundImport::Result BackgroundImport::run(const PathSettings& paths,
+                                               const atools::fs::lb::LogbookEntryFilter& filter,
+                                               const QString& databaseFile)
+{
+  TraceSpan span("backgroundImport", "import");
+  Result result;
+
+  if(!paths.hasAnyRunwaysFileChanged() && !paths.hasAnyLogbookFileChanged())
+  {
+    qDebug() << "Background import: no changed files";
+    return result;
+  }
+
+  {
+    // Connection has to be created, used and closed in this thread
+    SqlDatabase db;
+    db = SqlDatabase::addDatabase(ll::constants::DATABASE_TYPE, CONNECTION_NAME);
+
+    bool anyRunwaysLoaded = false;
+    try
+    {
+      db.setDatabaseName(databaseFile);
+      db.open();
+
+      for(SimulatorType type : atools::fs::ALL_SIMULATOR_TYPES)
+      {
+        if(paths.hasRunwaysFileChanged(type))
+        {
+          result.errorContext = "While loading airports";
+          result.files.append(fileResult(true, type, paths.getRunwaysFile(type)));
+
+          AirportImporter importer(&db);
+          importer.loadAirports(paths.getRunwaysFile(type));
+          result.runwaysLoaded[type] = anyRunwaysLoaded = true;
+          result.numAirports += importer.getNumLoaded();
+          result.files.last().numLoaded = importer.getNumLoaded();
+          result.files.last().failed = false;
+        }
+      }
+
+      // Runways loading invalidates all logbooks
+      for(SimulatorType type : atools::fs::ALL_SIMULATOR_TYPES)
+      {
+        if(anyRunwaysLoaded ? paths.isLogbookFileValid(type) : paths.hasLogbookFileChanged(type))
+        {
+          result.errorContext = "While loading logbook";
+          result.files.append(fileResult(false, type, paths.getLogbookFile(type)));
+
+          LogbookImporter importer(&db);
+          importer.loadLogbook(paths.getLogbookFile(type), type, filter);
+          result.logbookLoaded[type] = true;
+          result.numLogbookEntries += importer.getNumLoaded();
+          result.files.last().numLoaded = importer.getNumLoaded();
+          result.files.last().failed = false;
+        }
+      }
+      result.errorContext.clear();
+    }
+    catch(...)
+    {
+      result.error = std::current_exception();
+    }
+
+    if(db.getQSqlDatabase().isOpen())
+      db.close();
+  }
+  SqlDatabase::removeDatabase(CONNECTION_NAME);
+
+  span.setRows(result.numLogbookEntries);
+  qDebug() << "Background import done: airports" << result.numAirports
+           << "logbook entries" << result.numLogbookEntries;
+  return result;
+}
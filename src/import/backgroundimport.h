@@ -0,0 +1,77 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_BACKGROUNDIMPORT_H
+#define LITTLELOGBOOK_BACKGROUNDIMPORT_H
+
+#include "gui/pathsettings.h"
+#include "import/logbookimporter.h"
+
+#include <QList>
+
+#include <exception>
+
+/*
+ * Checks all configured runways.xml and logbook files for changes and imports
+ * the changed ones using an own database connection. Runs in a worker thread at
+ * startup while the table already shows the database contents.
+ *
+ * Nothing is changed in the settings. The caller has to mark the loaded files
+ * in its PathSettings and apply the changes to the model afterwards.
+ */
+class BackgroundImport
+{
+public:
+  /* One imported runways.xml or logbook file */
+  struct FileResult
+  {
+    bool runways = false;
+    atools::fs::SimulatorType type = atools::fs::FSX;
+    QString file;
+    int numLoaded = 0;
+
+    /* Import of this file threw the exception in Result::error */
+    bool failed = true;
+  };
+
+  struct Result
+  {
+    bool runwaysLoaded[NUM_SIMULATOR_TYPES] = {false, false, false, false};
+    bool logbookLoaded[NUM_SIMULATOR_TYPES] = {false, false, false, false};
+    int numAirports = 0, numLogbookEntries = 0;
+
+    /* All files in import order. The last one has failed if error is set. */
+    QList<FileResult> files;
+
+    /* Set if an import failed. All imports before are kept. */
+    std::exception_ptr error;
+    QString errorContext;
+
+    bool hasChanges() const;
+  };
+
+  /*
+   * @param paths copy of the path settings with the timestamps of the last import
+   * @param filter filter for logbook entries
+   * @param databaseFile database file which has to be in WAL mode to allow reading
+   * while importing
+   */
+  static Result run(const PathSettings& paths, const atools::fs::lb::LogbookEntryFilter& filter,
+                    const QString& databaseFile);
+};
+
+#endif // LITTLELOGBOOK_BACKGROUNDIMPORT_H
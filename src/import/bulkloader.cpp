@@ -0,0 +1,155 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "import/bulkloader.h"
+
+#include "diag/querystats.h"
+#include "sql/sqldatabase.h"
+#include "exception.h"
+#include "logging/loggingdefs.h"
+
+#include <QElapsedTimer>
+#include <QSqlError>
+#include <QSqlQuery>
+
+#include <algorithm>
+
+BulkLoader::BulkLoader(atools::sql::SqlDatabase *sqlDb, const QString& tableName)
+  : sqlDatabase(sqlDb->getQSqlDatabase()), table(tableName)
+{
+}
+
+BulkLoader::~BulkLoader()
+{
+  if(!finished)
+  {
+    qWarning() << "Bulk load into" << table << "not finished. Rolling back.";
+
+    // Restores deleted rows and dropped indexes too
+    if(inTransaction && !sqlDatabase.rollback())
+      qWarning() << "Rollback failed" << sqlDatabase.lastError().text();
+  }
+}
+
+void BulkLoader::begin(int expectedRows)
+{
+  if(!sqlDatabase.transaction())
+    throw atools::Exception("Cannot start transaction: " + sqlDatabase.lastError().text());
+  inTransaction = true;
+
+  // The loader creates the table on the first load
+  int tableRows = 0;
+  if(sqlDatabase.tables().contains(table))
+  {
+    QSqlQuery countQuery(sqlDatabase);
+    countQuery.prepare("select count(*) from " + table);
+    execQuery(countQuery, "Cannot count rows");
+    tableRows = countQuery.next() ? countQuery.value(0).toInt() : 0;
+    countQuery.finish();
+  }
+
+  // Updating indexes is cheaper than building them again for small loads into large tables
+  if(expectedRows >= MIN_DEFERRED_INDEX_ROWS && expectedRows * 2 >= tableRows)
+    dropIndexes();
+
+  qDebug() << "Bulk load into" << table << "expecting" << expectedRows << "rows into" << tableRows
+           << "dropped" << numDroppedIndexes << "indexes";
+}
+
+void BulkLoader::dropIndexes()
+{
+  // Remember all explicitly created indexes - automatic indexes have no SQL
+  QSqlQuery indexQuery(sqlDatabase);
+  indexQuery.prepare("select name, sql from sqlite_master "
+                     "where type = 'index' and tbl_name = ? and sql is not null");
+  indexQuery.addBindValue(table);
+  execQuery(indexQuery, "Cannot read indexes");
+
+  while(indexQuery.next())
+  {
+    droppedNames.append(indexQuery.value(0).toString());
+    droppedIndexes.append(indexQuery.value(1).toString());
+  }
+  indexQuery.finish();
+
+  for(const QString& name : droppedNames)
+    exec("drop index " + name);
+  numDroppedIndexes = droppedNames.size();
+}
+
+QStringList BulkLoader::indexNames()
+{
+  QSqlQuery indexQuery(sqlDatabase);
+  indexQuery.prepare("select name from sqlite_master where type = 'index' and tbl_name = ?");
+  indexQuery.addBindValue(table);
+  execQuery(indexQuery, "Cannot read indexes");
+
+  QStringList names;
+  while(indexQuery.next())
+    names.append(indexQuery.value(0).toString());
+  return names;
+}
+
+int BulkLoader::exec(const QString& sql, const QVariantList& bindValues)
+{
+  QSqlQuery query(sqlDatabase);
+  if(!query.prepare(sql))
+    throw atools::Exception(QString("Cannot prepare \"%1\": %2").arg(sql).arg(query.lastError().text()));
+
+  for(const QVariant& value : bindValues)
+    query.addBindValue(value);
+
+  QueryTimer timer(QueryStats::IMPORT);
+  execQuery(query, sql);
+  int rows = std::max(query.numRowsAffected(), 0);
+  timer.addRows(rows);
+  timer.addStatementCounters(query);
+  return rows;
+}
+
+void BulkLoader::finish()
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  // Loaders that create the table again also create some of the indexes
+  QStringList existing = indexNames();
+  for(int i = 0; i < droppedIndexes.size(); i++)
+  {
+    if(!existing.contains(droppedNames.at(i)))
+      exec(droppedIndexes.at(i));
+  }
+  droppedNames.clear();
+  droppedIndexes.clear();
+  indexMs = timer.restart();
+
+  exec("analyze " + table);
+  analyzeMs = timer.elapsed();
+
+  if(!sqlDatabase.commit())
+    throw atools::Exception("Cannot commit: " + sqlDatabase.lastError().text());
+  inTransaction = false;
+  finished = true;
+
+  qInfo() << "Bulk load into" << table << "done. Index" << indexMs << "ms analyze" << analyzeMs << "ms";
+}
+
+void BulkLoader::execQuery(QSqlQuery& query, const QString& message)
+{
+  if(!query.exec())
+    throw atools::Exception(message + ": " + query.lastError().text());
+}
@@ -0,0 +1,101 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_BULKLOADER_H
+#define LITTLELOGBOOK_BULKLOADER_H
+
+#include <QSqlDatabase>
+#include <QStringList>
+#include <QVariantList>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+} // namespace sql
+} // namespace atools
+
+/*
+ * Transaction and index handling for loading large numbers of rows into one
+ * table. The rows are inserted by the caller, usually one of the atools loaders,
+ * between begin() and finish() on the same connection. The whole load runs in a
+ * single transaction which is committed by finish().
+ *
+ * If the number of expected rows is large compared to the rows in the table the
+ * secondary indexes are dropped in begin() and created again in finish() within
+ * the same transaction. A single ANALYZE follows in both cases.
+ *
+ * Errors throw atools::Exception. If the loader is destroyed without calling
+ * finish() the transaction is rolled back which also restores dropped indexes.
+ */
+class BulkLoader
+{
+public:
+  BulkLoader(atools::sql::SqlDatabase *sqlDb, const QString& tableName);
+  ~BulkLoader();
+
+  /* Indexes are only dropped if at least this number of rows is expected */
+  static const int MIN_DEFERRED_INDEX_ROWS = 10000;
+
+  /* Start transaction and drop secondary indexes if expectedRows is at least half
+   * of the rows in the table. expectedRows can be an estimate. The table does not
+   * have to exist yet. */
+  void begin(int expectedRows);
+
+  /* Execute a statement within the load transaction like deleting old rows
+   * @return number of changed rows */
+  int exec(const QString& sql, const QVariantList& bindValues = QVariantList());
+
+  /* Recreate dropped indexes, run ANALYZE and commit */
+  void finish();
+
+  /* Number of indexes dropped by begin() */
+  int getNumDroppedIndexes() const
+  {
+    return numDroppedIndexes;
+  }
+
+  /* Time spent for index creation and analyze in milliseconds */
+  qint64 getIndexMs() const
+  {
+    return indexMs;
+  }
+
+  qint64 getAnalyzeMs() const
+  {
+    return analyzeMs;
+  }
+
+private:
+  void execQuery(QSqlQuery& query, const QString& message);
+
+  /* Drop all explicitly created indexes of the table and remember their SQL */
+  void dropIndexes();
+
+  /* Names of all indexes of the table */
+  QStringList indexNames();
+
+  QSqlDatabase sqlDatabase;
+  QString table;
+
+  /* Name and SQL of each dropped index */
+  QStringList droppedNames, droppedIndexes;
+  int numDroppedIndexes = 0;
+  bool inTransaction = false, finished = false;
+  qint64 indexMs = 0, analyzeMs = 0;
+};
+
+#endif // LITTLELOGBOOK_BULKLOADER_H
@@ -0,0 +1,167 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "import/logbookcrosscheck.h"
+
+#include "import/logbookreader.h"
+#include "gui/constants.h"
+#include "fs/lb/logbookloader.h"
+#include "fs/lb/logbookentryfilter.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "logging/loggingdefs.h"
+
+#include <QHash>
+#include <QVariant>
+
+#include <algorithm>
+#include <cmath>
+
+using atools::sql::SqlDatabase;
+using atools::sql::SqlQuery;
+
+namespace {
+
+/* Connection name used for the loader database */
+const char *CROSSCHECK_CONNECTION = "logbookcrosscheck";
+
+/* Loader columns in the order of the fields compared below */
+const char *LOADER_QUERY =
+  "select logbook_id, startdate, total_time, night_time, instrument_time, aircraft_type, aircraft_flags, "
+  "airport_from_icao, airport_to_icao, description, aircraft_reg, aircraft_descr, visits "
+  "from logbook";
+
+/* Compared fields without the entry number */
+const QStringList FIELD_NAMES(
+{
+  "startdate", "total_time", "night_time", "instrument_time", "aircraft_type", "aircraft_flags",
+  "airport_from_icao", "airport_to_icao", "description", "aircraft_reg", "aircraft_descr", "visits"
+});
+
+/* Number of numeric fields at the start of the list */
+const int NUM_NUMBER_FIELDS = 6;
+
+}
+
+LogbookCrossCheck::LogbookCrossCheck(const QString& logbookFilename)
+  : filename(logbookFilename)
+{
+}
+
+bool LogbookCrossCheck::run(int sampleStep)
+{
+  numReaderRecords = numLoaderRecords = numCompared = numReaderOnly = numLoaderOnly = numMismatches = 0;
+  mismatches.clear();
+  sampleStep = std::max(sampleStep, 1);
+
+  // Fields of all loader entries by entry number
+  QHash<quint32, QVariantList> loaderEntries;
+  {
+    SqlDatabase db = SqlDatabase::addDatabase(ll::constants::DATABASE_TYPE, CROSSCHECK_CONNECTION);
+    db.setDatabaseName(":memory:");
+    db.open();
+
+    atools::fs::lb::LogbookLoader loader(&db);
+    loader.loadLogbook(filename, atools::fs::FSX, atools::fs::lb::LogbookEntryFilter(), false /* append */);
+
+    SqlQuery query(&db);
+    query.exec(LOADER_QUERY);
+    while(query.next())
+    {
+      QVariantList values;
+      for(int i = 0; i < FIELD_NAMES.size(); i++)
+        values.append(query.value(i + 1));
+
+      quint32 entryNumber = query.value(0).toUInt();
+      if(loaderEntries.contains(entryNumber))
+        addMismatch(QString("Entry %1: duplicate in loader").arg(entryNumber));
+      loaderEntries.insert(entryNumber, values);
+      numLoaderRecords++;
+    }
+    query.finish();
+    db.close();
+  }
+  SqlDatabase::removeDatabase(CROSSCHECK_CONNECTION);
+
+  LogbookReader reader;
+  reader.open(filename);
+
+  LogbookRecord rec;
+  while(reader.next(rec))
+  {
+    auto it = loaderEntries.find(rec.entryNumber);
+    if(it == loaderEntries.end())
+    {
+      // Skipped by the loader or a duplicate entry number of the reader
+      qDebug() << "Entry" << rec.entryNumber << "not loaded by loader";
+      numReaderOnly++;
+    }
+    else
+    {
+      if(numReaderRecords % sampleStep == 0)
+      {
+        QVariantList values;
+        values << rec.startDate << rec.totalTime << rec.nightTime << rec.instrumentTime
+               << rec.aircraftType << rec.aircraftFlags
+               << rec.airportFrom.toString() << rec.airportTo.toString() << rec.description.toString()
+               << rec.aircraftReg.toString() << rec.aircraftDescr.toString() << rec.visits.toString();
+
+        for(int i = 0; i < FIELD_NAMES.size(); i++)
+        {
+          QVariant readerValue = values.at(i), loaderValue = it.value().at(i);
+
+          bool equal;
+          if(i < NUM_NUMBER_FIELDS)
+            // Times are floats in the file and doubles in the database
+            equal = std::abs(readerValue.toDouble() - loaderValue.toDouble()) < 1.e-5;
+          else
+            // Null and empty strings are equal
+            equal = readerValue.toString() == loaderValue.toString();
+
+          if(!equal)
+            addMismatch(QString("Entry %1 field %2: reader \"%3\" loader \"%4\"").
+                        arg(rec.entryNumber).arg(FIELD_NAMES.at(i)).
+                        arg(readerValue.toString()).arg(loaderValue.toString()));
+        }
+        numCompared++;
+      }
+      loaderEntries.erase(it);
+    }
+    numReaderRecords++;
+  }
+
+  // Remaining entries were not found by the reader
+  for(auto it = loaderEntries.constBegin(); it != loaderEntries.constEnd(); ++it)
+  {
+    numLoaderOnly++;
+    addMismatch(QString("Entry %1: not read by reader").arg(it.key()));
+  }
+
+  qInfo() << "Cross-check of" << filename << "compared" << numCompared << "of" << numReaderRecords
+          << "records with" << numMismatches << "differences." << numReaderOnly << "records skipped by loader";
+  return numMismatches == 0;
+}
+
+void LogbookCrossCheck::addMismatch(const QString& text)
+{
+  numMismatches++;
+  if(mismatches.size() < MAX_MISMATCHES)
+  {
+    qWarning() << text;
+    mismatches.append(text);
+  }
+}
@@ -0,0 +1,98 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_LOGBOOKCROSSCHECK_H
+#define LITTLELOGBOOK_LOGBOOKCROSSCHECK_H
+
+#include <QStringList>
+
+/*
+ * Compares the records of the memory mapped LogbookReader with the entries the
+ * atools LogbookLoader writes for the same Logbook.BIN file. The loader is run
+ * into a private in-memory database without any filter.
+ *
+ * Records are matched by the entry number of the reader and the logbook_id of the
+ * loader. All other fields of matched records have to be equal. Entries of the
+ * loader that the reader did not return are differences. Records that the loader
+ * skipped are only counted.
+ *
+ * The reader is not used for imports. This check has to pass on real logbooks of
+ * all simulators before it can be.
+ */
+class LogbookCrossCheck
+{
+public:
+  /* Maximum number of difference descriptions kept */
+  static const int MAX_MISMATCHES = 20;
+
+  LogbookCrossCheck(const QString& logbookFilename);
+
+  /* Match all records and compare the fields of every sampleStep-th record.
+   * @return true if no differences were found.
+   * Throws an exception if the file cannot be read by one of both. */
+  bool run(int sampleStep = 1);
+
+  int getNumReaderRecords() const
+  {
+    return numReaderRecords;
+  }
+
+  int getNumLoaderRecords() const
+  {
+    return numLoaderRecords;
+  }
+
+  /* Number of records whose fields were compared */
+  int getNumCompared() const
+  {
+    return numCompared;
+  }
+
+  /* Number of reader records without an entry of the loader like skipped invalid records */
+  int getNumReaderOnly() const
+  {
+    return numReaderOnly;
+  }
+
+  /* Number of loader entries without a record of the reader */
+  int getNumLoaderOnly() const
+  {
+    return numLoaderOnly;
+  }
+
+  /* Number of differing fields, loader only and duplicate entries */
+  int getNumMismatches() const
+  {
+    return numMismatches;
+  }
+
+  /* Descriptions of the first differences */
+  const QStringList& getMismatches() const
+  {
+    return mismatches;
+  }
+
+private:
+  void addMismatch(const QString& text);
+
+  QString filename;
+  int numReaderRecords = 0, numLoaderRecords = 0, numCompared = 0, numReaderOnly = 0, numLoaderOnly = 0,
+      numMismatches = 0;
+  QStringList mismatches;
+};
+
+#endif // LITTLELOGBOOK_LOGBOOKCROSSCHECK_H
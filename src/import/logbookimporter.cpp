@@ -0,0 +1,250 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "import/logbookimporter.h"
+
+#include "import/bulkloader.h"
+#include "gui/constants.h"
+#include "fs/lb/logbookloader.h"
+#include "settings/settings.h"
+#include "sql/sqldatabase.h"
+#include "logging/loggingdefs.h"
+
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSqlQuery>
+#include <QStringList>
+
+using atools::sql::SqlDatabase;
+using atools::settings::Settings;
+
+namespace {
+
+/* Columns added to the table of the atools loader for grouping */
+const QStringList CALENDAR_COLUMNS({"start_year", "start_month", "start_week", "start_weekday"});
+
+/* Thursday of the ISO week of startdate which is local time stored without timezone */
+const char *ISO_THURSDAY = "startdate, 'unixepoch', '-3 days', 'weekday 4'";
+
+/* Rows are identified by simulator and entry number */
+const char *LOGBOOK_KEY =
+  "create unique index if not exists idx_logbook_simulator_id_logbook_id "
+  "on logbook(simulator_id, logbook_id)";
+
+/* Secondary indexes. These are dropped and recreated by the bulk loader for large loads.
+ * Search columns use nocase indexes since only these allow "like" prefix searches to
+ * use the index.
+ * Range columns are indexed together with simulator_id which allows a single seek
+ * for a range of one simulator. Ranges over all simulators use a skip-scan since
+ * there are only a few distinct simulators.
+ * Calendar columns are read in index order when grouping. The month index covers all
+ * summed columns so that monthly summaries do not have to read the table. */
+const QStringList LOGBOOK_INDEXES(
+{
+  "create index if not exists idx_logbook_startdate on logbook(startdate)",
+  "create index if not exists idx_logbook_simulator_id_startdate on logbook(simulator_id, startdate)",
+  "create index if not exists idx_logbook_simulator_id_distance on logbook(simulator_id, distance)",
+  "create index if not exists idx_logbook_simulator_id_total_time on logbook(simulator_id, total_time)",
+  "create index if not exists idx_logbook_simulator_id_night_time on logbook(simulator_id, night_time)",
+  "create index if not exists idx_logbook_simulator_id_instrument_time "
+  "on logbook(simulator_id, instrument_time)",
+  "create index if not exists idx_logbook_start_year on logbook(start_year)",
+  "create index if not exists idx_logbook_start_month_cover "
+  "on logbook(start_month, simulator_id, total_time, night_time, instrument_time, distance)",
+  "create index if not exists idx_logbook_start_week on logbook(start_week)",
+  "create index if not exists idx_logbook_start_weekday on logbook(start_weekday)",
+  "create index if not exists idx_logbook_airport_from_icao_nc on logbook(airport_from_icao collate nocase)",
+  "create index if not exists idx_logbook_airport_to_icao_nc on logbook(airport_to_icao collate nocase)",
+  "create index if not exists idx_logbook_aircraft_reg_nc on logbook(aircraft_reg collate nocase)",
+  "create index if not exists idx_logbook_aircraft_descr_nc on logbook(aircraft_descr collate nocase)"
+});
+
+/* Indexes that are replaced by the ones above */
+const QStringList OBSOLETE_LOGBOOK_INDEXES(
+{
+  "idx_logbook_airport_from_icao", "idx_logbook_airport_to_icao", "idx_logbook_aircraft_reg",
+  "idx_logbook_simulator_id"
+});
+
+/* Approximate size of a Logbook.BIN entry used to estimate the number of entries */
+const qint64 AVERAGE_ENTRY_BYTES = 96;
+
+}
+
+LogbookImporter::LogbookImporter(SqlDatabase *sqlDb)
+  : db(sqlDb)
+{
+}
+
+atools::fs::lb::LogbookEntryFilter LogbookImporter::filterFromSettings()
+{
+  Settings& s = Settings::instance();
+
+  atools::fs::lb::LogbookEntryFilter filter;
+  if(s.getAndStoreValue(ll::constants::SETTINGS_FILTER_INVALID_DATE, true).toBool())
+    filter.invalidDate();
+
+  if(s.getAndStoreValue(ll::constants::SETTINGS_FILTER_START_AND_DEST_EMPTY, true).toBool())
+    filter.startAndDestEmpty();
+
+  if(s.getAndStoreValue(ll::constants::SETTINGS_FILTER_START_OR_DEST_EMPTY, false).toBool())
+    filter.startOrDestEmpty();
+
+  if(s.getAndStoreValue(ll::constants::SETTINGS_FILTER_START_DEST_SAME, true).toBool())
+    filter.startAndDestSame();
+
+  int minFlightTimeMins = s.getAndStoreValue(ll::constants::SETTINGS_FILTER_MIN_FLIGH_TIME, 5).toInt();
+  if(minFlightTimeMins)
+    filter.flightTimeLowerThan(minFlightTimeMins);
+
+  s.syncSettings();
+  return filter;
+}
+
+void LogbookImporter::updateSchema(SqlDatabase *db)
+{
+  if(!db->getQSqlDatabase().tables().contains("logbook"))
+    return;
+
+  // The key is created last and only missing in tables of older versions
+  QSqlQuery query(db->getQSqlDatabase());
+  query.exec("select count(*) from sqlite_master where type = 'index' and "
+             "name = 'idx_logbook_simulator_id_logbook_id'");
+  bool hasKey = query.next() && query.value(0).toInt() > 0;
+  query.finish();
+  if(hasKey)
+    return;
+
+  BulkLoader loader(db, "logbook");
+  loader.begin(0);
+
+  if(addCalendarColumns(db, loader))
+    fillCalendarColumns(loader, QVariant());
+
+  // Needed before the unique key can be created
+  if(removeDuplicates(loader, QVariant()) > 0)
+    qWarning() << "Removed duplicate logbook entries";
+
+  createIndexes(loader);
+  loader.finish();
+}
+
+void LogbookImporter::updateEntries(SqlDatabase *db, atools::fs::SimulatorType type)
+{
+  BulkLoader loader(db, "logbook");
+  loader.begin(0);
+
+  QVariant simulator(static_cast<int>(type));
+  addCalendarColumns(db, loader);
+  removeDuplicates(loader, simulator);
+  fillCalendarColumns(loader, simulator);
+  createIndexes(loader);
+  loader.finish();
+}
+
+void LogbookImporter::loadLogbook(const QString& filename, atools::fs::SimulatorType type,
+                                  const atools::fs::lb::LogbookEntryFilter& filter)
+{
+  QElapsedTimer timer;
+  timer.start();
+  numLoaded = 0;
+  numDuplicates = 0;
+  phaseTimes = LogbookImportTimes();
+
+  BulkLoader loader(db, "logbook");
+  loader.begin(static_cast<int>(QFileInfo(filename).size() / AVERAGE_ENTRY_BYTES));
+
+  // Replaces all entries of the simulator and creates the table if needed
+  atools::fs::lb::LogbookLoader logbookLoader(db);
+  logbookLoader.loadLogbook(filename, type, filter, false /* append */);
+  phaseTimes.loadMs = timer.restart();
+
+  QVariant simulator(static_cast<int>(type));
+  addCalendarColumns(db, loader);
+  numDuplicates = removeDuplicates(loader, simulator);
+  fillCalendarColumns(loader, simulator);
+  numLoaded = logbookLoader.getNumLoaded() - numDuplicates;
+  phaseTimes.updateMs = timer.restart();
+
+  createIndexes(loader);
+  loader.finish();
+  phaseTimes.indexMs = timer.elapsed() - loader.getAnalyzeMs();
+  phaseTimes.analyzeMs = loader.getAnalyzeMs();
+
+  qInfo() << "Loaded" << numLoaded << "logbook entries from" << filename
+          << "removed" << numDuplicates << "duplicates"
+          << "load" << phaseTimes.loadMs << "ms update" << phaseTimes.updateMs << "ms"
+          << "index" << phaseTimes.indexMs << "ms analyze" << phaseTimes.analyzeMs << "ms";
+}
+
+bool LogbookImporter::addCalendarColumns(SqlDatabase *db, BulkLoader& loader)
+{
+  QStringList existing;
+  QSqlQuery query(db->getQSqlDatabase());
+  query.exec("pragma table_info(logbook)");
+  while(query.next())
+    existing.append(query.value("name").toString());
+  query.finish();
+
+  bool added = false;
+  for(const QString& col : CALENDAR_COLUMNS)
+  {
+    if(!existing.contains(col))
+    {
+      loader.exec("alter table logbook add column " + col + " integer");
+      added = true;
+    }
+  }
+  return added;
+}
+
+int LogbookImporter::removeDuplicates(BulkLoader& loader, const QVariant& simulator)
+{
+  if(simulator.isNull())
+    return loader.exec("delete from logbook where rowid not in "
+                       "(select min(rowid) from logbook group by simulator_id, logbook_id)");
+  else
+    return loader.exec("delete from logbook where simulator_id = ? and rowid not in "
+                       "(select min(rowid) from logbook where simulator_id = ? group by logbook_id)",
+                       {simulator, simulator});
+}
+
+void LogbookImporter::fillCalendarColumns(BulkLoader& loader, const QVariant& simulator)
+{
+  // ISO week and its year are the ones of the Thursday in the same week - weekday is 1 for Monday
+  QString sql = QString("update logbook set "
+                        "start_year = cast(strftime('%Y', startdate, 'unixepoch') as integer), "
+                        "start_month = cast(strftime('%Y%m', startdate, 'unixepoch') as integer), "
+                        "start_week = cast(strftime('%Y', %1) as integer) * 100 + "
+                        "(cast(strftime('%j', %1) as integer) - 1) / 7 + 1, "
+                        "start_weekday = (cast(strftime('%w', startdate, 'unixepoch') as integer) + 6) % 7 + 1 "
+                        "where startdate > 0").arg(ISO_THURSDAY);
+
+  if(simulator.isNull())
+    loader.exec(sql);
+  else
+    loader.exec(sql + " and simulator_id = ?", {simulator});
+}
+
+void LogbookImporter::createIndexes(BulkLoader& loader)
+{
+  for(const QString& index : OBSOLETE_LOGBOOK_INDEXES)
+    loader.exec("drop index if exists " + index);
+  for(const QString& index : LOGBOOK_INDEXES)
+    loader.exec(index);
+  loader.exec(LOGBOOK_KEY);
+}
@@ -0,0 +1,112 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_LOGBOOKIMPORTER_H
+#define LITTLELOGBOOK_LOGBOOKIMPORTER_H
+
+#include "fs/fspaths.h"
+#include "fs/lb/logbookentryfilter.h"
+
+#include <QString>
+#include <QVariant>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+} // namespace sql
+} // namespace atools
+
+class BulkLoader;
+
+/* Time spent in the phases of an import in milliseconds */
+struct LogbookImportTimes
+{
+  qint64 loadMs = 0; /* Reading the file and inserting by the atools loader */
+  qint64 updateMs = 0; /* Duplicate removal and calendar columns */
+  qint64 indexMs = 0; /* Creating indexes */
+  qint64 analyzeMs = 0;
+};
+
+/*
+ * Loads a Logbook.BIN file with the atools LogbookLoader into its logbook table.
+ * The load runs within a BulkLoader which defers the index updates for large
+ * files and commits once.
+ *
+ * logbook_id is the entry number of the simulator. Rows are identified by
+ * simulator_id and logbook_id which are made unique after each load.
+ */
+class LogbookImporter
+{
+public:
+  LogbookImporter(atools::sql::SqlDatabase *sqlDb);
+
+  /* Replace all entries of the simulator with the ones from the file.
+   * Throws an exception on error. */
+  void loadLogbook(const QString& filename, atools::fs::SimulatorType type,
+                   const atools::fs::lb::LogbookEntryFilter& filter);
+
+  /* Filter as configured in the settings. Stores defaults on first access. */
+  static atools::fs::lb::LogbookEntryFilter filterFromSettings();
+
+  /* Number of entries loaded by last call without duplicates */
+  int getNumLoaded() const
+  {
+    return numLoaded;
+  }
+
+  /* Number of duplicate entries removed by last call */
+  int getNumDuplicates() const
+  {
+    return numDuplicates;
+  }
+
+  /* Phase times of the last call */
+  const LogbookImportTimes& getPhaseTimes() const
+  {
+    return phaseTimes;
+  }
+
+  /* Add calendar columns, unique key and indexes to a logbook table loaded by an
+   * older version. Does nothing if the table does not exist. */
+  static void updateSchema(atools::sql::SqlDatabase *db);
+
+  /* Remove duplicates and fill calendar columns for entries of the simulator that
+   * were not inserted by loadLogbook() like generated benchmark entries. */
+  static void updateEntries(atools::sql::SqlDatabase *db, atools::fs::SimulatorType type);
+
+private:
+  /* Add missing calendar columns
+   * @return true if columns were added */
+  static bool addCalendarColumns(atools::sql::SqlDatabase *db, BulkLoader& loader);
+
+  /* Keep only the first row for each simulator_id and logbook_id of the simulator
+   * or of all simulators if the simulator is null.
+   * @return number of removed rows */
+  static int removeDuplicates(BulkLoader& loader, const QVariant& simulator);
+
+  /* Calculate year, month, week and weekday from startdate */
+  static void fillCalendarColumns(BulkLoader& loader, const QVariant& simulator);
+
+  /* Create the unique key and the indexes for searching and grouping */
+  static void createIndexes(BulkLoader& loader);
+
+  atools::sql::SqlDatabase *db;
+  int numLoaded = 0, numDuplicates = 0;
+  LogbookImportTimes phaseTimes;
+};
+
+#endif // LITTLELOGBOOK_LOGBOOKIMPORTER_H
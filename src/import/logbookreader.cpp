@@ -0,0 +1,215 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "import/logbookreader.h"
+
+#include "diag/memorystats.h"
+#include "exception.h"
+#include "logging/loggingdefs.h"
+
+#include <QtEndian>
+
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+template<typename TYPE>
+TYPE readValue(const uchar *src)
+{
+  return qFromLittleEndian<TYPE>(src);
+}
+
+template<>
+float readValue<float>(const uchar *src)
+{
+  quint32 bits = qFromLittleEndian<quint32>(src);
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+} // namespace
+
+QString LogbookString::toString() const
+{
+  int len = length;
+  // Ignore trailing null characters
+  while(len > 0 && readValue<quint16>(data + (len - 1) * 2) == 0)
+    len--;
+
+  if(len == 0)
+    return QString();
+
+  QString str(len, Qt::Uninitialized);
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+  // Data is already in the QString layout - a plain (vectorized) copy is sufficient
+  std::memcpy(str.data(), data, static_cast<size_t>(len) * 2);
+#else
+  ushort *dest = reinterpret_cast<ushort *>(str.data());
+  for(int i = 0; i < len; i++)
+    dest[i] = readValue<quint16>(data + i * 2);
+#endif
+  return str;
+}
+
+bool LogbookString::toLatin1(char *buffer, int bufferSize) const
+{
+  if(length >= bufferSize)
+    return false;
+
+  int i = 0;
+#if defined(__SSE2__)
+  // Convert eight characters at once - fail if any high byte is set
+  const __m128i highMask = _mm_set1_epi16(static_cast<short>(0xff00));
+  const __m128i zero = _mm_setzero_si128();
+  for(; i + 8 <= length; i += 8)
+  {
+    __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i *>(data + i * 2));
+    if(_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(chars, highMask), zero)) != 0xffff)
+      return false;
+
+    _mm_storel_epi64(reinterpret_cast<__m128i *>(buffer + i), _mm_packus_epi16(chars, zero));
+  }
+#endif
+
+  for(; i < length; i++)
+  {
+    quint16 c = readValue<quint16>(data + i * 2);
+    if(c > 0xff)
+      return false;
+
+    buffer[i] = static_cast<char>(c);
+  }
+
+  buffer[length] = '\0';
+  return true;
+}
+
+LogbookReader::LogbookReader()
+{
+}
+
+LogbookReader::~LogbookReader()
+{
+  close();
+}
+
+void LogbookReader::open(const QString& filename)
+{
+  close();
+
+  file.setFileName(filename);
+  if(!file.open(QIODevice::ReadOnly))
+    throw atools::Exception(QString("Cannot open logbook \"%1\": %2").arg(filename).arg(file.errorString()));
+
+  size = file.size();
+  if(size > 0)
+  {
+    data = file.map(0, size);
+    if(data == nullptr)
+    {
+      QString err = file.errorString();
+      file.close();
+      throw atools::Exception(QString("Cannot map logbook \"%1\": %2").arg(filename).arg(err));
+    }
+  }
+  MemoryStats::instance().set(MemoryStats::IMPORT_MAPPED_BYTES, size);
+  qDebug() << "Mapped logbook" << filename << "size" << size;
+}
+
+void LogbookReader::close()
+{
+  if(data != nullptr)
+    file.unmap(const_cast<uchar *>(data));
+  if(file.isOpen())
+    file.close();
+
+  if(size > 0)
+    MemoryStats::instance().set(MemoryStats::IMPORT_MAPPED_BYTES, 0);
+
+  data = nullptr;
+  size = 0;
+  pos = 0;
+  numRead = 0;
+}
+
+bool LogbookReader::next(LogbookRecord& record)
+{
+  if(data == nullptr || pos + 4 > size)
+    return false;
+
+  quint32 recordSize = readValue<quint32>(data + pos);
+  if(recordSize < RECORD_HEADER_SIZE + NUM_RECORD_STRINGS * 2 || pos + recordSize > size)
+    throw atools::Exception(QString("Corrupt logbook record %1 at offset %2 with size %3").
+                            arg(numRead).arg(pos).arg(recordSize));
+
+  const uchar *rec = data + pos;
+  record.entryNumber = readValue<quint32>(rec + 4);
+  record.startDate = readValue<quint32>(rec + 8);
+  record.totalTime = readValue<float>(rec + 12);
+  record.nightTime = readValue<float>(rec + 16);
+  record.instrumentTime = readValue<float>(rec + 20);
+  record.aircraftType = readValue<quint16>(rec + 24);
+  record.aircraftFlags = readValue<quint16>(rec + 26);
+
+  qint64 end = pos + recordSize;
+  pos += RECORD_HEADER_SIZE;
+
+  if(!(readString(end, record.airportFrom) && readString(end, record.airportTo) &&
+       readString(end, record.description) && readString(end, record.aircraftReg) &&
+       readString(end, record.aircraftDescr) && readString(end, record.visits)))
+    throw atools::Exception(QString("Truncated string in logbook record %1 at offset %2").
+                            arg(numRead).arg(end - recordSize));
+
+  // Skip any unknown trailing data
+  pos = end;
+  numRead++;
+  return true;
+}
+
+QVector<LogbookRecord> LogbookReader::readAll()
+{
+  QVector<LogbookRecord> records;
+  // Rough estimate to avoid most reallocations
+  records.reserve(static_cast<int>((size - pos) / AVERAGE_RECORD_SIZE));
+
+  LogbookRecord record;
+  while(next(record))
+    records.append(record);
+  return records;
+}
+
+bool LogbookReader::readString(qint64 end, LogbookString& str)
+{
+  if(pos + 2 > end)
+    return false;
+
+  int len = readValue<quint16>(data + pos);
+  pos += 2;
+
+  if(pos + len * 2 > end)
+    return false;
+
+  str.data = data + pos;
+  str.length = len;
+  pos += len * 2;
+  return true;
+}
@@ -0,0 +1,135 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_LOGBOOKREADER_H
+#define LITTLELOGBOOK_LOGBOOKREADER_H
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+
+/*
+ * Reference to a UTF-16LE string inside the mapped logbook file. Only valid
+ * as long as the LogbookReader is open.
+ */
+struct LogbookString
+{
+  const uchar *data = nullptr;
+  int length = 0; /* Number of UTF-16 code units */
+
+  bool isEmpty() const
+  {
+    return length == 0;
+  }
+
+  /* Decode into a QString. This is a plain copy on little endian machines. */
+  QString toString() const;
+
+  /* Narrow the string into a zero terminated Latin-1 buffer using SSE2 if available.
+   * @return false if the string does not fit into the buffer or contains
+   * characters outside of Latin-1 */
+  bool toLatin1(char *buffer, int bufferSize) const;
+};
+
+/*
+ * Compact logbook entry as read from the logbook file. All strings point into
+ * the mapped file and are not decoded until needed.
+ */
+struct LogbookRecord
+{
+  quint32 entryNumber = 0;
+  quint32 startDate = 0; /* time_t in local simulator time */
+  float totalTime = 0.f, nightTime = 0.f, instrumentTime = 0.f; /* hours */
+  quint16 aircraftType = 0, aircraftFlags = 0;
+
+  LogbookString airportFrom, airportTo, description, aircraftReg, aircraftDescr, visits;
+};
+
+/*
+ * Reads a Logbook.BIN file by memory mapping it and walking the record layout
+ * in place. No data is copied until a string is decoded.
+ *
+ * Each record has the following layout. All values are little endian.
+ *
+ *  Offset  Size  Content
+ *       0     4  Record size in bytes including this field
+ *       4     4  Entry number
+ *       8     4  Start date and time as time_t
+ *      12     4  Total time in hours (float)
+ *      16     4  Night time in hours (float)
+ *      20     4  Instrument time in hours (float)
+ *      24     2  Aircraft type
+ *      26     2  Aircraft flags
+ *      28     -  Strings: airport from ICAO, airport to ICAO, description,
+ *                aircraft registration, aircraft description, visits.
+ *                Each string is a 16 bit number of UTF-16 code units followed by
+ *                the UTF-16LE data.
+ *
+ * Data behind the last string up to the record size is ignored.
+ */
+class LogbookReader
+{
+public:
+  /* Size of the fixed part of a record */
+  static const int RECORD_HEADER_SIZE = 28;
+
+  /* Number of strings following the fixed part */
+  static const int NUM_RECORD_STRINGS = 6;
+
+  /* Rough average record size used to estimate the number of records of a file */
+  static const int AVERAGE_RECORD_SIZE = 96;
+
+  LogbookReader();
+  ~LogbookReader();
+
+  /* Open and map the file. Throws atools::Exception if the file cannot be opened or mapped. */
+  void open(const QString& filename);
+
+  /* Unmap and close. All LogbookString references become invalid. */
+  void close();
+
+  /* Read the next record.
+   * @return false if the end of the file was reached.
+   * Throws atools::Exception if a record is truncated or corrupt. */
+  bool next(LogbookRecord& record);
+
+  /* Read all remaining records */
+  QVector<LogbookRecord> readAll();
+
+  /* Number of records read so far */
+  int getNumRead() const
+  {
+    return numRead;
+  }
+
+  /* Size of the mapped file in bytes */
+  qint64 getSize() const
+  {
+    return size;
+  }
+
+private:
+  /* Read a string reference at pos and advance pos */
+  bool readString(qint64 end, LogbookString& str);
+
+  QFile file;
+  const uchar *data = nullptr;
+  qint64 size = 0, pos = 0;
+  int numRead = 0;
+};
+
+#endif // LITTLELOGBOOK_LOGBOOKREADER_H
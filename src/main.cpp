@@ -16,7 +16,10 @@
 *****************************************************************************/
 
 #include "gui/mainwindow.h"
+#include "cli/commandline.h"
 #include "gui/constants.h"
+#include "diag/slowquerylog.h"
+#include "diag/tracer.h"
 
 #include "settings/settings.h"
 #include "logging/logginghandler.h"
@@ -31,18 +34,53 @@
 #include <QSettings>
 #include <QSharedMemory>
 
+/* Set names used for settings and paths */
+static void setApplicationInfo()
+{
+  QCoreApplication::setApplicationName("Little Logbook");
+  QCoreApplication::setOrganizationName("ABarthel");
+  QCoreApplication::setOrganizationDomain("abarthel.org");
+  QCoreApplication::setApplicationVersion("1.5.0");
+}
+
+/* Run command line tool and write trace spans if configured */
+static int runCommandLine(QCoreApplication& app)
+{
+  Tracer::startIfConfigured();
+  SlowQueryLog::configure();
+  int retval = CommandLine(app).run();
+  Tracer::stop();
+  return retval;
+}
+
 int main(int argc, char *argv[])
 {
   // Initialize the resources from atools static library
   Q_INIT_RESOURCE(atools);
 
+  // Command line tools like benchmarks run without GUI
+  if(CommandLine::isToolMode(argc, argv))
+  {
+    if(CommandLine::needsGuiApplication(argc, argv))
+    {
+      // Models and views need a QApplication but no display
+      if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+
+      QApplication app(argc, argv);
+      setApplicationInfo();
+      return runCommandLine(app);
+    }
+
+    QCoreApplication app(argc, argv);
+    setApplicationInfo();
+    return runCommandLine(app);
+  }
+
   int retval = 0;
   QApplication app(argc, argv);
   QApplication::setWindowIcon(QIcon(":/littlelogbook/resources/icons/logbook.svg"));
-  QCoreApplication::setApplicationName("Little Logbook");
-  QCoreApplication::setOrganizationName("ABarthel");
-  QCoreApplication::setOrganizationDomain("abarthel.org");
-  QCoreApplication::setApplicationVersion("1.5.0");
+  setApplicationInfo();
 
   try
   {
@@ -81,6 +119,10 @@ int main(int argc, char *argv[])
     s.getAndStoreValue(ll::constants::SETTINGS_VERSION, QCoreApplication::applicationVersion());
     s.syncSettings();
 
+    // Collect trace spans if a trace file is given in environment or settings
+    Tracer::startIfConfigured();
+    SlowQueryLog::configure();
+
     MainWindow mainWindow;
     mainWindow.show();
 
@@ -88,6 +130,7 @@ int main(int argc, char *argv[])
     retval = app.exec();
 
     qDebug() << "app.exec() done, retval is" << retval;
+    Tracer::stop();
   }
   catch(atools::Exception& e)
   {
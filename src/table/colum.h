@@ -82,6 +82,13 @@ public:
     return *this;
   }
 
+  /* Column can be filtered by a range of values */
+  Column& canRange(bool b = true)
+  {
+    canBeRanged = b;
+    return *this;
+  }
+
   /* Column can be used in group by */
   Column& canGroup(bool b = true)
   {
@@ -124,6 +131,13 @@ public:
     return *this;
   }
 
+  /* Column has an index that can be used for "like" prefix or range searches */
+  Column& indexed(bool b = true)
+  {
+    hasIndex = b;
+    return *this;
+  }
+
   /* Sort function for column */
   Column& sortFunc(const QString& sortFuncAsc, const QString& sortFuncDesc)
   {
@@ -178,6 +192,11 @@ public:
     return canBeFiltered;
   }
 
+  bool isRange() const
+  {
+    return canBeRanged;
+  }
+
   bool isGroup() const
   {
     return canBeGrouped;
@@ -221,6 +240,11 @@ public:
     return isAlwaysAndColumn;
   }
 
+  bool isIndexed() const
+  {
+    return hasIndex;
+  }
+
   QString getSortFuncColAsc() const
   {
     return sortFuncForColAsc;
@@ -258,12 +282,14 @@ private:
   bool groupByMax = false;
   bool groupBySum = false;
   bool canBeFiltered = false;
+  bool canBeRanged = false;
   bool canBeGrouped = false;
   bool canBeSorted = false;
   bool isDefaultColumn = false;
   bool isDefaultSortColumn = false;
   bool isAlwaysAndColumn = false;
   bool isHiddenColumn = false;
+  bool hasIndex = false;
 
   Qt::SortOrder defaultSortOrd = Qt::SortOrder::AscendingOrder;
 };
@@ -16,6 +16,7 @@
 *****************************************************************************/
 
 #include "table/columnlist.h"
+#include "table/querybuilder.h"
 #include "logging/loggingdefs.h"
 
 #include <QLineEdit>
@@ -35,10 +36,10 @@ ColumnList::ColumnList(bool hasAirports)
                         tr("Simulator")).canGroup().canSort().defaultCol().alwaysAnd());
 
   columns.append(Column("startdate", tr("Start Time")).
-                 canSort().defaultCol());
+                 canMin().canMax().canRange().canSort().defaultCol().indexed());
 
   columns.append(Column("airport_from_icao",
-                        tr("From\nICAO")).canFilter().canGroup().canSort().defaultCol().
+                        tr("From\nICAO")).canFilter().canGroup().canSort().defaultCol().indexed().
                  sortFunc(nullAtEndsortFunc, nullAtEndSortFuncDesc));
 
   if(hasAirports)
@@ -62,7 +63,7 @@ ColumnList::ColumnList(bool hasAirports)
   }
 
   columns.append(Column("airport_to_icao",
-                        tr("To\nICAO")).canFilter().canGroup().canSort().defaultCol().
+                        tr("To\nICAO")).canFilter().canGroup().canSort().defaultCol().indexed().
                  sortFunc(nullAtEndsortFunc, nullAtEndSortFuncDesc));
 
   if(hasAirports)
@@ -84,7 +85,7 @@ ColumnList::ColumnList(bool hasAirports)
                    sortFunc(nullAtEndsortFunc, nullAtEndSortFuncDesc));
 
     columns.append(Column("distance",
-                          tr("Distance\nNM")).canSum().canSort().defaultCol());
+                          tr("Distance\nNM")).canMax().canSum().canRange().canSort().defaultCol().indexed());
   }
 
   columns.append(Column("description",
@@ -92,20 +93,20 @@ ColumnList::ColumnList(bool hasAirports)
                  sortFunc(nullAtEndsortFunc, nullAtEndSortFuncDesc));
 
   columns.append(Column("total_time",
-                        tr("Total Time\nh:mm")).canSum().canSort().defaultCol());
+                        tr("Total Time\nh:mm")).canMax().canSum().canRange().canSort().defaultCol().indexed());
 
   columns.append(Column("night_time",
-                        tr("Night Time\nh:mm")).canSum().canSort().defaultCol());
+                        tr("Night Time\nh:mm")).canSum().canRange().canSort().defaultCol().indexed());
 
   columns.append(Column("instrument_time",
-                        tr("Instrument\nTime h:mm")).canSum().canSort().defaultCol());
+                        tr("Instrument\nTime h:mm")).canSum().canRange().canSort().defaultCol().indexed());
 
   columns.append(Column("aircraft_reg",
-                        tr("Aircraft\nRegistration")).canFilter().canGroup().canSort().defaultCol().
+                        tr("Aircraft\nRegistration")).canFilter().canGroup().canSort().defaultCol().indexed().
                  sortFunc(nullAtEndsortFunc, nullAtEndSortFuncDesc));
 
   columns.append(Column("aircraft_descr",
-                        tr("Aircraft\nDescription")).canFilter().canGroup().canSort().defaultCol());
+                        tr("Aircraft\nDescription")).canFilter().canGroup().canSort().defaultCol().indexed());
 
   // Do aircraft type sorting by localized type name
   QString aircraftTypeSort = QString(
@@ -127,12 +128,24 @@ ColumnList::ColumnList(bool hasAirports)
 
   columns.append(Column("visits", tr("Visits\nAirport/Landings, ...")).defaultCol());
 
+  // Calendar columns of startdate computed on import. Appended after the original
+  // columns so that the order of saved header states does not change.
+  columns.append(Column("start_year", tr("Year")).canGroup().canSort().defaultCol().indexed());
+  columns.append(Column("start_month", tr("Month")).canGroup().canSort().defaultCol().indexed());
+  columns.append(Column("start_week", tr("Week")).canGroup().canSort().defaultCol().indexed());
+  columns.append(Column("start_weekday", tr("Weekday")).canGroup().canSort().defaultCol().indexed());
+
   // Column descriptors for grouped views
+  columns.append(Column("startdate_min", tr("First Flight")).canSort());
+  columns.append(Column("startdate_max", tr("Last Flight")).canSort());
+  columns.append(Column("total_time_max", tr("Longest Flight\nh:mm")).canSort());
+  columns.append(Column("distance_max", tr("Longest\nDistance NM")).canSort());
   columns.append(Column("total_time_sum", tr("Total Time all\nh:mm")).canSort());
   columns.append(Column("night_time_sum", tr("Night Time all\nh:mm")).canSort());
   columns.append(Column("instrument_time_sum", tr("Instrument\nTime all h:mm")).canSort());
   columns.append(Column("distance_sum", tr("Total Distance\nNM")).canSort());
   columns.append(Column("num_flights", tr("Number of\nFlights")).canSort());
+  columns.append(Column(QueryBuilder::GROUP_LEVEL_COLUMN).hidden());
 
   // Add names to the index
   for(Column& cd : columns)
@@ -16,36 +16,141 @@
 *****************************************************************************/
 
 #include "table/controller.h"
+#include "table/grouptreemodel.h"
 #include "gui/constants.h"
 
+#include "db/connectionpool.h"
 #include "sql/sqldatabase.h"
 #include "sql/sqlquery.h"
 #include "settings/settings.h"
+#include "logging/loggingdefs.h"
 
 #include <QTableView>
+#include <QTreeView>
 #include <QHeaderView>
+#include <QFontMetrics>
 #include <QSettings>
+#include <QSignalBlocker>
 
 using atools::sql::SqlQuery;
 using atools::sql::SqlDatabase;
 
-Controller::Controller(QWidget *parent, atools::sql::SqlDatabase *sqlDb, QTableView *tableView)
-  : parentWidget(parent), db(sqlDb), view(tableView)
+namespace {
+
+/* Row height is font height plus this value */
+const int SECTION_TO_FONT_SIZE = 2;
+
+}
+
+Controller::Controller(QWidget *parent, atools::sql::SqlDatabase *sqlDb, ConnectionPool *connectionPool,
+                       QTableView *tableView)
+  : parentWidget(parent), db(sqlDb), pool(connectionPool), view(tableView)
 {
+  connect(view->horizontalHeader(), &QHeaderView::sectionResized, this, &Controller::sectionResized);
 }
 
 Controller::~Controller()
 {
   if(!isGrouped())
     saveViewState();
+  clearGroupTree();
   delete columns;
 }
 
+void Controller::setGroupTreeView(QTreeView *groupTreeView)
+{
+  treeView = groupTreeView;
+  treeView->hide();
+
+  // Release the flights of a group when it is collapsed
+  /* *INDENT-OFF* */
+  connect(treeView, &QTreeView::collapsed, this, [=](const QModelIndex& index) {
+    if(treeModel != nullptr)
+      treeModel->releaseChildren(index);
+  });
+  /* *INDENT-ON* */
+}
+
+QItemSelectionModel *Controller::getSelectionModel() const
+{
+  if(treeModel != nullptr)
+    return treeView->selectionModel();
+  else
+    return view->selectionModel();
+}
+
+void Controller::updateGroupTree()
+{
+  if(treeView == nullptr)
+    return;
+
+  clearGroupTree();
+
+  // Rollup views have their subtotals in the table view
+  bool showTree = model != nullptr && model->isGrouped() && !model->getQueryBuilder().isRollup();
+  if(showTree)
+  {
+    treeModel = new GroupTreeModel(parentWidget, db, model);
+    treeView->setModel(treeModel);
+    treeView->setFont(view->font());
+
+    {
+      // Show the sort order of the model without sorting again
+      QSignalBlocker blocker(treeView->header());
+      treeView->header()->setSortIndicator(view->horizontalHeader()->sortIndicatorSection(),
+                                           view->horizontalHeader()->sortIndicatorOrder());
+    }
+
+    for(int i = 0; i < treeModel->columnCount(); ++i)
+      treeView->resizeColumnToContents(i);
+
+    connect(treeView->selectionModel(), &QItemSelectionModel::selectionChanged,
+            this, &Controller::groupTreeSelectionChanged);
+  }
+
+  treeView->setVisible(showTree);
+  view->setVisible(!showTree);
+}
+
+void Controller::clearGroupTree()
+{
+  if(treeView == nullptr || treeModel == nullptr)
+    return;
+
+  QItemSelectionModel *m = treeView->selectionModel();
+  treeView->setModel(nullptr);
+  delete m;
+
+  delete treeModel;
+  treeModel = nullptr;
+
+  treeView->hide();
+  view->show();
+}
+
+void Controller::setTableViewFontSize(QTableView *tableView, int pointSize)
+{
+  QFont newFont(tableView->font());
+  newFont.setPointSize(pointSize);
+
+  int newFontHeight = QFontMetrics(newFont).height();
+
+  qDebug() << "new font height" << newFontHeight << "point size" << newFont.pointSize();
+
+  tableView->setFont(newFont);
+
+  // Adjust the cell height - default is too big
+  tableView->verticalHeader()->setDefaultSectionSize(newFontHeight + SECTION_TO_FONT_SIZE);
+  tableView->verticalHeader()->setMinimumSectionSize(newFontHeight + SECTION_TO_FONT_SIZE);
+}
+
 void Controller::clearModel()
 {
-  if(!isGrouped())
+  if(model != nullptr && !isGrouped())
     saveViewState();
 
+  clearGroupTree();
+
   QItemSelectionModel *m = view->selectionModel();
   view->setModel(nullptr);
   delete m;
@@ -59,6 +164,33 @@ void Controller::clearModel()
   model = nullptr;
 }
 
+SqlDatabase *Controller::getReadDatabase() const
+{
+  return pool->getReadConnection();
+}
+
+void Controller::detachModel()
+{
+  if(model != nullptr)
+    model->detachQuery();
+}
+
+void Controller::applyModelDelta()
+{
+  Q_ASSERT(model != nullptr);
+  model->applyDelta();
+
+  if(treeModel != nullptr)
+    // Loaded flights of expanded groups may have changed
+    updateGroupTree();
+}
+
+bool Controller::canApplyModelDelta(bool hasLogbookTable, bool hasAirportTable) const
+{
+  // Column list depends on the presence of the airport table
+  return model != nullptr && hasLogbookTable && hasLogbook && hasAirportTable == hasAirports;
+}
+
 void Controller::filterIncluding(const QModelIndex& index)
 {
   Q_ASSERT(model != nullptr);
@@ -87,6 +219,12 @@ void Controller::filterByComboBox(const QString& field, int value, bool noFilter
     model->filter(field, value);
 }
 
+void Controller::filterByRange(const QString& field, const QVariant& minValue, const QVariant& maxValue)
+{
+  Q_ASSERT(model != nullptr);
+  model->filterRange(field, minValue, maxValue);
+}
+
 void Controller::filterOperator(bool useAnd)
 {
   Q_ASSERT(model != nullptr);
@@ -112,6 +250,38 @@ void Controller::groupByColumn(const QModelIndex& index)
   processViewColumns();
   // No column order or size stored for grouped views
   view->resizeColumnsToContents();
+  updateGroupTree();
+}
+
+void Controller::addGroupByColumn(const QString& colName)
+{
+  Q_ASSERT(model != nullptr);
+  Q_ASSERT(columns != nullptr);
+  Q_ASSERT(isGrouped());
+
+  // Enable the search widgets of all group by columns
+  QStringList groupCols = model->getGroupByColumns();
+  groupCols << colName << "simulator_id";
+  columns->enableWidgets(true, {"simulator_id"});
+  columns->enableWidgets(false, groupCols);
+
+  model->addGroupByColumn(colName);
+  processViewColumns();
+  view->resizeColumnsToContents();
+  updateGroupTree();
+}
+
+QVector<const Column *> Controller::getSubgroupColumns() const
+{
+  QVector<const Column *> retval;
+  if(model == nullptr || !isGrouped() ||
+     model->getGroupByColumns().size() >= QueryBuilder::MAX_GROUP_LEVELS)
+    return retval;
+
+  for(const Column& col : columns->getColumns())
+    if(col.isGroup() && !col.isHiddenCol() && !model->getGroupByColumns().contains(col.getColumnName()))
+      retval.append(&col);
+  return retval;
 }
 
 void Controller::ungroup()
@@ -123,19 +293,32 @@ void Controller::ungroup()
 
   model->ungroup();
   processViewColumns();
+  updateGroupTree();
 
   if(!isGrouped())
+  {
     restoreViewState();
+    updateCollapsedColumns();
+  }
 }
 
 void Controller::selectAll()
 {
-  Q_ASSERT(view->selectionModel() != nullptr);
-  return view->selectAll();
+  if(treeModel != nullptr)
+    treeView->selectAll();
+  else
+  {
+    Q_ASSERT(view->selectionModel() != nullptr);
+    view->selectAll();
+  }
 }
 
 const QItemSelection Controller::getSelection() const
 {
+  if(treeModel != nullptr)
+    // Only selected groups are exported
+    return treeModel->mapSelectionToSource(treeView->selectionModel()->selection());
+
   Q_ASSERT(view->selectionModel() != nullptr);
   return view->selectionModel()->selection();
 }
@@ -197,9 +380,11 @@ void Controller::resetView()
   model->reset();
 
   processViewColumns();
+  updateGroupTree();
 
   view->resizeColumnsToContents();
   saveViewState();
+  updateCollapsedColumns();
 }
 
 void Controller::resetSearch()
@@ -217,6 +402,18 @@ QString Controller::getCurrentSqlQuery() const
   return model->getCurrentSqlQuery();
 }
 
+QVariantMap Controller::getCurrentQueryBinds() const
+{
+  Q_ASSERT(model != nullptr);
+  return model->getQueryBuilder().getSqlBinds();
+}
+
+QString Controller::getQueryStateDescription() const
+{
+  Q_ASSERT(model != nullptr);
+  return model->getQueryBuilder().getStateDescription();
+}
+
 void Controller::setHasLogbook(bool value)
 {
   hasLogbook = value;
@@ -229,6 +426,10 @@ void Controller::setHasAirports(bool value)
 
 QModelIndex Controller::getModelIndexAt(const QPoint& pos) const
 {
+  if(treeModel != nullptr)
+    // Invalid for flights in the tree
+    return treeModel->mapToSource(treeView->indexAt(pos));
+
   return view->indexAt(pos);
 }
 
@@ -287,7 +488,7 @@ void Controller::prepareModel()
   {
     columns = new ColumnList(hasAirports);
 
-    model = new SqlModel(parentWidget, db, columns, hasAirports);
+    model = new SqlModel(parentWidget, db, pool, columns, hasAirports);
     QItemSelectionModel *m = view->selectionModel();
     view->setModel(model);
     delete m;
@@ -295,7 +496,10 @@ void Controller::prepareModel()
     model->fillHeaderData();
     processViewColumns();
     if(!isGrouped())
+    {
       restoreViewState();
+      updateCollapsedColumns();
+    }
   }
 }
 
@@ -311,16 +515,68 @@ void Controller::assignComboBox(const QString& field, QComboBox *combo)
 
 void Controller::saveViewState() const
 {
+  if(!persistViewState)
+    return;
+
   atools::settings::Settings& s = atools::settings::Settings::instance();
   s->setValue(ll::constants::SETTINGS_TABLE, view->horizontalHeader()->saveState());
+  if(model != nullptr)
+    s->setValue(ll::constants::SETTINGS_TABLE_COLUMNS, model->getRawColumns());
   s.syncSettings();
 }
 
 void Controller::restoreViewState()
 {
+  if(!persistViewState)
+    return;
+
   atools::settings::Settings& s = atools::settings::Settings::instance();
-  if(s->contains(ll::constants::SETTINGS_TABLE))
-    view->horizontalHeader()->restoreState(s->value(ll::constants::SETTINGS_TABLE).toByteArray());
+  if(!s->contains(ll::constants::SETTINGS_TABLE))
+    return;
+
+  // Header state stores sections by index - discard it if it was saved for other columns
+  QStringList savedColumns = s->value(ll::constants::SETTINGS_TABLE_COLUMNS).toStringList();
+  if(model != nullptr && savedColumns != model->getRawColumns())
+  {
+    qInfo() << "Discarding table view state saved for columns" << savedColumns;
+    return;
+  }
+
+  view->horizontalHeader()->restoreState(s->value(ll::constants::SETTINGS_TABLE).toByteArray());
+}
+
+void Controller::updateCollapsedColumns()
+{
+  if(model == nullptr || columns == nullptr || isGrouped())
+    return;
+
+  QSet<QString> collapsed;
+  QSqlRecord rec = model->record();
+  for(int i = 0; i < rec.count(); ++i)
+  {
+    const Column *cd = columns->getColumn(rec.fieldName(i));
+    if(cd != nullptr && !cd->isHiddenCol() && !isColumnVisibleInView(i))
+      collapsed.insert(rec.fieldName(i));
+  }
+  model->setCollapsedColumns(collapsed);
+}
+
+void Controller::sectionResized(int logicalIndex, int oldSize, int newSize)
+{
+  Q_UNUSED(logicalIndex);
+  if(model == nullptr || isGrouped())
+    return;
+
+  // Update only if a column was collapsed or expanded
+  int minSize = view->horizontalHeader()->minimumSectionSize() + 1;
+  if((oldSize > minSize) != (newSize > minSize))
+    updateCollapsedColumns();
+}
+
+void Controller::loadAllColumns()
+{
+  if(model != nullptr)
+    model->setCollapsedColumns(QSet<QString>());
 }
 
 void Controller::loadAllRows()
@@ -358,8 +614,7 @@ QVector<const Column *> Controller::getCurrentColumns() const
 
 QString Controller::formatModelData(const QString& col, const QVariant& var) const
 {
-  Q_ASSERT(model != nullptr);
-  return model->formatValue(col, var);
+  return SqlModel::formatValue(col, var);
 }
 
 QVariantList Controller::getFormattedModelData(int row) const
@@ -18,6 +18,7 @@
 #ifndef LITTLELOGBOOK_CONTROLLER_H
 #define LITTLELOGBOOK_CONTROLLER_H
 
+#include "export/exportsource.h"
 #include "table/columnlist.h"
 #include "table/sqlmodel.h"
 
@@ -31,8 +32,11 @@ class SqlDatabase;
 }
 }
 
+class ConnectionPool;
+class GroupTreeModel;
 class QWidget;
 class QTableView;
+class QTreeView;
 class QModelIndex;
 class QPoint;
 class Column;
@@ -42,7 +46,7 @@ class Column;
  * more.
  */
 class Controller :
-  public QObject
+  public QObject, public ExportSource
 {
   Q_OBJECT
 
@@ -51,9 +55,31 @@ public:
    * @param hasLogbookEntries true if logbook table is present and populated
    * @param hasAirportTable true if additional airport information is available
    */
-  Controller(QWidget *parent, atools::sql::SqlDatabase *sqlDb, QTableView *view);
+  Controller(QWidget *parent, atools::sql::SqlDatabase *sqlDb, ConnectionPool *connectionPool,
+             QTableView *view);
   virtual ~Controller();
 
+  /* Font size limits for zooming the table view */
+  static const int MIN_FONT_POINT_SIZE = 7;
+  static const int MAX_FONT_POINT_SIZE = 16;
+
+  /* Change font size of the table view and adjust the row height accordingly */
+  static void setTableViewFontSize(QTableView *tableView, int pointSize);
+
+  /* Save column order and sizes to the settings and restore them when a model is
+   * created or grouping is released. Default is true. */
+  void setPersistViewState(bool value)
+  {
+    persistViewState = value;
+  }
+
+  /* Tree view that is shown instead of the table view while the view is grouped by one
+   * column. Groups can be expanded there to show their flights. */
+  void setGroupTreeView(QTreeView *groupTreeView);
+
+  /* Selection model of the view that is currently shown */
+  QItemSelectionModel *getSelectionModel() const;
+
   /* Assign a QLineEdit to a column descriptor */
   void assignLineEdit(const QString& field, QLineEdit *edit);
 
@@ -71,9 +97,27 @@ public:
   /* Delete any SqlModl */
   void clearModel();
 
+  /* Close all open queries before the database is changed but keep model, view and selection */
+  void detachModel();
+
+  /* Insert, remove or update rows in the model after a database change done
+   * after detachModel() */
+  void applyModelDelta();
+
+  /* @return true if there is a model that was created for the same table layout
+   * and can be updated with applyModelDelta() */
+  bool canApplyModelDelta(bool hasLogbookTable, bool hasAirportTable) const;
+
   /* Load all rows into the view */
   void loadAllRows();
 
+  /* Fetch collapsed columns too. Needed before exporting the raw model data.
+   * updateCollapsedColumns() stops fetching them again. */
+  void loadAllColumns();
+
+  /* Pass columns that are collapsed in the view to the model to avoid fetching them */
+  void updateCollapsedColumns();
+
   /* Restore columns ordering, sorting and column widths to default */
   void resetView();
 
@@ -89,6 +133,13 @@ public:
   /* Group by column at the given index */
   void groupByColumn(const QModelIndex& index);
 
+  /* Add a nested group level for the given column to the grouped view */
+  void addGroupByColumn(const QString& colName);
+
+  /* Columns that can be added as a nested group level. Empty if the view is not
+   * grouped or all levels are used. */
+  QVector<const Column *> getSubgroupColumns() const;
+
   /* Release grouping */
   void ungroup();
 
@@ -98,6 +149,9 @@ public:
   /* Set a filter by an index from a combo box */
   void filterByComboBox(const QString& field, int value, bool noFilter);
 
+  /* Set a value range filter from the search bar. Null values leave the range open. */
+  void filterByRange(const QString& field, const QVariant& minValue, const QVariant& maxValue);
+
   /* Use "and" or "or" to combine searches */
   void filterOperator(bool useAnd);
 
@@ -123,21 +177,23 @@ public:
   const Column *getColumn(const QString& colName) const;
 
   /* Get descriptor for column at physical index */
-  const Column *getColumn(int physicalIndex) const;
+  virtual const Column *getColumn(int physicalIndex) const override;
 
   /* Number of rows currently loaded into the table view */
   int getVisibleRowCount() const;
 
   /* Total number of rows returned by the last query */
-  int getTotalRowCount() const;
+  virtual int getTotalRowCount() const override;
 
-  QString getCurrentSqlQuery() const;
+  virtual QString getCurrentSqlQuery() const override;
+  virtual QVariantMap getCurrentQueryBinds() const override;
+  virtual QString getQueryStateDescription() const override;
 
   /* Get all descriptors for currently displayed columns */
   QVector<const Column *> getCurrentColumns() const;
 
   /* Return field data formatted as in the table view */
-  QString formatModelData(const QString& col, const QVariant& var) const;
+  virtual QString formatModelData(const QString& col, const QVariant& var) const override;
   QVariantList getFormattedModelData(int row) const;
 
   /* get values from the database */
@@ -145,41 +201,71 @@ public:
   QStringList getRawModelColumns() const;
 
   /* Column name for sorted column */
-  QString getSortColumn() const;
+  virtual QString getSortColumn() const override;
 
   /* @return true if column at physical index is smaller
    * than minimal size + 1 */
-  bool isColumnVisibleInView(int physicalIndex) const;
+  virtual bool isColumnVisibleInView(int physicalIndex) const override;
 
   /* Get the visual index for the column which is affected
    * by column reordering */
-  int getColumnVisualIndex(int physicalIndex) const;
+  virtual int getColumnVisualIndex(int physicalIndex) const override;
 
   atools::sql::SqlDatabase *getSqlDatabase() const
   {
     return db;
   }
 
+  /* Read-only connection of the calling thread for exports and other
+   * queries that should not use the model connection */
+  virtual atools::sql::SqlDatabase *getReadDatabase() const override;
+
+  ConnectionPool *getConnectionPool() const
+  {
+    return pool;
+  }
+
   /* Select all rows in view */
   void selectAll();
 
+  /* Current model or null if no logbook is loaded */
+  SqlModel *getSqlModel() const
+  {
+    return model;
+  }
+
+signals:
+  /* Selection in the group tree view has changed */
+  void groupTreeSelectionChanged();
+
 private:
   /* Adapt columns to query change */
   void processViewColumns();
 
+  /* Show the group tree view instead of the table view if grouped by one column */
+  void updateGroupTree();
+  void clearGroupTree();
+
   /* Save view state to settings */
   void saveViewState() const;
 
   /* Load view state from settings */
   void restoreViewState();
 
+  /* Update collapsed columns if a column was collapsed or expanded */
+  void sectionResized(int logicalIndex, int oldSize, int newSize);
+
   QWidget *parentWidget = nullptr;
   atools::sql::SqlDatabase *db = nullptr;
+  ConnectionPool *pool = nullptr;
   QTableView *view = nullptr;
+  QTreeView *treeView = nullptr;
   SqlModel *model = nullptr;
+  GroupTreeModel *treeModel = nullptr;
   ColumnList *columns = nullptr;
   bool hasLogbook = false;
   bool hasAirports = false;
+  bool persistViewState = true;
 };
 
 #endif // LITTLELOGBOOK_CONTROLLER_H
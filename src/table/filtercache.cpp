@@ -0,0 +1,278 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "table/filtercache.h"
+
+#include "diag/querystats.h"
+#include "diag/tracer.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "logging/loggingdefs.h"
+
+#include <QSqlDatabase>
+
+#include <algorithm>
+
+using atools::sql::SqlQuery;
+using atools::sql::SqlDatabase;
+
+namespace {
+
+const char *FILTER_TABLE = "logbook_filter";
+
+/* Refine a prefix only if the candidate ids of the shorter prefix are less */
+const int MAX_REFINE_ROWS = 10000;
+
+/* Number of ids in an "in" list or one insert statement */
+const int CHUNK_SIZE = 500;
+const int INSERT_CHUNK_SIZE = 5000;
+
+/* Use the filter table only if it contains less than this part of the rows */
+const int MIN_SELECTIVITY_DIVISOR = 4;
+
+QString joinIds(const QVector<quint64>& ids, int from, int num, const QString& prefix, const QString& suffix)
+{
+  QStringList list;
+  for(int i = from; i < std::min(ids.size(), from + num); i++)
+    list.append(prefix + QString::number(ids.at(i)) + suffix);
+  return list.join(",");
+}
+
+}
+
+FilterCache::FilterCache(SqlDatabase *sqlDb, const QString& tableName)
+  : db(sqlDb), table(tableName)
+{
+}
+
+QString FilterCache::getFilterTable() const
+{
+  return QString("temp.") + FILTER_TABLE;
+}
+
+bool FilterCache::update(const QVector<SelectStatement::Predicate>& predicates, bool orOperator)
+{
+  // Conditions that are always "and" like the simulator match most rows and stay in the
+  // where clause where an index can be used
+  QVector<SelectStatement::Predicate> userPredicates;
+  for(const SelectStatement::Predicate& predicate : predicates)
+    if(!predicate.alwaysAnd)
+      userPredicates.append(predicate);
+
+  if(userPredicates.isEmpty())
+    return false;
+
+  TraceSpan span("filterCache", "model");
+
+  RowIdBitmap result = evaluate(userPredicates.first());
+  for(int i = 1; i < userPredicates.size(); i++)
+  {
+    if(orOperator)
+      result = result | evaluate(userPredicates.at(i));
+    else
+      result = result & evaluate(userPredicates.at(i));
+  }
+  span.setRows(result.count());
+
+  if(tableRows == -1)
+  {
+    // Row ids are not dense after entries were deleted
+    SqlQuery countQuery(db);
+    countQuery.exec("select count(*) from " + table);
+    tableRows = countQuery.next() ? countQuery.value(0).toLongLong() : 0;
+  }
+
+  if(result.count() * static_cast<qint64>(MIN_SELECTIVITY_DIVISOR) > tableRows)
+  {
+    qDebug() << "Filter matches" << result.count() << "of" << tableRows << "rows - not using filter table";
+    return false;
+  }
+
+  writeFilterTable(result);
+  return true;
+}
+
+void FilterCache::clear()
+{
+  cache.clear();
+  cachedBytes = 0;
+  tableRows = -1;
+  tableFilled = false;
+}
+
+const RowIdBitmap& FilterCache::evaluate(const SelectStatement::Predicate& predicate)
+{
+  QString key = predicate.getKey();
+  auto it = cache.find(key);
+  if(it != cache.end())
+  {
+    it->lastAccess = ++accessTick;
+    return it->ids;
+  }
+
+  Entry entry;
+  const RowIdBitmap *candidates = findPrefix(predicate);
+
+  SelectStatement stmt(table);
+  stmt.addColumn("rowid");
+  stmt.addPredicate(predicate);
+  stmt.addOrder("rowid");
+
+  QueryTimer timer(QueryStats::FILTER);
+  SqlQuery idQuery(db);
+  if(candidates != nullptr)
+  {
+    // Longer prefix can only match a subset of the shorter one
+    QVector<quint64> ids = candidates->toVector();
+    for(int i = 0; i < ids.size(); i += CHUNK_SIZE)
+    {
+      SelectStatement::Predicate idPredicate;
+      idPredicate.column = "rowid";
+      idPredicate.op = SelectStatement::IN_LIST;
+      QVariantList idList;
+      for(int j = i; j < std::min(ids.size(), i + CHUNK_SIZE); j++)
+        idList.append(static_cast<qulonglong>(ids.at(j)));
+      idPredicate.value = idList;
+
+      SelectStatement refineStmt(stmt);
+      refineStmt.addPredicate(idPredicate);
+      QVariantMap binds;
+      idQuery.prepare(refineStmt.toSql(binds));
+      SelectStatement::bindValues(idQuery, binds);
+      idQuery.exec();
+      while(timer.next(idQuery))
+        entry.ids.append(idQuery.value(0).toULongLong());
+    }
+  }
+  else
+  {
+    QVariantMap binds;
+    QString sql = stmt.toSql(binds);
+    timer.setQueryInfo(db, sql, key, binds);
+    idQuery.prepare(sql);
+    SelectStatement::bindValues(idQuery, binds);
+    idQuery.exec();
+    while(timer.next(idQuery))
+      entry.ids.append(idQuery.value(0).toULongLong());
+  }
+  timer.pause();
+
+  qDebug() << "Filter" << key << "matches" << entry.ids.count() << "rows"
+           << (candidates != nullptr ? "refined" : "");
+
+  entry.lastAccess = ++accessTick;
+  cachedBytes += entry.ids.getBytes();
+  cache.insert(key, entry);
+  enforceLimit(key);
+  return cache[key].ids;
+}
+
+const RowIdBitmap *FilterCache::findPrefix(const SelectStatement::Predicate& predicate)
+{
+  if(predicate.op != SelectStatement::LIKE || predicate.value.type() != QVariant::String)
+    return nullptr;
+
+  // Only patterns without wildcards except at the end
+  QString pattern = predicate.value.toString();
+  bool hasWildcard = pattern.endsWith("%");
+  if(hasWildcard)
+    pattern.chop(1);
+  if(pattern.contains("%") || pattern.contains("_"))
+    return nullptr;
+
+  // Use the longest cached prefix
+  SelectStatement::Predicate prefix(predicate);
+  for(int len = pattern.size() - (hasWildcard ? 1 : 0); len > 0; len--)
+  {
+    prefix.value = pattern.left(len) + "%";
+    auto it = cache.find(prefix.getKey());
+    if(it != cache.end())
+    {
+      if(it->ids.count() > MAX_REFINE_ROWS)
+        return nullptr;
+
+      it->lastAccess = ++accessTick;
+      return &it->ids;
+    }
+  }
+  return nullptr;
+}
+
+void FilterCache::writeFilterTable(const RowIdBitmap& ids)
+{
+  // Typing a character often gives the same result
+  if(tableFilled && ids == tableIds)
+  {
+    qDebug() << "Filter table unchanged";
+    return;
+  }
+
+  QueryTimer timer(QueryStats::FILTER);
+  if(!tableCreated)
+  {
+    SqlQuery(db).exec(QString("create temp table if not exists ") + FILTER_TABLE +
+                      " (id integer primary key)");
+    tableCreated = true;
+  }
+
+  QSqlDatabase qdb = db->getQSqlDatabase();
+  bool transaction = qdb.transaction();
+  QVector<quint64> idList = ids.toVector();
+  try
+  {
+    SqlQuery(db).exec("delete from " + getFilterTable());
+
+    for(int i = 0; i < idList.size(); i += INSERT_CHUNK_SIZE)
+      SqlQuery(db).exec("insert into " + getFilterTable() + " (id) values " +
+                        joinIds(idList, i, INSERT_CHUNK_SIZE, "(", ")"));
+  }
+  catch(...)
+  {
+    tableFilled = false;
+    if(transaction)
+      qdb.rollback();
+    throw;
+  }
+
+  if(transaction)
+    qdb.commit();
+
+  timer.addRows(idList.size());
+  tableIds = ids;
+  tableFilled = true;
+}
+
+void FilterCache::enforceLimit(const QString& keepKey)
+{
+  if(limitBytes <= 0)
+    return;
+
+  while(cachedBytes > limitBytes)
+  {
+    // Find the least recently used bitmap
+    auto oldest = cache.end();
+    for(auto it = cache.begin(); it != cache.end(); ++it)
+      if(it.key() != keepKey && (oldest == cache.end() || it->lastAccess < oldest->lastAccess))
+        oldest = it;
+
+    if(oldest == cache.end())
+      break;
+
+    cachedBytes -= oldest->ids.getBytes();
+    cache.erase(oldest);
+  }
+}
@@ -0,0 +1,105 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_FILTERCACHE_H
+#define LITTLELOGBOOK_FILTERCACHE_H
+
+#include "table/rowidbitmap.h"
+#include "table/selectstatement.h"
+
+#include <QHash>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+}
+
+/*
+ * Keeps the ids of the rows matching each filter condition as compressed
+ * bitmaps keyed by column, operator and value. Only conditions that are not
+ * cached yet are evaluated by SQL and the bitmaps are combined by "and" or "or".
+ * A "like" prefix that was extended by typing is evaluated only against the ids
+ * of the cached shorter prefix.
+ *
+ * The combined result is written into a temporary table of the model connection
+ * which is used by the view query instead of the conditions.
+ *
+ * Cached ids are outdated after the database was changed and have to be cleared.
+ * SQL errors throw exceptions.
+ */
+class FilterCache
+{
+public:
+  FilterCache(atools::sql::SqlDatabase *sqlDb, const QString& tableName);
+
+  /* Evaluate all conditions that are not alwaysAnd and fill the filter table. The table
+   * is not written again if the result did not change.
+   * @return true if the filter table should be used. Filters that match a large
+   * part of the table are faster as a plain where clause. */
+  bool update(const QVector<SelectStatement::Predicate>& predicates, bool orOperator);
+
+  /* Remove all cached ids */
+  void clear();
+
+  /* Least recently used bitmaps are removed if this is exceeded */
+  void setLimitBytes(qint64 value)
+  {
+    limitBytes = value;
+  }
+
+  /* Estimated size of all cached bitmaps */
+  qint64 getBytes() const
+  {
+    return cachedBytes;
+  }
+
+  /* Temporary table holding the ids of the combined filter */
+  QString getFilterTable() const;
+
+private:
+  struct Entry
+  {
+    RowIdBitmap ids;
+    quint32 lastAccess = 0;
+  };
+
+  /* Get ids for predicate from the cache or the database */
+  const RowIdBitmap& evaluate(const SelectStatement::Predicate& predicate);
+
+  /* Get cached ids of a shorter "like" prefix of predicate if any */
+  const RowIdBitmap *findPrefix(const SelectStatement::Predicate& predicate);
+
+  /* Replace the content of the filter table */
+  void writeFilterTable(const RowIdBitmap& ids);
+
+  void enforceLimit(const QString& keepKey);
+
+  atools::sql::SqlDatabase *db;
+  QString table;
+  QHash<QString, Entry> cache;
+  quint32 accessTick = 0;
+  qint64 cachedBytes = 0, limitBytes = 0;
+
+  /* Number of rows in table - used to estimate the selectivity of a filter. -1 if unknown. */
+  qint64 tableRows = -1;
+
+  bool tableCreated = false, tableFilled = false;
+  RowIdBitmap tableIds;
+};
+
+#endif // LITTLELOGBOOK_FILTERCACHE_H
@@ -107,4 +107,23 @@ QString formatDateLong(int timeT)
     return QObject::tr("Invalid date");
 }
 
+QString formatMonth(int yearMonth)
+{
+  QDate date(yearMonth / 100, yearMonth % 100, 1);
+  if(date.isValid())
+    return QLocale().toString(date, "MMM yyyy");
+  else
+    return QObject::tr("Invalid date");
+}
+
+QString formatWeek(int yearWeek)
+{
+  return QString(QObject::tr("%1-W%2")).arg(yearWeek / 100).arg(yearWeek % 100, 2, 10, QChar('0'));
+}
+
+QString formatWeekday(int dayOfWeek)
+{
+  return QLocale().dayName(dayOfWeek);
+}
+
 } // namespace formatter
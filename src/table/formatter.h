@@ -29,6 +29,15 @@ QString formatDate(int timeT);
 /* Format time_t to long locale dependent date string */
 QString formatDateLong(int timeT);
 
+/* Format a month in yyyymm representation to a short locale dependent month and year */
+QString formatMonth(int yearMonth);
+
+/* Format an ISO week in yyyyww representation to yyyy-Www */
+QString formatWeek(int yearWeek);
+
+/* Format a day of week (1 = Monday) to the locale dependent day name */
+QString formatWeekday(int dayOfWeek);
+
 /* Format a decimal time in hours to h:mm format */
 QString formatMinutesHours(double time);
 
@@ -0,0 +1,126 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "table/grouprollup.h"
+
+GroupRollup::GroupRollup(const QStringList& resultColumns, int numLevels, const QString& levelColumn)
+  : levels(numLevels), levelIndex(resultColumns.indexOf(levelColumn))
+{
+  for(const QString& col : resultColumns)
+  {
+    if(col.endsWith("_min"))
+      aggregates.append(MIN);
+    else if(col.endsWith("_max"))
+      aggregates.append(MAX);
+    else if(col.endsWith("_sum") || col == "num_flights")
+      aggregates.append(SUM);
+    else
+      aggregates.append(NONE);
+  }
+
+  for(int i = 0; i < levels; ++i)
+    totals.append(QVariantList());
+}
+
+void GroupRollup::addRow(const QVariantList& row, QVector<QVariantList>& result)
+{
+  if(!lastRow.isEmpty())
+  {
+    // Find the first group column that changed - all deeper levels are complete
+    int changed = 0;
+    while(changed < levels - 1 && row.at(changed) == lastRow.at(changed))
+      changed++;
+
+    for(int level = levels - 1; level > changed; level--)
+      closeLevel(level, result);
+  }
+
+  for(int level = 0; level < levels; level++)
+  {
+    QVariantList& total = totals[level];
+    if(total.isEmpty())
+    {
+      // First row of this group - take the group values of the levels above
+      for(int col = 0; col < row.size(); ++col)
+      {
+        if(col < level || aggregates.at(col) != NONE)
+          total.append(row.at(col));
+        else
+          total.append(QVariant());
+      }
+      if(levelIndex != -1)
+        total[levelIndex] = level;
+    }
+    else
+    {
+      for(int col = 0; col < row.size(); ++col)
+        if(aggregates.at(col) != NONE)
+          total[col] = combine(aggregates.at(col), total.at(col), row.at(col));
+    }
+  }
+
+  result.append(row);
+  lastRow = row;
+}
+
+void GroupRollup::finish(QVector<QVariantList>& result)
+{
+  if(lastRow.isEmpty())
+    return;
+
+  for(int level = levels - 1; level >= 0; level--)
+    closeLevel(level, result);
+  lastRow.clear();
+}
+
+void GroupRollup::closeLevel(int level, QVector<QVariantList>& result)
+{
+  if(!totals.at(level).isEmpty())
+  {
+    result.append(totals.at(level));
+    totals[level].clear();
+    numSubtotals++;
+  }
+}
+
+QVariant GroupRollup::combine(Aggregate aggregate, const QVariant& total, const QVariant& value)
+{
+  if(value.isNull())
+    return total;
+  if(total.isNull())
+    return value;
+
+  switch(aggregate)
+  {
+    case MIN:
+      return value.toDouble() < total.toDouble() ? value : total;
+
+    case MAX:
+      return value.toDouble() > total.toDouble() ? value : total;
+
+    case SUM:
+      if((value.type() == QVariant::Int || value.type() == QVariant::LongLong) &&
+         (total.type() == QVariant::Int || total.type() == QVariant::LongLong))
+        return total.toLongLong() + value.toLongLong();
+      else
+        return total.toDouble() + value.toDouble();
+
+    case NONE:
+      break;
+  }
+  return total;
+}
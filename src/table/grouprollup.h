@@ -0,0 +1,84 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_GROUPROLLUP_H
+#define LITTLELOGBOOK_GROUPROLLUP_H
+
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+/*
+ * Adds subtotal rows like SQL "group by rollup" to the rows of a query that is
+ * grouped by several columns. Rows have to be ordered by the group columns in
+ * group order. Subtotals of all levels are calculated in one pass over these rows.
+ *
+ * The group columns are the first columns of each row. Aggregates are detected by
+ * their alias: "_min", "_max" and "_sum" suffixes and "num_flights" which is summed up.
+ * All other columns are null in subtotal rows.
+ *
+ * The level column contains the number of group columns that are set: the number
+ * of levels for normal rows, lower values for subtotals and 0 for the grand total.
+ */
+class GroupRollup
+{
+public:
+  /*
+   * @param resultColumns Column names or aliases of the query rows
+   * @param numLevels Number of group columns at the start of each row
+   * @param levelColumn Name of the column receiving the level
+   */
+  GroupRollup(const QStringList& resultColumns, int numLevels, const QString& levelColumn);
+
+  /* Add a row and append it to result. Subtotals of groups that are completed by
+   * this row are appended before it. */
+  void addRow(const QVariantList& row, QVector<QVariantList>& result);
+
+  /* Append all remaining subtotals and the grand total to result */
+  void finish(QVector<QVariantList>& result);
+
+  /* Number of subtotal rows created so far */
+  int getNumSubtotals() const
+  {
+    return numSubtotals;
+  }
+
+private:
+  enum Aggregate
+  {
+    NONE,
+    MIN,
+    MAX,
+    SUM
+  };
+
+  /* Combine two aggregated values. Null values are ignored like SQL does. */
+  static QVariant combine(Aggregate aggregate, const QVariant& total, const QVariant& value);
+
+  /* Append subtotal row for level and reset it */
+  void closeLevel(int level, QVector<QVariantList>& result);
+
+  QVector<Aggregate> aggregates;
+  int levels, levelIndex;
+
+  /* Running totals for each level. Index 0 is the grand total. */
+  QVector<QVariantList> totals;
+  QVariantList lastRow;
+  int numSubtotals = 0;
+};
+
+#endif // LITTLELOGBOOK_GROUPROLLUP_H
@@ -0,0 +1,402 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "table/grouptreemodel.h"
+#include "diag/querystats.h"
+#include "gui/errorhandler.h"
+#include "table/columnlist.h"
+#include "table/sqlmodel.h"
+#include "table/selectstatement.h"
+#include "sql/sqldatabase.h"
+#include "logging/loggingdefs.h"
+
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QSqlRecord>
+
+GroupTreeModel::GroupTreeModel(QWidget *parent, atools::sql::SqlDatabase *sqlDb, SqlModel *groupModel)
+  : QAbstractItemModel(parent), parentWidget(parent), db(sqlDb), source(groupModel)
+{
+  Q_ASSERT(source->isGrouped() && !source->getQueryBuilder().isRollup());
+  updateChildColumns();
+
+  /* *INDENT-OFF* */
+  connect(source, &SqlModel::modelAboutToBeReset, this, [=]() { beginResetModel(); });
+  connect(source, &SqlModel::modelReset, this, [=]()
+  {
+    clearNodes();
+    updateChildColumns();
+    endResetModel();
+  });
+  /* *INDENT-ON* */
+
+  connect(source, &SqlModel::rowsAboutToBeInserted, this, &GroupTreeModel::sourceRowsAboutToBeInserted);
+  connect(source, &SqlModel::rowsInserted, this, &GroupTreeModel::sourceRowsInserted);
+  connect(source, &SqlModel::rowsAboutToBeRemoved, this, &GroupTreeModel::sourceRowsAboutToBeRemoved);
+  connect(source, &SqlModel::rowsRemoved, this, &GroupTreeModel::sourceRowsRemoved);
+  connect(source, &SqlModel::dataChanged, this, &GroupTreeModel::sourceDataChanged);
+  connect(source, &SqlModel::headerDataChanged, this, &GroupTreeModel::headerDataChanged);
+}
+
+GroupTreeModel::~GroupTreeModel()
+{
+  clearNodes();
+}
+
+void GroupTreeModel::clearNodes()
+{
+  qDeleteAll(nodes);
+  nodes.clear();
+}
+
+void GroupTreeModel::updateChildColumns()
+{
+  childColumns.clear();
+  groupColumn = source->getGroupByColumn();
+
+  const QSqlRecord rec = source->record();
+  groupColIndex = rec.indexOf(groupColumn);
+  for(int i = 0; i < rec.count(); ++i)
+  {
+    QString name = rec.fieldName(i);
+    if(name.endsWith("_min") || name.endsWith("_max") || name.endsWith("_sum"))
+      // Aggregate - show the value of the flight
+      name.chop(4);
+    else if(name == "num_flights")
+      name.clear();
+    childColumns.append(name);
+  }
+}
+
+GroupTreeModel::GroupNode *GroupTreeModel::findNode(int row) const
+{
+  // Only a few groups are expanded at the same time
+  for(GroupNode *node : nodes)
+    if(node->row == row)
+      return node;
+  return nullptr;
+}
+
+void GroupTreeModel::releaseChildren(const QModelIndex& parent)
+{
+  if(!parent.isValid() || parent.internalPointer() != nullptr)
+    return;
+
+  GroupNode *node = findNode(parent.row());
+  if(node == nullptr)
+    return;
+
+  if(!node->rows.isEmpty())
+  {
+    beginRemoveRows(parent, 0, node->rows.size() - 1);
+    node->rows.clear();
+    endRemoveRows();
+  }
+  nodes.removeOne(node);
+  delete node;
+}
+
+QModelIndex GroupTreeModel::mapToSource(const QModelIndex& index) const
+{
+  if(!index.isValid() || index.internalPointer() != nullptr)
+    return QModelIndex();
+
+  return source->index(index.row(), index.column());
+}
+
+QItemSelection GroupTreeModel::mapSelectionToSource(const QItemSelection& selection) const
+{
+  QItemSelection retval;
+  for(const QItemSelectionRange& range : selection)
+    if(!range.parent().isValid())
+      retval.select(source->index(range.top(), range.left()), source->index(range.bottom(), range.right()));
+  return retval;
+}
+
+int GroupTreeModel::getNumLoadedChildren() const
+{
+  int num = 0;
+  for(const GroupNode *node : nodes)
+    num += node->rows.size();
+  return num;
+}
+
+QModelIndex GroupTreeModel::index(int row, int column, const QModelIndex& parent) const
+{
+  if(!hasIndex(row, column, parent))
+    return QModelIndex();
+
+  if(!parent.isValid())
+    // Group
+    return createIndex(row, column);
+
+  if(parent.internalPointer() == nullptr)
+  {
+    // Flight - the node is needed to find the parent
+    GroupNode *node = findNode(parent.row());
+    if(node != nullptr)
+      return createIndex(row, column, node);
+  }
+  return QModelIndex();
+}
+
+QModelIndex GroupTreeModel::parent(const QModelIndex& child) const
+{
+  if(!child.isValid() || child.internalPointer() == nullptr)
+    return QModelIndex();
+
+  const GroupNode *node = static_cast<const GroupNode *>(child.internalPointer());
+  return createIndex(node->row, 0);
+}
+
+int GroupTreeModel::rowCount(const QModelIndex& parent) const
+{
+  if(!parent.isValid())
+    return source->rowCount();
+
+  if(parent.internalPointer() == nullptr && parent.column() == 0)
+  {
+    const GroupNode *node = findNode(parent.row());
+    return node != nullptr ? node->rows.size() : 0;
+  }
+  return 0;
+}
+
+int GroupTreeModel::columnCount(const QModelIndex& parent) const
+{
+  Q_UNUSED(parent);
+  return source->columnCount();
+}
+
+bool GroupTreeModel::hasChildren(const QModelIndex& parent) const
+{
+  if(!parent.isValid())
+    return source->rowCount() > 0;
+
+  // Each group has at least one flight
+  return parent.internalPointer() == nullptr && parent.column() == 0;
+}
+
+QVariant GroupTreeModel::data(const QModelIndex& index, int role) const
+{
+  if(!index.isValid())
+    return QVariant();
+
+  if(index.internalPointer() == nullptr)
+    return mapToSource(index).data(role);
+
+  const GroupNode *node = static_cast<const GroupNode *>(index.internalPointer());
+  if(role == Qt::DisplayRole)
+  {
+    if(childColumns.at(index.column()).isEmpty())
+      return QVariant();
+
+    // Use the column name of the grouped view to get the same format as the aggregate
+    return SqlModel::formatValue(source->record().fieldName(index.column()),
+                                 node->rows.at(index.row()).at(index.column()));
+  }
+  else if(role == Qt::TextAlignmentRole)
+    return source->index(node->row, index.column()).data(role);
+
+  return QVariant();
+}
+
+QVariant GroupTreeModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  return source->headerData(section, orientation, role);
+}
+
+bool GroupTreeModel::canFetchMore(const QModelIndex& parent) const
+{
+  if(!parent.isValid())
+    return source->canFetchMore(QModelIndex());
+
+  if(parent.internalPointer() != nullptr || parent.column() != 0)
+    return false;
+
+  const GroupNode *node = findNode(parent.row());
+  return node == nullptr || !node->atEnd;
+}
+
+void GroupTreeModel::fetchMore(const QModelIndex& parent)
+{
+  if(!parent.isValid())
+  {
+    // Groups are inserted by the source model signals
+    source->fetchMore(QModelIndex());
+    return;
+  }
+
+  if(!canFetchMore(parent))
+    return;
+
+  GroupNode *node = findNode(parent.row());
+  if(node == nullptr)
+  {
+    node = new GroupNode;
+    node->row = parent.row();
+    node->groupValue = source->getRawData(parent.row()).value(groupColIndex);
+    nodes.append(node);
+  }
+
+  QVector<QVariantList> children = readChildren(node);
+  if(!children.isEmpty())
+  {
+    beginInsertRows(parent, node->rows.size(), node->rows.size() + children.size() - 1);
+    node->rows += children;
+    endInsertRows();
+  }
+}
+
+QVector<QVariantList> GroupTreeModel::readChildren(GroupNode *node)
+{
+  const QueryBuilder& query = source->getQueryBuilder();
+
+  SelectStatement stmt(query.getTableName());
+  for(const QString& col : childColumns)
+    stmt.addColumn(col.isEmpty() ? QString("null") : col);
+  stmt.addColumn("rowid");
+
+  // Same filter as the groups
+  for(const SelectStatement::Predicate& predicate : query.getPredicates())
+    stmt.addPredicate(predicate);
+  stmt.setOrOperator(query.getWhereOperator() == "or");
+
+  SelectStatement::Predicate groupPredicate;
+  groupPredicate.column = groupColumn;
+  groupPredicate.op = node->groupValue.isNull() ? SelectStatement::IS_NULL : SelectStatement::EQUAL;
+  groupPredicate.value = node->groupValue;
+  groupPredicate.alwaysAnd = true;
+  stmt.addPredicate(groupPredicate);
+
+  // Text columns have nocase indexes only which cannot be used by a binary "=".
+  // Seek using nocase and keep the binary "=" above to drop values differing in case.
+  const Column *col = query.getColumnList()->getColumn(groupColumn);
+  if(col != nullptr && col->isIndexed() && node->groupValue.type() == QVariant::String)
+  {
+    SelectStatement::Predicate seekPredicate(groupPredicate);
+    seekPredicate.op = SelectStatement::EQUAL_NOCASE;
+    seekPredicate.indexed = true;
+    stmt.addPredicate(seekPredicate);
+  }
+
+  if(node->lastId != -1)
+  {
+    // Continue after the last loaded flight - no offset needed
+    SelectStatement::Predicate keyPredicate;
+    keyPredicate.column = "rowid";
+    keyPredicate.op = SelectStatement::GREATER;
+    keyPredicate.value = node->lastId;
+    keyPredicate.alwaysAnd = true;
+    keyPredicate.indexed = true;
+    stmt.addPredicate(keyPredicate);
+  }
+  stmt.addOrder("rowid");
+  stmt.setLimit(SqlModel::FETCH_SIZE);
+
+  QVariantMap binds;
+  QString sql = stmt.toSql(binds);
+
+  QVector<QVariantList> result;
+  QueryTimer timer(QueryStats::PAGE_FETCH);
+  timer.setQueryInfo(db, sql, query.getStateDescription(), binds);
+
+  QSqlQuery childQuery(db->getQSqlDatabase());
+  childQuery.setForwardOnly(true);
+  childQuery.prepare(sql);
+  SelectStatement::bindValues(childQuery, binds);
+  if(!childQuery.exec())
+  {
+    timer.pause();
+    node->atEnd = true;
+    atools::gui::ErrorHandler(parentWidget).handleSqlError(childQuery.lastError());
+    return result;
+  }
+
+  int cnt = childColumns.size();
+  while(timer.next(childQuery))
+  {
+    QVariantList row;
+    row.reserve(cnt);
+    for(int i = 0; i < cnt; ++i)
+      row.append(childQuery.value(i));
+    node->lastId = childQuery.value(cnt).toLongLong();
+    result.append(row);
+  }
+  timer.addStatementCounters(childQuery);
+  timer.pause();
+  childQuery.finish();
+
+  node->atEnd = result.size() < SqlModel::FETCH_SIZE;
+  qDebug() << "Loaded" << result.size() << "flights for group" << node->groupValue;
+  return result;
+}
+
+void GroupTreeModel::sort(int column, Qt::SortOrder order)
+{
+  // Resets the source model which releases all flights
+  static_cast<QAbstractItemModel *>(source)->sort(column, order);
+}
+
+void GroupTreeModel::sourceRowsAboutToBeInserted(const QModelIndex& parent, int first, int last)
+{
+  Q_UNUSED(parent);
+  beginInsertRows(QModelIndex(), first, last);
+}
+
+void GroupTreeModel::sourceRowsInserted(const QModelIndex& parent, int first, int last)
+{
+  Q_UNUSED(parent);
+  for(GroupNode *node : nodes)
+    if(node->row >= first)
+      node->row += last - first + 1;
+  endInsertRows();
+}
+
+void GroupTreeModel::sourceRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last)
+{
+  Q_UNUSED(parent);
+  beginRemoveRows(QModelIndex(), first, last);
+}
+
+void GroupTreeModel::sourceRowsRemoved(const QModelIndex& parent, int first, int last)
+{
+  Q_UNUSED(parent);
+
+  // Flights of removed groups are removed with them - delete nodes after the view is updated
+  QVector<GroupNode *> removed, remaining;
+  for(GroupNode *node : nodes)
+  {
+    if(node->row > last)
+    {
+      node->row -= last - first + 1;
+      remaining.append(node);
+    }
+    else if(node->row >= first)
+      removed.append(node);
+    else
+      remaining.append(node);
+  }
+  nodes = remaining;
+  endRemoveRows();
+  qDeleteAll(removed);
+}
+
+void GroupTreeModel::sourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight)
+{
+  emit dataChanged(index(topLeft.row(), topLeft.column()), index(bottomRight.row(), bottomRight.column()));
+}
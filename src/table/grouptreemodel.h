@@ -0,0 +1,128 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_GROUPTREEMODEL_H
+#define LITTLELOGBOOK_GROUPTREEMODEL_H
+
+#include <QAbstractItemModel>
+#include <QItemSelection>
+#include <QStringList>
+#include <QVector>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+}
+
+class SqlModel;
+class QWidget;
+
+/*
+ * Tree model for views grouped by one column. The top level rows are the groups of
+ * the SqlModel and each group can be expanded in place to show its flights.
+ *
+ * Flights are fetched page by page when the view asks for them using a keyset query
+ * on the group value and the rowid which is answered by an index seek. Flights of a
+ * group are released when it is collapsed and all flights are released if the
+ * groups are queried again.
+ *
+ * Flights are shown in the columns of the grouped view: group and group show columns
+ * get their own values and aggregate columns like "total_time_sum" get the value of
+ * the aggregated column. The flight count is empty.
+ */
+class GroupTreeModel :
+  public QAbstractItemModel
+{
+  Q_OBJECT
+
+public:
+  GroupTreeModel(QWidget *parent, atools::sql::SqlDatabase *sqlDb, SqlModel *groupModel);
+  virtual ~GroupTreeModel();
+
+  /* Remove all loaded flights of the group at parent */
+  void releaseChildren(const QModelIndex& parent);
+
+  /* Index of a group in the SqlModel. Invalid for flights. */
+  QModelIndex mapToSource(const QModelIndex& index) const;
+
+  /* Selected groups as selection of the SqlModel. Flights are ignored. */
+  QItemSelection mapSelectionToSource(const QItemSelection& selection) const;
+
+  /* Number of flights loaded for all expanded groups */
+  int getNumLoadedChildren() const;
+
+  virtual QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+  virtual QModelIndex parent(const QModelIndex& child) const override;
+
+  virtual int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  virtual int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+  virtual bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+
+  virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+  virtual QVariant headerData(int section, Qt::Orientation orientation,
+                              int role = Qt::DisplayRole) const override;
+
+  /* Fetch the next page of groups from the SqlModel or the next page of flights of a group */
+  virtual bool canFetchMore(const QModelIndex& parent) const override;
+  virtual void fetchMore(const QModelIndex& parent) override;
+
+  /* Sort the groups in the SqlModel */
+  virtual void sort(int column, Qt::SortOrder order) override;
+
+private:
+  /* Loaded flights of an expanded group */
+  struct GroupNode
+  {
+    int row; /* Row of the group in the SqlModel */
+    QVariant groupValue;
+    QVector<QVariantList> rows;
+    qint64 lastId = -1; /* rowid of the last loaded flight */
+    bool atEnd = false;
+  };
+
+  /* Node of the group row or nullptr if no flights were loaded */
+  GroupNode *findNode(int row) const;
+
+  /* Read the next page of flights for the group */
+  QVector<QVariantList> readChildren(GroupNode *node);
+
+  /* Map columns of the grouped view to the columns of the logbook table */
+  void updateChildColumns();
+
+  void clearNodes();
+
+  /* Keep groups and nodes in sync with the SqlModel */
+  void sourceRowsAboutToBeInserted(const QModelIndex& parent, int first, int last);
+  void sourceRowsInserted(const QModelIndex& parent, int first, int last);
+  void sourceRowsAboutToBeRemoved(const QModelIndex& parent, int first, int last);
+  void sourceRowsRemoved(const QModelIndex& parent, int first, int last);
+  void sourceDataChanged(const QModelIndex& topLeft, const QModelIndex& bottomRight);
+
+  QWidget *parentWidget;
+  atools::sql::SqlDatabase *db;
+  SqlModel *source;
+
+  QVector<GroupNode *> nodes;
+
+  /* Logbook column for each column of the grouped view or empty if there is none */
+  QStringList childColumns;
+  QString groupColumn;
+  int groupColIndex = -1;
+};
+
+#endif // LITTLELOGBOOK_GROUPTREEMODEL_H
@@ -0,0 +1,106 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "table/pivotmodel.h"
+#include "diag/querystats.h"
+#include "sql/sqlquery.h"
+#include "logging/loggingdefs.h"
+
+#include <QSqlRecord>
+
+using atools::sql::SqlQuery;
+
+PivotModel::PivotModel(QObject *parent, atools::sql::SqlDatabase *sqlDb, const ColumnList *columnList)
+  : QAbstractTableModel(parent), db(sqlDb), query(columnList)
+{
+}
+
+PivotModel::~PivotModel()
+{
+}
+
+void PivotModel::update()
+{
+  beginResetModel();
+  rows.clear();
+
+  try
+  {
+    QueryTimer timer(QueryStats::STATS);
+    query.build(db);
+    timer.setQueryInfo(db, query.getSqlQuery(), query.getStateDescription(), query.getSqlBinds());
+
+    SqlQuery pivotQuery(db);
+    pivotQuery.prepare(query.getSqlQuery());
+    SelectStatement::bindValues(pivotQuery, query.getSqlBinds());
+    pivotQuery.exec();
+
+    int cnt = query.getResultColumnNames().size();
+    while(timer.next(pivotQuery))
+    {
+      QVariantList row;
+      row.reserve(cnt);
+      for(int i = 0; i < cnt; ++i)
+        row.append(pivotQuery.value(i));
+      rows.append(row);
+    }
+    pivotQuery.finish();
+  }
+  catch(...)
+  {
+    endResetModel();
+    throw;
+  }
+  endResetModel();
+}
+
+int PivotModel::rowCount(const QModelIndex& parent) const
+{
+  return parent.isValid() ? 0 : rows.size();
+}
+
+int PivotModel::columnCount(const QModelIndex& parent) const
+{
+  return parent.isValid() || rows.isEmpty() ? 0 : query.getResultColumnNames().size();
+}
+
+QVariant PivotModel::data(const QModelIndex& index, int role) const
+{
+  if(!index.isValid())
+    return QVariant();
+
+  if(role == Qt::DisplayRole)
+    return query.formatValue(query.getResultColumnNames().at(index.column()),
+                             rows.at(index.row()).at(index.column()));
+  else if(role == Qt::TextAlignmentRole)
+  {
+    if(index.column() > 0)
+      return Qt::AlignRight;
+  }
+  return QVariant();
+}
+
+QVariant PivotModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if(orientation == Qt::Horizontal && role == Qt::DisplayRole)
+  {
+    const Column *col = query.getColumn(section);
+    if(col != nullptr)
+      return col->getDisplayName();
+  }
+  return QAbstractTableModel::headerData(section, orientation, role);
+}
@@ -0,0 +1,116 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_PIVOTMODEL_H
+#define LITTLELOGBOOK_PIVOTMODEL_H
+
+#include "export/exportsource.h"
+#include "table/pivotquery.h"
+
+#include <QAbstractTableModel>
+#include <QVector>
+
+/*
+ * Table model for a pivot table. All rows are loaded at once since there is only
+ * one row for each value of the row column.
+ *
+ * Also the export source for the pivot table. Exporters run the same statement
+ * and get the same formatting as the view.
+ */
+class PivotModel :
+  public QAbstractTableModel, public ExportSource
+{
+  Q_OBJECT
+
+public:
+  /* db is used for the model and for exports */
+  PivotModel(QObject *parent, atools::sql::SqlDatabase *sqlDb, const ColumnList *columnList);
+  virtual ~PivotModel();
+
+  /* Query defining rows, columns, measure and filter. Call update() after changes. */
+  PivotQuery& getQuery()
+  {
+    return query;
+  }
+
+  /* Build and run the pivot query and reset the model. Throws an exception on SQL errors. */
+  void update();
+
+  virtual int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  virtual int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+  virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+  virtual QVariant headerData(int section, Qt::Orientation orientation,
+                              int role = Qt::DisplayRole) const override;
+
+  virtual atools::sql::SqlDatabase *getReadDatabase() const override
+  {
+    return db;
+  }
+
+  virtual QString getCurrentSqlQuery() const override
+  {
+    return query.getSqlQuery();
+  }
+
+  virtual QVariantMap getCurrentQueryBinds() const override
+  {
+    return query.getSqlBinds();
+  }
+
+  virtual QString getQueryStateDescription() const override
+  {
+    return query.getStateDescription();
+  }
+
+  virtual int getTotalRowCount() const override
+  {
+    return rows.size();
+  }
+
+  virtual QString formatModelData(const QString& col, const QVariant& var) const override
+  {
+    return query.formatValue(col, var);
+  }
+
+  virtual const Column *getColumn(int physicalIndex) const override
+  {
+    return query.getColumn(physicalIndex);
+  }
+
+  virtual int getColumnVisualIndex(int physicalIndex) const override
+  {
+    return physicalIndex;
+  }
+
+  virtual bool isColumnVisibleInView(int physicalIndex) const override
+  {
+    Q_UNUSED(physicalIndex);
+    return true;
+  }
+
+  virtual QString getSortColumn() const override
+  {
+    return query.getRowColumn();
+  }
+
+private:
+  atools::sql::SqlDatabase *db;
+  PivotQuery query;
+  QVector<QVariantList> rows;
+};
+
+#endif // LITTLELOGBOOK_PIVOTMODEL_H
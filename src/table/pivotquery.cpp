@@ -0,0 +1,145 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "table/pivotquery.h"
+#include "table/columnlist.h"
+#include "table/sqlmodel.h"
+#include "sql/sqlquery.h"
+#include "logging/loggingdefs.h"
+
+#include <QLocale>
+
+using atools::sql::SqlQuery;
+
+const char *PivotQuery::TOTAL_COLUMN = "pivot_total";
+
+PivotQuery::PivotQuery(const ColumnList *columnList, const QString& table)
+  : columns(columnList), tableName(table)
+{
+}
+
+void PivotQuery::setFilter(const QVector<SelectStatement::Predicate>& filterPredicates, bool orOperator)
+{
+  predicates = filterPredicates;
+  orOp = orOperator;
+}
+
+void PivotQuery::build(atools::sql::SqlDatabase *db)
+{
+  Q_ASSERT(columns->getColumn(rowCol) != nullptr && columns->getColumn(rowCol)->isGroup());
+  Q_ASSERT(columns->getColumn(columnCol) != nullptr && columns->getColumn(columnCol)->isGroup());
+
+  // Get all values of the column column using the same filter
+  SelectStatement valueStmt(tableName);
+  valueStmt.addColumn(columnCol);
+  for(const SelectStatement::Predicate& predicate : predicates)
+    valueStmt.addPredicate(predicate);
+  valueStmt.setOrOperator(orOp);
+  valueStmt.setGroupBy({columnCol});
+  valueStmt.addOrder(columnCol);
+  valueStmt.setLimit(MAX_PIVOT_COLUMNS + 1);
+
+  QVariantMap valueBinds;
+  SqlQuery valueQuery(db);
+  valueQuery.prepare(valueStmt.toSql(valueBinds));
+  SelectStatement::bindValues(valueQuery, valueBinds);
+  valueQuery.exec();
+
+  QVariantList values;
+  while(valueQuery.next())
+    values.append(valueQuery.value(0));
+  valueQuery.finish();
+
+  truncated = values.size() > MAX_PIVOT_COLUMNS;
+  if(truncated)
+    values.removeLast();
+
+  // One conditional aggregate for each value - null values cannot be compared by "="
+  QString measureExpr = measure.isEmpty() ? QString("1") : measure;
+  SelectStatement stmt(tableName);
+  stmt.addColumn(rowCol);
+  sqlBinds.clear();
+  resultColumnNames.clear();
+  resultColumnNames.append(rowCol);
+  pivotColumns.clear();
+
+  for(int i = 0; i < values.size(); ++i)
+  {
+    const QVariant& value = values.at(i);
+    QString name = "pivot_" + QString::number(i), condition;
+    if(value.isNull())
+      condition = columnCol + " is null";
+    else
+    {
+      QString bind = ":c" + QString::number(i);
+      sqlBinds.insert(bind, value);
+      condition = columnCol + " = " + bind;
+    }
+    stmt.addColumn("sum(case when " + condition + " then " + measureExpr + " end) as " + name);
+    resultColumnNames.append(name);
+
+    QString displayName = SqlModel::formatValue(columnCol, value);
+    pivotColumns.append(Column(name, displayName.isEmpty() ? QObject::tr("None") : displayName));
+  }
+
+  stmt.addColumn((measure.isEmpty() ? QString("count(*)") : "sum(" + measure + ")") + " as " + TOTAL_COLUMN);
+  resultColumnNames.append(TOTAL_COLUMN);
+  pivotColumns.append(Column(TOTAL_COLUMN, QObject::tr("Total")));
+
+  for(const SelectStatement::Predicate& predicate : predicates)
+    stmt.addPredicate(predicate);
+  stmt.setOrOperator(orOp);
+  stmt.setGroupBy({rowCol});
+  stmt.addOrder(rowCol);
+
+  // Predicates use ":p" binds
+  QVariantMap predicateBinds;
+  sqlQuery = stmt.toSql(predicateBinds);
+  for(auto it = predicateBinds.constBegin(); it != predicateBinds.constEnd(); ++it)
+    sqlBinds.insert(it.key(), it.value());
+
+  qDebug() << "Pivot" << getStateDescription() << "with" << values.size() << "columns";
+}
+
+const Column *PivotQuery::getColumn(int index) const
+{
+  if(index == 0)
+    return columns->getColumn(rowCol);
+  else if(index > 0 && index <= pivotColumns.size())
+    return &pivotColumns.at(index - 1);
+  else
+    return nullptr;
+}
+
+QString PivotQuery::formatValue(const QString& colName, const QVariant& value) const
+{
+  if(colName == rowCol)
+    return SqlModel::formatValue(colName, value);
+  else if(value.isNull())
+    // No flights for this row and column
+    return QString();
+  else if(measure.isEmpty())
+    return QLocale().toString(value.toInt());
+  else
+    return SqlModel::formatValue(measure, value);
+}
+
+QString PivotQuery::getStateDescription() const
+{
+  return "pivot rows: " + rowCol + "; columns: " + columnCol +
+         "; measure: " + (measure.isEmpty() ? QString("count") : measure);
+}
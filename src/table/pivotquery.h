@@ -0,0 +1,138 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_PIVOTQUERY_H
+#define LITTLELOGBOOK_PIVOTQUERY_H
+
+#include "table/colum.h"
+#include "table/selectstatement.h"
+
+#include <QStringList>
+#include <QVariantList>
+#include <QVector>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+}
+
+class ColumnList;
+
+/*
+ * Builds a pivot or crosstab statement for the logbook table. Each row of the
+ * result is a value of the row column and each pivot column is a value of the
+ * column column. Cells contain the number of flights or the sum of a measure
+ * column like "total_time". The last column is the total of the row.
+ *
+ * All cells are aggregated in a single scan over the filtered logbook using
+ * "sum(case when ...)" for each pivot column. The values of the column column are
+ * read before by a separate query. Values are passed as bind variables.
+ */
+class PivotQuery
+{
+public:
+  PivotQuery(const ColumnList *columnList, const QString& table = "logbook");
+
+  /* Columns have to be groupable */
+  void setRowColumn(const QString& colName)
+  {
+    rowCol = colName;
+  }
+
+  QString getRowColumn() const
+  {
+    return rowCol;
+  }
+
+  void setColumnColumn(const QString& colName)
+  {
+    columnCol = colName;
+  }
+
+  QString getColumnColumn() const
+  {
+    return columnCol;
+  }
+
+  /* Column to sum up or empty to count flights */
+  void setMeasure(const QString& colName)
+  {
+    measure = colName;
+  }
+
+  QString getMeasure() const
+  {
+    return measure;
+  }
+
+  /* Filter conditions, e.g. from the QueryBuilder of the table view */
+  void setFilter(const QVector<SelectStatement::Predicate>& filterPredicates, bool orOperator);
+
+  /* Read the values of the column column and create the pivot statement.
+   * Throws an exception on SQL errors. */
+  void build(atools::sql::SqlDatabase *db);
+
+  const QString& getSqlQuery() const
+  {
+    return sqlQuery;
+  }
+
+  const QVariantMap& getSqlBinds() const
+  {
+    return sqlBinds;
+  }
+
+  /* Column names of the result: row column, pivot columns and total */
+  const QStringList& getResultColumnNames() const
+  {
+    return resultColumnNames;
+  }
+
+  /* Descriptor for a column of the result */
+  const Column *getColumn(int index) const;
+
+  /* Format a value of the result as shown in the table view. Empty cells are empty. */
+  QString formatValue(const QString& colName, const QVariant& value) const;
+
+  /* true if there are more values in the column column than MAX_PIVOT_COLUMNS.
+   * Flights having these values are only contained in the total. */
+  bool isTruncated() const
+  {
+    return truncated;
+  }
+
+  /* Row, column and measure for diagnostics */
+  QString getStateDescription() const;
+
+  static const int MAX_PIVOT_COLUMNS = 200;
+  static const char *TOTAL_COLUMN;
+
+private:
+  const ColumnList *columns;
+  QString tableName, rowCol, columnCol, measure, sqlQuery;
+  QVariantMap sqlBinds;
+  QVector<SelectStatement::Predicate> predicates;
+  bool orOp = false, truncated = false;
+
+  QStringList resultColumnNames;
+
+  /* Pivot and total column descriptors - the row column uses the ColumnList */
+  QVector<Column> pivotColumns;
+};
+
+#endif // LITTLELOGBOOK_PIVOTQUERY_H
@@ -0,0 +1,338 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "table/querybuilder.h"
+
+#include "table/columnlist.h"
+#include "gui/constants.h"
+#include "logging/loggingdefs.h"
+
+#include <QDateTime>
+
+const char *QueryBuilder::GROUP_LEVEL_COLUMN = "group_level";
+
+QueryBuilder::QueryBuilder(const ColumnList *columnList, const QString& table)
+  : columns(columnList), tableName(table)
+{
+}
+
+void QueryBuilder::filter(const QString& colName, const QVariant& value)
+{
+  bool colAlreadyFiltered = conditionMap.contains(colName);
+
+  if(value.isNull() || (value.type() == QVariant::String && value.toString().isEmpty()))
+  {
+    // If we get a null value or an empty string and the
+    // column is already filtered remove it
+    if(colAlreadyFiltered)
+      conditionMap.remove(colName);
+  }
+  else
+  {
+    QVariant newVariant;
+    SelectStatement::Operator condition = SelectStatement::EQUAL;
+
+    if(value.type() == QVariant::String)
+    {
+      // Use like queries for string
+      QString newVal = value.toString();
+
+      if(newVal.startsWith(ll::constants::QUERY_NEGATE_CHAR))
+      {
+        if(newVal == ll::constants::QUERY_NEGATE_CHAR)
+        {
+          // A single "-" translates to not nulls
+          condition = SelectStatement::IS_NOT_NULL;
+          newVal.clear();
+        }
+        else
+        {
+          condition = SelectStatement::NOT_LIKE;
+          newVal.remove(0, 1);
+        }
+      }
+      else
+        condition = SelectStatement::LIKE;
+
+      // Replace "*" with "%" for SQL
+      if(newVal.contains(ll::constants::QUERY_PLACEHOLDER_CHAR))
+        newVal = newVal.toUpper().replace(ll::constants::QUERY_PLACEHOLDER_CHAR, "%");
+      else if(!newVal.isEmpty())
+        newVal = newVal.toUpper() + "%";
+
+      if(!newVal.isEmpty())
+        newVariant = newVal;
+    }
+    else if(value.type() == QVariant::Int)
+    {
+      // Use equal for numbers
+      newVariant = value;
+      condition = SelectStatement::EQUAL;
+    }
+    setCondition(colName, condition, newVariant);
+  }
+}
+
+void QueryBuilder::setCondition(const QString& colName, SelectStatement::Operator op, const QVariant& value)
+{
+  const Column *col = columns->getColumn(colName);
+  Q_ASSERT(col != nullptr);
+
+  SelectStatement::Predicate predicate;
+  predicate.column = colName;
+  predicate.op = op;
+  predicate.value = value;
+  predicate.alwaysAnd = col->isAlwaysAndCol();
+  predicate.indexed = col->isIndexed();
+  conditionMap.insert(colName, predicate);
+}
+
+void QueryBuilder::filterRange(const QString& colName, const QVariant& minValue, const QVariant& maxValue)
+{
+  const Column *col = columns->getColumn(colName);
+  Q_ASSERT(col != nullptr);
+  Q_ASSERT(col->isRange());
+
+  if(minValue.isNull() && maxValue.isNull())
+  {
+    rangeMap.remove(colName);
+    return;
+  }
+
+  SelectStatement::Predicate predicate;
+  predicate.column = colName;
+  if(minValue.isNull())
+  {
+    predicate.op = SelectStatement::LESS_EQUAL;
+    predicate.value = maxValue;
+  }
+  else if(maxValue.isNull())
+  {
+    predicate.op = SelectStatement::GREATER_EQUAL;
+    predicate.value = minValue;
+  }
+  else
+  {
+    predicate.op = SelectStatement::BETWEEN;
+    predicate.value = QVariantList({minValue, maxValue});
+  }
+
+  // Ranges narrow down the result of all other conditions
+  predicate.alwaysAnd = true;
+  predicate.indexed = col->isIndexed();
+  rangeMap.insert(colName, predicate);
+}
+
+qint64 QueryBuilder::dateToTimeT(const QDate& date, bool endOfDay)
+{
+  QDateTime dateTime(endOfDay ? date.addDays(1) : date, QTime(0, 0), Qt::UTC);
+  return dateTime.toMSecsSinceEpoch() / 1000 - (endOfDay ? 1 : 0);
+}
+
+void QueryBuilder::clearWhereConditions()
+{
+  // Keep simulator filter - system dependent
+  auto iter = conditionMap.find("simulator_id");
+  if(iter != conditionMap.end())
+  {
+    SelectStatement::Predicate predicate = *iter;
+    conditionMap.clear();
+    conditionMap.insert(predicate.column, predicate);
+  }
+  else
+    conditionMap.clear();
+}
+
+bool QueryBuilder::isColumnProjected(const QString& colName) const
+{
+  if(isGrouped() || !collapsedCols.contains(colName))
+    return true;
+
+  // Aliases take precedence over table columns in order by - keep the real values
+  const Column *col = columns->getColumn(colName);
+  return col == nullptr || col->isHiddenCol() || getKeyColumns().contains(colName) ||
+         colName == orderByCol || conditionMap.contains(colName) || rangeMap.contains(colName);
+}
+
+void QueryBuilder::buildColumnList()
+{
+  QStringList& colNames = columnList;
+  QStringList viewColNames;
+  colNames.clear();
+  resultColumnNames.clear();
+
+  // Group by columns are the first ones in level order
+  for(const QString& groupCol : groupByCols)
+  {
+    colNames.append(groupCol);
+    resultColumnNames.append(groupCol);
+  }
+
+  for(const Column& col : columns->getColumns())
+  {
+    if(groupByCols.isEmpty())
+    {
+      // Not grouping - default view. The group level exists only in rollup views.
+      if((col.isDefaultCol() || col.isHiddenCol()) && col.getColumnName() != GROUP_LEVEL_COLUMN)
+      {
+        colNames.append(col.getColumnName());
+        if(isColumnProjected(col.getColumnName()))
+          viewColNames.append(col.getColumnName());
+        else
+          viewColNames.append("null as " + col.getColumnName());
+        resultColumnNames.append(col.getColumnName());
+      }
+    }
+    else if(groupByCols.contains(col.getColumnName()))
+      continue;
+    else if(col.isGroupShow())
+    {
+      colNames.append(col.getColumnName());
+      resultColumnNames.append(col.getColumnName());
+    }
+    else
+    {
+      // Add all aggregate columns
+      QString cname = col.getColumnName();
+      if(col.isMin())
+      {
+        colNames.append("min(" + cname + ") as " + cname + "_min");
+        resultColumnNames.append(cname + "_min");
+      }
+      if(col.isMax())
+      {
+        colNames.append("max(" + cname + ") as " + cname + "_max");
+        resultColumnNames.append(cname + "_max");
+      }
+      if(col.isSum())
+      {
+        colNames.append("sum(" + cname + ") as " + cname + "_sum");
+        resultColumnNames.append(cname + "_sum");
+      }
+    }
+  }
+
+  if(!groupByCols.isEmpty())
+  {
+    // Always add total count when grouping
+    colNames.append("count(*) as num_flights");
+    resultColumnNames.append("num_flights");
+  }
+
+  if(isRollup())
+  {
+    // Rows from the query are the lowest level - GroupRollup sets the level of subtotals
+    colNames.append(QString::number(groupByCols.size()) + " as " + GROUP_LEVEL_COLUMN);
+    resultColumnNames.append(GROUP_LEVEL_COLUMN);
+  }
+
+  viewColumnList = groupByCols.isEmpty() ? viewColNames : colNames;
+}
+
+void QueryBuilder::addOrder(const QString& colName, bool descending)
+{
+  const Column *col = columns->getColumn(colName);
+  Q_ASSERT(col != nullptr);
+
+  if(!(col->getSortFuncColAsc().isEmpty() && col->getSortFuncColDesc().isEmpty()))
+    // Use sort functions to have null values at end of the list - will avoid indexes
+    statement.addOrder((descending ? col->getSortFuncColDesc() : col->getSortFuncColAsc()).arg(colName),
+                       descending);
+  else
+    statement.addOrder(colName, descending);
+}
+
+QVector<SelectStatement::Predicate> QueryBuilder::getPredicates() const
+{
+  SelectStatement stmt;
+  for(const SelectStatement::Predicate& predicate : conditionMap)
+    stmt.addPredicate(predicate);
+  for(const SelectStatement::Predicate& predicate : rangeMap)
+    stmt.addPredicate(predicate);
+  return stmt.getPredicates();
+}
+
+QString QueryBuilder::getStateDescription() const
+{
+  QStringList conditions;
+  for(const SelectStatement::Predicate& predicate : getPredicates())
+  {
+    QString value = predicate.op == SelectStatement::BETWEEN ?
+                    predicate.value.toList().value(0).toString() + " and " +
+                    predicate.value.toList().value(1).toString() : predicate.value.toString();
+    conditions.append(predicate.column + " " + SelectStatement::operatorSql(predicate.op) + " " + value);
+  }
+
+  return "filter: " + (conditions.isEmpty() ? QString("none") : conditions.join(" " + whereOperator + " ")) +
+         "; group by: " + (groupByCols.isEmpty() ? QString("none") : groupByCols.join(", ")) +
+         "; order by: " + (orderByCol.isEmpty() ? QString("default") : orderByCol + " " + orderByOrder);
+}
+
+void QueryBuilder::build()
+{
+  buildColumnList();
+
+  statement = SelectStatement(tableName);
+  for(const QString& col : columnList)
+    statement.addColumn(col);
+
+  for(const SelectStatement::Predicate& predicate : getPredicates())
+    statement.addPredicate(predicate);
+  statement.setOrOperator(whereOperator == "or");
+  statement.setGroupBy(groupByCols, isRollup());
+
+  Q_ASSERT(orderByOrder.isEmpty() || orderByOrder == "asc" || orderByOrder == "desc");
+  if(isRollup())
+  {
+    // Subtotals need the rows ordered by all group columns - the sort column only changes the direction
+    for(const QString& groupCol : groupByCols)
+      addOrder(groupCol, groupCol == orderByCol && orderByOrder == "desc");
+  }
+  else
+  {
+    if(!orderByCol.isEmpty() && !orderByOrder.isEmpty())
+      addOrder(orderByCol, orderByOrder == "desc");
+
+    // Make the order unique so that rows can be fetched again by offset after database changes
+    for(const QString& keyCol : getKeyColumns())
+      if(orderByCol.isEmpty() || orderByOrder.isEmpty() || orderByCol != keyCol)
+        statement.addOrder(keyCol);
+  }
+
+  // SQLite scans the whole table for "or" over different columns
+  statement.rewriteOrToIndexSeeks("rowid");
+
+  viewStatement = statement;
+  viewStatement.clearColumns();
+  for(const QString& col : viewColumnList)
+    viewStatement.addColumn(col);
+
+  // The view uses the ids of the cached filter results if available
+  viewStatement.rewriteToIdTable("rowid", filterTable);
+
+  sqlBinds.clear();
+  sqlQuery = statement.toSql(sqlBinds);
+  viewBinds.clear();
+  viewQuery = viewStatement.toSql(viewBinds);
+
+  // Build a query to find the total row count of the result
+  countBinds.clear();
+  countQuery = viewStatement.toCountSql(countBinds);
+
+  qDebug() << "Query" << sqlQuery << sqlBinds;
+  qDebug() << "Query Count" << countQuery;
+}
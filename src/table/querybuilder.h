@@ -0,0 +1,288 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_QUERYBUILDER_H
+#define LITTLELOGBOOK_QUERYBUILDER_H
+
+#include "table/selectstatement.h"
+
+#include <QDate>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+class Column;
+class ColumnList;
+
+/*
+ * Builds the select and count statements for the logbook table from filters,
+ * grouping and sort order. Used by SqlModel and by the command line export so
+ * both produce the same results. Does not depend on any widgets.
+ *
+ * The view query selects "null as column" for collapsed columns which keeps the
+ * column layout but avoids reading wide values that are not shown. The full
+ * query is used for exports.
+ *
+ * Statements are built as SelectStatement and all filter values are passed as
+ * bind variables. Queries have to be prepared and the binds applied before
+ * execution.
+ */
+class QueryBuilder
+{
+public:
+  QueryBuilder(const ColumnList *columnList, const QString& table = "logbook");
+
+  /* Add a filter for a column. Strings use "like" with "*" as placeholder and a
+   * leading "-" for negation. A single "-" selects not null values. Integers
+   * use "=". A null value or empty string removes the filter. */
+  void filter(const QString& colName, const QVariant& value);
+
+  /* Add or replace a condition with an explicit operator */
+  void setCondition(const QString& colName, SelectStatement::Operator op, const QVariant& value);
+
+  bool hasCondition(const QString& colName) const
+  {
+    return conditionMap.contains(colName);
+  }
+
+  void removeCondition(const QString& colName)
+  {
+    conditionMap.remove(colName);
+  }
+
+  /* Filter a column by a range of values. Both bounds are inclusive and a null
+   * bound leaves the range open on that side. Two null values remove the range.
+   * Ranges are always combined using "and" and are kept when grouping. */
+  void filterRange(const QString& colName, const QVariant& minValue, const QVariant& maxValue);
+
+  bool hasRange(const QString& colName) const
+  {
+    return rangeMap.contains(colName);
+  }
+
+  /* Remove all conditions except the simulator filter and the value ranges */
+  void clearWhereConditions();
+
+  /* Remove all value ranges */
+  void clearRanges()
+  {
+    rangeMap.clear();
+  }
+
+  /* Convert a date to the time_t representation of the startdate column. Dates are
+   * stored as local time without timezone. endOfDay gives the last second of the day. */
+  static qint64 dateToTimeT(const QDate& date, bool endOfDay = false);
+
+  /* Operator to connect all conditions ("and" or "or") */
+  void setWhereOperator(const QString& op)
+  {
+    whereOperator = op;
+  }
+
+  QString getWhereOperator() const
+  {
+    return whereOperator;
+  }
+
+  /* All filter conditions in canonical order */
+  QVector<SelectStatement::Predicate> getPredicates() const;
+
+  /* Temporary table containing the ids of all rows matching the current filter.
+   * If set the view and count queries use it instead of the conditions. */
+  void setFilterTable(const QString& value)
+  {
+    filterTable = value;
+  }
+
+  QString getFilterTable() const
+  {
+    return filterTable;
+  }
+
+  /* Empty column disables grouping */
+  void setGroupBy(const QString& colName)
+  {
+    groupByCols.clear();
+    if(!colName.isEmpty())
+      groupByCols.append(colName);
+  }
+
+  /* Add a nested group level below the existing ones. Up to MAX_GROUP_LEVELS. */
+  void addGroupBy(const QString& colName)
+  {
+    Q_ASSERT(groupByCols.size() < MAX_GROUP_LEVELS);
+    groupByCols.append(colName);
+  }
+
+  /* First group column or empty if not grouped */
+  QString getGroupBy() const
+  {
+    return groupByCols.value(0);
+  }
+
+  /* All group columns from top to bottom level */
+  const QStringList& getGroupByColumns() const
+  {
+    return groupByCols;
+  }
+
+  bool isGrouped() const
+  {
+    return !groupByCols.isEmpty();
+  }
+
+  /* Grouped by more than one column. The rows are ordered by the group columns and
+   * subtotal rows have to be added using GroupRollup. The result has an additional
+   * GROUP_LEVEL_COLUMN. */
+  bool isRollup() const
+  {
+    return groupByCols.size() > 1;
+  }
+
+  static const int MAX_GROUP_LEVELS = 3;
+  static const char *GROUP_LEVEL_COLUMN;
+
+  /* Order is "asc", "desc" or empty for default order */
+  void setOrderBy(const QString& colName, const QString& order)
+  {
+    orderByCol = colName;
+    orderByOrder = order;
+  }
+
+  QString getOrderByCol() const
+  {
+    return orderByCol;
+  }
+
+  QString getOrderByOrder() const
+  {
+    return orderByOrder;
+  }
+
+  /* Columns that are not shown in the view. The key, hidden, sort, group by and
+   * filtered columns are always selected. */
+  void setCollapsedColumns(const QSet<QString>& colNames)
+  {
+    collapsedCols = colNames;
+  }
+
+  const QSet<QString>& getCollapsedColumns() const
+  {
+    return collapsedCols;
+  }
+
+  /* true if the column is selected by the view query and not replaced by null */
+  bool isColumnProjected(const QString& colName) const;
+
+  /* Create all statements from the current state */
+  void build();
+
+  /* Full select statement */
+  QString getSqlQuery() const
+  {
+    return sqlQuery;
+  }
+
+  const QVariantMap& getSqlBinds() const
+  {
+    return sqlBinds;
+  }
+
+  /* Select statement with collapsed columns replaced by null */
+  QString getViewQuery() const
+  {
+    return viewQuery;
+  }
+
+  const QVariantMap& getViewBinds() const
+  {
+    return viewBinds;
+  }
+
+  /* Statement returning the total number of rows of the view statement */
+  QString getCountQuery() const
+  {
+    return countQuery;
+  }
+
+  const QVariantMap& getCountBinds() const
+  {
+    return countBinds;
+  }
+
+  /* Statements as created by the last build() */
+  const SelectStatement& getStatement() const
+  {
+    return statement;
+  }
+
+  const SelectStatement& getViewStatement() const
+  {
+    return viewStatement;
+  }
+
+  QString getTableName() const
+  {
+    return tableName;
+  }
+
+  /* Human readable summary of filters, grouping and order for diagnostics */
+  QString getStateDescription() const;
+
+  /* Columns identifying a row. simulator_id and logbook_id or the group by column.
+   * Rollup rows are identified by all group columns and the level. */
+  QStringList getKeyColumns() const
+  {
+    return isGrouped() ? QStringList({groupByCols.last()}) : QStringList({"simulator_id", "logbook_id"});
+  }
+
+  /* Result column names or aliases in query order */
+  const QStringList& getResultColumnNames() const
+  {
+    return resultColumnNames;
+  }
+
+  const ColumnList *getColumnList() const
+  {
+    return columns;
+  }
+
+private:
+  /* Build full list of columns to query including group by and aggregated
+   * columns */
+  void buildColumnList();
+
+  /* Add order term for the column using its sort function if any */
+  void addOrder(const QString& colName, bool descending);
+
+  const ColumnList *columns;
+  QString tableName, orderByCol, orderByOrder, whereOperator = "and";
+  QStringList groupByCols;
+  QHash<QString, SelectStatement::Predicate> conditionMap, rangeMap;
+  QSet<QString> collapsedCols;
+  QString filterTable;
+
+  SelectStatement statement, viewStatement;
+  QString sqlQuery, viewQuery, countQuery;
+  QVariantMap sqlBinds, viewBinds, countBinds;
+  QStringList columnList, viewColumnList, resultColumnNames;
+};
+
+#endif // LITTLELOGBOOK_QUERYBUILDER_H
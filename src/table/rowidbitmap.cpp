@@ -0,0 +1,275 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "table/rowidbitmap.h"
+
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <iterator>
+
+void RowIdBitmap::append(quint64 id)
+{
+  quint64 key = id >> 16;
+  quint16 low = static_cast<quint16>(id & 0xffff);
+
+  if(blocks.isEmpty() || blocks.last().key != key)
+  {
+    Q_ASSERT(blocks.isEmpty() || blocks.last().key < key);
+    Block block;
+    block.key = key;
+    blocks.append(block);
+  }
+
+  Block& block = blocks.last();
+  if(block.bits.isEmpty())
+  {
+    Q_ASSERT(block.array.isEmpty() || block.array.last() < low);
+    block.array.append(low);
+    if(block.array.size() > MAX_ARRAY_SIZE)
+      toBitset(block);
+  }
+  else
+    block.bits[low >> 6] |= Q_UINT64_C(1) << (low & 63);
+
+  block.count++;
+  cardinality++;
+}
+
+bool RowIdBitmap::contains(quint64 id) const
+{
+  quint64 key = id >> 16;
+  auto it = std::lower_bound(blocks.constBegin(), blocks.constEnd(), key,
+                             [](const Block& block, quint64 k) -> bool {
+                               return block.key < k;
+                             });
+  return it != blocks.constEnd() && it->key == key && blockContains(*it, static_cast<quint16>(id & 0xffff));
+}
+
+QVector<quint64> RowIdBitmap::toVector() const
+{
+  QVector<quint64> ids;
+  ids.reserve(cardinality);
+  for(const Block& block : blocks)
+  {
+    quint64 high = block.key << 16;
+    if(block.bits.isEmpty())
+    {
+      for(quint16 low : block.array)
+        ids.append(high | low);
+    }
+    else
+    {
+      for(int w = 0; w < BITSET_WORDS; w++)
+      {
+        quint64 word = block.bits.at(w);
+        for(int b = 0; word != 0; b++, word >>= 1)
+          if(word & 1)
+            ids.append(high | static_cast<quint64>(w * 64 + b));
+      }
+    }
+  }
+  return ids;
+}
+
+qint64 RowIdBitmap::getBytes() const
+{
+  qint64 bytes = static_cast<qint64>(sizeof(RowIdBitmap)) + blocks.size() * static_cast<qint64>(sizeof(Block));
+  for(const Block& block : blocks)
+    bytes += block.array.size() * static_cast<qint64>(sizeof(quint16)) +
+             block.bits.size() * static_cast<qint64>(sizeof(quint64));
+  return bytes;
+}
+
+RowIdBitmap RowIdBitmap::operator&(const RowIdBitmap& other) const
+{
+  RowIdBitmap result;
+  int i = 0, j = 0;
+  while(i < blocks.size() && j < other.blocks.size())
+  {
+    if(blocks.at(i).key < other.blocks.at(j).key)
+      i++;
+    else if(blocks.at(i).key > other.blocks.at(j).key)
+      j++;
+    else
+    {
+      Block block = andBlocks(blocks.at(i++), other.blocks.at(j++));
+      if(block.count > 0)
+      {
+        result.cardinality += block.count;
+        result.blocks.append(block);
+      }
+    }
+  }
+  return result;
+}
+
+RowIdBitmap RowIdBitmap::operator|(const RowIdBitmap& other) const
+{
+  RowIdBitmap result;
+  int i = 0, j = 0;
+  while(i < blocks.size() || j < other.blocks.size())
+  {
+    Block block;
+    if(j >= other.blocks.size() || (i < blocks.size() && blocks.at(i).key < other.blocks.at(j).key))
+      block = blocks.at(i++);
+    else if(i >= blocks.size() || blocks.at(i).key > other.blocks.at(j).key)
+      block = other.blocks.at(j++);
+    else
+      block = orBlocks(blocks.at(i++), other.blocks.at(j++));
+
+    result.cardinality += block.count;
+    result.blocks.append(block);
+  }
+  return result;
+}
+
+bool RowIdBitmap::operator==(const RowIdBitmap& other) const
+{
+  if(cardinality != other.cardinality || blocks.size() != other.blocks.size())
+    return false;
+
+  // The same ids can be stored as array or bitset depending on how the bitmap was built
+  for(int i = 0; i < blocks.size(); i++)
+  {
+    const Block& a = blocks.at(i), & b = other.blocks.at(i);
+    if(a.key != b.key || a.count != b.count)
+      return false;
+
+    if(a.bits.isEmpty() && b.bits.isEmpty())
+    {
+      if(a.array != b.array)
+        return false;
+    }
+    else if(!a.bits.isEmpty() && !b.bits.isEmpty())
+    {
+      if(a.bits != b.bits)
+        return false;
+    }
+    else
+    {
+      // Same count - all ids of the array have to be in the bitset
+      const Block& arr = a.bits.isEmpty() ? a : b;
+      const Block& set = a.bits.isEmpty() ? b : a;
+      for(quint16 low : arr.array)
+        if(!blockContains(set, low))
+          return false;
+    }
+  }
+  return true;
+}
+
+RowIdBitmap::Block RowIdBitmap::andBlocks(const Block& a, const Block& b)
+{
+  Block block;
+  block.key = a.key;
+
+  if(!a.bits.isEmpty() && !b.bits.isEmpty())
+  {
+    block.bits.resize(BITSET_WORDS);
+    for(int w = 0; w < BITSET_WORDS; w++)
+    {
+      block.bits[w] = a.bits.at(w) & b.bits.at(w);
+      block.count += qPopulationCount(block.bits.at(w));
+    }
+    if(block.count <= MAX_ARRAY_SIZE)
+      toArray(block);
+  }
+  else if(!a.bits.isEmpty() || !b.bits.isEmpty())
+  {
+    // Probe the array in the bitset
+    const Block& arr = a.bits.isEmpty() ? a : b;
+    const Block& set = a.bits.isEmpty() ? b : a;
+    for(quint16 low : arr.array)
+      if(blockContains(set, low))
+        block.array.append(low);
+    block.count = block.array.size();
+  }
+  else
+  {
+    std::set_intersection(a.array.constBegin(), a.array.constEnd(), b.array.constBegin(), b.array.constEnd(),
+                          std::back_inserter(block.array));
+    block.count = block.array.size();
+  }
+  return block;
+}
+
+RowIdBitmap::Block RowIdBitmap::orBlocks(const Block& a, const Block& b)
+{
+  Block block;
+  block.key = a.key;
+
+  if(a.bits.isEmpty() && b.bits.isEmpty() && a.count + b.count <= MAX_ARRAY_SIZE)
+  {
+    std::set_union(a.array.constBegin(), a.array.constEnd(), b.array.constBegin(), b.array.constEnd(),
+                   std::back_inserter(block.array));
+    block.count = block.array.size();
+  }
+  else
+  {
+    Block setA = a, setB = b;
+    toBitset(setA);
+    toBitset(setB);
+    block.bits.resize(BITSET_WORDS);
+    for(int w = 0; w < BITSET_WORDS; w++)
+    {
+      block.bits[w] = setA.bits.at(w) | setB.bits.at(w);
+      block.count += qPopulationCount(block.bits.at(w));
+    }
+    if(block.count <= MAX_ARRAY_SIZE)
+      toArray(block);
+  }
+  return block;
+}
+
+void RowIdBitmap::toBitset(Block& block)
+{
+  if(!block.bits.isEmpty())
+    return;
+
+  block.bits.fill(0, BITSET_WORDS);
+  for(quint16 low : block.array)
+    block.bits[low >> 6] |= Q_UINT64_C(1) << (low & 63);
+  block.array.clear();
+  block.array.squeeze();
+}
+
+void RowIdBitmap::toArray(Block& block)
+{
+  if(block.bits.isEmpty())
+    return;
+
+  block.array.clear();
+  block.array.reserve(block.count);
+  for(int w = 0; w < BITSET_WORDS; w++)
+  {
+    quint64 word = block.bits.at(w);
+    for(int b = 0; word != 0; b++, word >>= 1)
+      if(word & 1)
+        block.array.append(static_cast<quint16>(w * 64 + b));
+  }
+  block.bits.clear();
+  block.bits.squeeze();
+}
+
+bool RowIdBitmap::blockContains(const Block& block, quint16 low)
+{
+  if(block.bits.isEmpty())
+    return std::binary_search(block.array.constBegin(), block.array.constEnd(), low);
+  else
+    return (block.bits.at(low >> 6) >> (low & 63)) & 1;
+}
@@ -0,0 +1,87 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_ROWIDBITMAP_H
+#define LITTLELOGBOOK_ROWIDBITMAP_H
+
+#include <QVector>
+
+/*
+ * Compressed set of row ids. Ids are split into blocks of 65536 by the upper 48
+ * bits. Sparse blocks keep a sorted array of the lower 16 bits and dense blocks
+ * a bitset of 8 KB like roaring bitmaps do.
+ */
+class RowIdBitmap
+{
+public:
+  /* Add an id. Ids have to be added in ascending order. */
+  void append(quint64 id);
+
+  bool contains(quint64 id) const;
+
+  int count() const
+  {
+    return cardinality;
+  }
+
+  bool isEmpty() const
+  {
+    return cardinality == 0;
+  }
+
+  /* Ids in ascending order */
+  QVector<quint64> toVector() const;
+
+  /* Estimated memory usage */
+  qint64 getBytes() const;
+
+  RowIdBitmap operator&(const RowIdBitmap& other) const;
+  RowIdBitmap operator|(const RowIdBitmap& other) const;
+
+  /* Compares the ids independent of how the blocks are stored */
+  bool operator==(const RowIdBitmap& other) const;
+
+  bool operator!=(const RowIdBitmap& other) const
+  {
+    return !(*this == other);
+  }
+
+private:
+  struct Block
+  {
+    quint64 key = 0; /* Upper 48 bits */
+    int count = 0;
+    QVector<quint16> array; /* Sorted lower bits if sparse */
+    QVector<quint64> bits; /* Bitset if dense */
+  };
+
+  /* Blocks with more ids are stored as bitset */
+  static const int MAX_ARRAY_SIZE = 4096;
+  static const int BITSET_WORDS = 65536 / 64;
+
+  static Block andBlocks(const Block& a, const Block& b);
+  static Block orBlocks(const Block& a, const Block& b);
+  static void toBitset(Block& block);
+  static void toArray(Block& block);
+  static bool blockContains(const Block& block, quint16 low);
+
+  /* Sorted by key */
+  QVector<Block> blocks;
+  int cardinality = 0;
+};
+
+#endif // LITTLELOGBOOK_ROWIDBITMAP_H
@@ -0,0 +1,320 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "table/selectstatement.h"
+
+#include <algorithm>
+
+QString SelectStatement::Predicate::getKey() const
+{
+  QString valueText;
+  if(op == IN_LIST)
+  {
+    QStringList ids;
+    for(const QVariant& id : value.toList())
+      ids.append(QString::number(id.toLongLong()));
+    valueText = ids.join(",");
+  }
+  else if(op == BETWEEN)
+  {
+    QVariantList bounds = value.toList();
+    valueText = bounds.value(0).toString() + " and " + bounds.value(1).toString();
+  }
+  else if(!value.isNull())
+    valueText = QString(value.typeName()) + ":" + value.toString();
+
+  return (alwaysAnd ? "and " : "") + column + " " + operatorSql(op) + " " + valueText +
+         (op == EQUAL_NOCASE ? " collate nocase" : "");
+}
+
+bool SelectStatement::Predicate::isIndexSeek() const
+{
+  if(!indexed)
+    return false;
+
+  if(op == GREATER_EQUAL || op == LESS_EQUAL || op == BETWEEN || op == GREATER || op == EQUAL_NOCASE)
+    return true;
+
+  // A leading wildcard needs a full scan
+  if(op != LIKE || value.type() != QVariant::String)
+    return false;
+
+  QString pattern = value.toString();
+  return !pattern.isEmpty() && !pattern.startsWith("%") && !pattern.startsWith("_");
+}
+
+bool SelectStatement::Predicate::operator<(const Predicate& other) const
+{
+  if(alwaysAnd != other.alwaysAnd)
+    return !alwaysAnd;
+  if(column != other.column)
+    return column < other.column;
+  if(op != other.op)
+    return op < other.op;
+  return getKey() < other.getKey();
+}
+
+SelectStatement::SelectStatement(const QString& tableName)
+  : table(tableName)
+{
+}
+
+void SelectStatement::addPredicate(const Predicate& predicate)
+{
+  predicates.insert(std::upper_bound(predicates.begin(), predicates.end(), predicate), predicate);
+}
+
+void SelectStatement::clearPredicates()
+{
+  predicates.clear();
+  seekKeyColumn.clear();
+  idTableKeyColumn.clear();
+  idTable.clear();
+}
+
+void SelectStatement::addOrder(const QString& expression, bool descending)
+{
+  order.append({expression, descending});
+}
+
+bool SelectStatement::rewriteOrToIndexSeeks(const QString& keyColumn)
+{
+  seekKeyColumn.clear();
+  if(!orOperator)
+    return false;
+
+  int numPredicates = 0;
+  for(const Predicate& predicate : predicates)
+  {
+    if(!predicate.alwaysAnd)
+    {
+      if(!predicate.isIndexSeek())
+        return false;
+      numPredicates++;
+    }
+  }
+
+  if(numPredicates > 1)
+  {
+    seekKeyColumn = keyColumn;
+    return true;
+  }
+  return false;
+}
+
+void SelectStatement::rewriteToIdTable(const QString& keyColumn, const QString& tableName)
+{
+  idTableKeyColumn = tableName.isEmpty() ? QString() : keyColumn;
+  idTable = tableName;
+}
+
+QString SelectStatement::toSql(QVariantMap& binds) const
+{
+  QString sql = "select " + columns.join(", ") + " from " + table + buildWhere(binds);
+
+  if(!groupBy.isEmpty())
+    sql += " group by " + groupBy.join(", ");
+
+  if(!order.isEmpty())
+  {
+    QStringList terms;
+    for(const OrderTerm& term : order)
+      terms.append(term.expression + (term.descending ? " desc" : " asc"));
+    sql += " order by " + terms.join(", ");
+  }
+
+  if(limit >= 0 || offset > 0)
+    sql += " limit " + QString::number(limit);
+  if(offset > 0)
+    sql += " offset " + QString::number(offset);
+
+  return sql;
+}
+
+QString SelectStatement::toCountSql(QVariantMap& binds) const
+{
+  if(groupBy.isEmpty())
+    return "select count(1) from " + table + buildWhere(binds);
+  else if(!rollup)
+    return "select count(1) from (select 1 from " + table + buildWhere(binds) +
+           " group by " + groupBy.join(", ") + ")";
+  else
+  {
+    // Count the groups of each level from the groups of the last level.
+    // The grand total is one row if there are any groups.
+    QString sql = "with leaf_groups as (select " + groupBy.join(", ") + " from " + table + buildWhere(binds) +
+                  " group by " + groupBy.join(", ") + ") select min(1, (select count(1) from leaf_groups))";
+    for(int level = 1; level <= groupBy.size(); level++)
+      sql += " + (select count(1) from (select 1 from leaf_groups group by " +
+             QStringList(groupBy.mid(0, level)).join(", ") + "))";
+    return sql;
+  }
+}
+
+QString SelectStatement::getCacheKey() const
+{
+  QStringList terms;
+  for(const OrderTerm& term : order)
+    terms.append(term.expression + (term.descending ? " desc" : " asc"));
+
+  return getFilterKey() + "|" + columns.join(",") + "|" + terms.join(",") + "|" +
+         QString::number(limit) + "," + QString::number(offset) + "|" + seekKeyColumn + "|" + idTable;
+}
+
+QString SelectStatement::getFilterKey() const
+{
+  QStringList keys;
+  for(const Predicate& predicate : predicates)
+    keys.append(predicate.getKey());
+
+  return table + "|" + (orOperator ? "or" : "and") + "|" + keys.join("\n") + "|" + groupBy.join(",") +
+         (rollup ? " rollup" : "");
+}
+
+QString SelectStatement::operatorSql(Operator op)
+{
+  switch(op)
+  {
+    case EQUAL:
+    case EQUAL_NOCASE:
+      return "=";
+
+    case LIKE:
+      return "like";
+
+    case NOT_LIKE:
+      return "not like";
+
+    case IS_NULL:
+      return "is null";
+
+    case IS_NOT_NULL:
+      return "is not null";
+
+    case IN_LIST:
+      return "in";
+
+    case GREATER_EQUAL:
+      return ">=";
+
+    case LESS_EQUAL:
+      return "<=";
+
+    case BETWEEN:
+      return "between";
+
+    case GREATER:
+      return ">";
+  }
+  return QString();
+}
+
+QString SelectStatement::buildWhere(QVariantMap& binds) const
+{
+  if(predicates.isEmpty())
+    return QString();
+
+  QVector<Predicate> userPredicates, andPredicates;
+  for(const Predicate& predicate : predicates)
+  {
+    if(predicate.alwaysAnd)
+      andPredicates.append(predicate);
+    else
+      userPredicates.append(predicate);
+  }
+
+  QStringList conditions;
+  if(!idTable.isEmpty())
+    // The table holds the ids matching the user predicates
+    conditions.append(idTableKeyColumn + " in (select " + idTableKeyColumn + " from " + idTable + ")");
+  else if(!seekKeyColumn.isEmpty())
+  {
+    // One index seek for each predicate - "in" removes duplicates
+    QStringList seeks;
+    for(const Predicate& predicate : userPredicates)
+      seeks.append("select " + seekKeyColumn + " from " + table + " where " + buildPredicate(predicate, binds));
+    conditions.append(seekKeyColumn + " in (" + seeks.join(" union all ") + ")");
+  }
+  else if(!userPredicates.isEmpty())
+  {
+    QStringList userConditions;
+    for(const Predicate& predicate : userPredicates)
+      userConditions.append(buildPredicate(predicate, binds));
+    conditions.append("(" + userConditions.join(orOperator ? " or " : " and ") + ")");
+  }
+
+  for(const Predicate& predicate : andPredicates)
+    conditions.append(buildPredicate(predicate, binds));
+
+  return " where " + conditions.join(" and ");
+}
+
+QString SelectStatement::buildPredicate(const Predicate& predicate, QVariantMap& binds) const
+{
+  QString sql = predicate.column + " " + operatorSql(predicate.op);
+
+  switch(predicate.op)
+  {
+    case EQUAL:
+    case LIKE:
+    case NOT_LIKE:
+    case GREATER_EQUAL:
+    case LESS_EQUAL:
+    case GREATER:
+      {
+        QString name = ":p" + QString::number(binds.size());
+        binds.insert(name, predicate.value);
+        sql += " " + name;
+      }
+      break;
+
+    case EQUAL_NOCASE:
+      {
+        QString name = ":p" + QString::number(binds.size());
+        binds.insert(name, predicate.value);
+        sql += " " + name + " collate nocase";
+      }
+      break;
+
+    case BETWEEN:
+      {
+        QVariantList bounds = predicate.value.toList();
+        Q_ASSERT(bounds.size() == 2);
+        QString lower = ":p" + QString::number(binds.size());
+        binds.insert(lower, bounds.value(0));
+        QString upper = ":p" + QString::number(binds.size());
+        binds.insert(upper, bounds.value(1));
+        sql += " " + lower + " and " + upper;
+      }
+      break;
+
+    case IN_LIST:
+      {
+        // Integers only - no binds needed and no limit for the number of variables
+        QStringList ids;
+        for(const QVariant& id : predicate.value.toList())
+          ids.append(QString::number(id.toLongLong()));
+        sql += " (" + ids.join(",") + ")";
+      }
+      break;
+
+    case IS_NULL:
+    case IS_NOT_NULL:
+      break;
+  }
+  return sql;
+}
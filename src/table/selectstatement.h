@@ -0,0 +1,190 @@
+/*****************************************************************************
+* Copyright 2015-2016 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLELOGBOOK_SELECTSTATEMENT_H
+#define LITTLELOGBOOK_SELECTSTATEMENT_H
+
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+/*
+ * Typed representation of a select statement on a single table with
+ * projection, predicates, group by, order by and limit. Predicates are kept in a
+ * canonical order so that the same state always results in the same SQL text and
+ * cache key. Values are passed as bind variables and never pasted into the SQL.
+ *
+ * Projection and order expressions are taken from the column descriptors and
+ * are not escaped.
+ */
+class SelectStatement
+{
+public:
+  enum Operator
+  {
+    EQUAL,
+    LIKE,
+    NOT_LIKE,
+    IS_NULL,
+    IS_NOT_NULL,
+    IN_LIST, /* Value is a list of integers */
+    GREATER_EQUAL,
+    LESS_EQUAL,
+    BETWEEN, /* Value is a list of the lower and upper bound - both inclusive */
+    GREATER, /* Keyset pagination */
+    EQUAL_NOCASE /* Text equality using nocase collation which can seek in nocase indexes */
+  };
+
+  struct Predicate
+  {
+    QString column;
+    Operator op = EQUAL;
+    QVariant value;
+    bool alwaysAnd = false; /* Combined using "and" regardless of the statement operator */
+    bool indexed = false; /* Column has an index usable for "like" prefix or range searches */
+
+    /* Stable key identifying the predicate including its value */
+    QString getKey() const;
+
+    /* true if an index range seek can answer this predicate. Value ranges are
+     * seeks if the column is indexed. */
+    bool isIndexSeek() const;
+
+    /* Order used to make statements canonical */
+    bool operator<(const Predicate& other) const;
+  };
+
+  explicit SelectStatement(const QString& tableName = QString());
+
+  /* Column name or expression including an optional alias */
+  void addColumn(const QString& expression)
+  {
+    columns.append(expression);
+  }
+
+  void clearColumns()
+  {
+    columns.clear();
+  }
+
+  const QStringList& getColumns() const
+  {
+    return columns;
+  }
+
+  /* Add predicate at its canonical position */
+  void addPredicate(const Predicate& predicate);
+
+  void clearPredicates();
+
+  const QVector<Predicate>& getPredicates() const
+  {
+    return predicates;
+  }
+
+  /* Combine all predicates that are not always "and" using "or" */
+  void setOrOperator(bool value)
+  {
+    orOperator = value;
+  }
+
+  bool isOrOperator() const
+  {
+    return orOperator;
+  }
+
+  /* Group by one or more columns. If withRollup is set the count statement
+   * includes the subtotal rows of all levels like "group by rollup" would return.
+   * The subtotal rows themselves are added by GroupRollup. */
+  void setGroupBy(const QStringList& groupColumns, bool withRollup = false)
+  {
+    groupBy = groupColumns;
+    rollup = withRollup && groupColumns.size() > 1;
+  }
+
+  /* Order by a column or expression */
+  void addOrder(const QString& expression, bool descending = false);
+
+  void clearOrder()
+  {
+    order.clear();
+  }
+
+  /* -1 for no limit */
+  void setLimit(int limitValue, int offsetValue = 0)
+  {
+    limit = limitValue;
+    offset = offsetValue;
+  }
+
+  /* Rewrite rule: if predicates are combined by "or" and all of them can use an
+   * index seek select them by "keyColumn in (select ... union all select ...)".
+   * SQLite would scan the whole table otherwise.
+   * @return true if the statement was rewritten */
+  bool rewriteOrToIndexSeeks(const QString& keyColumn);
+
+  /* Rewrite rule: replace the predicates that are not alwaysAnd by "keyColumn in
+   * (select keyColumn from table)" where the table contains the ids of all rows matching
+   * them. alwaysAnd predicates stay plain SQL. Empty table name removes the rule. */
+  void rewriteToIdTable(const QString& keyColumn, const QString& table);
+
+  /* SQL with named bind variables. Values are added to binds. */
+  QString toSql(QVariantMap& binds) const;
+
+  /* Statement returning the number of rows or groups */
+  QString toCountSql(QVariantMap& binds) const;
+
+  /* Canonical text of the whole statement including all values */
+  QString getCacheKey() const;
+
+  /* Canonical text of everything that defines the selected rows or groups:
+   * table, predicates and grouping. Usable as key for row counts. */
+  QString getFilterKey() const;
+
+  /* Bind values to a prepared QSqlQuery or atools::sql::SqlQuery */
+  template<typename QUERY>
+  static void bindValues(QUERY& query, const QVariantMap& binds)
+  {
+    for(auto it = binds.constBegin(); it != binds.constEnd(); ++it)
+      query.bindValue(it.key(), it.value());
+  }
+
+  static QString operatorSql(Operator op);
+
+private:
+  QString buildWhere(QVariantMap& binds) const;
+  QString buildPredicate(const Predicate& predicate, QVariantMap& binds) const;
+
+  struct OrderTerm
+  {
+    QString expression;
+    bool descending;
+  };
+
+  QString table;
+  QStringList columns, groupBy;
+  QVector<Predicate> predicates;
+  QVector<OrderTerm> order;
+  bool orOperator = false, rollup = false;
+  int limit = -1, offset = 0;
+
+  /* Set by the rewrite rules */
+  QString seekKeyColumn, idTableKeyColumn, idTable;
+};
+
+#endif // LITTLELOGBOOK_SELECTSTATEMENT_H
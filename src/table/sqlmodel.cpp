@@ -18,34 +18,47 @@
 #include "table/sqlmodel.h"
 #include "gui/constants.h"
 #include "gui/airportinfo.h"
+#include "db/connectionpool.h"
+#include "diag/memorystats.h"
+#include "diag/querystats.h"
+#include "diag/tracer.h"
 
 #include "gui/errorhandler.h"
 #include "fs/lb/types.h"
 #include "fs/fspaths.h"
 #include "table/columnlist.h"
+#include "table/filtercache.h"
+#include "table/grouprollup.h"
 #include "table/formatter.h"
+#include "table/querybuilder.h"
 #include "sql/sqldatabase.h"
 #include "sql/sqlquery.h"
 #include "sql/sqlutil.h"
 #include "geo/calculations.h"
+#include "settings/settings.h"
 #include "logging/loggingdefs.h"
 
 #include <algorithm>
 #include <QApplication>
+#include <QFont>
 #include <QLineEdit>
 #include <QSqlField>
+#include <QSqlQuery>
+#include <QSqlError>
 #include <QPalette>
+#include <QMap>
+#include <QSet>
 
 using atools::sql::SqlQuery;
 using atools::sql::SqlUtil;
 using atools::sql::SqlDatabase;
 using atools::gui::ErrorHandler;
 
-SqlModel::SqlModel(QWidget *parent, SqlDatabase *sqlDb, const ColumnList *columnList, bool hasAirportTable)
-  : QSqlQueryModel(parent), db(sqlDb), columns(columnList), parentWidget(parent), hasAirports(hasAirportTable)
+SqlModel::SqlModel(QWidget *parent, SqlDatabase *sqlDb, ConnectionPool *connectionPool,
+                   const ColumnList *columnList, bool hasAirportTable)
+  : QAbstractTableModel(parent), query(columnList), db(sqlDb), columns(columnList), parentWidget(parent),
+    hasAirports(hasAirportTable)
 {
-  tableName = "logbook";
-
   /* Alternating colors */
   rowBgColor = QApplication::palette().color(QPalette::Active, QPalette::Base);
   rowAltBgColor = QApplication::palette().color(QPalette::Active, QPalette::AlternateBase);
@@ -54,92 +67,60 @@ SqlModel::SqlModel(QWidget *parent, SqlDatabase *sqlDb, const ColumnList *column
   rowSortBgColor = rowBgColor.darker(106);
   rowSortAltBgColor = rowAltBgColor.darker(106);
 
-  airportInfo = new AirportInfo(parent, db);
+  airportInfo = new AirportInfo(parent, connectionPool->getReadConnection());
+
+  pageLoadTimer.setSingleShot(true);
+  pageLoadTimer.setInterval(0);
+  connect(&pageLoadTimer, &QTimer::timeout, this, &SqlModel::loadRequestedPages);
+
+  cacheLimitBytes = atools::settings::Settings::instance()->value(
+    ll::constants::SETTINGS_MODEL_CACHE_LIMIT_MB, 0).toLongLong() * 1024 * 1024;
+
+  qint64 filterCacheBytes = atools::settings::Settings::instance()->value(
+    ll::constants::SETTINGS_FILTER_CACHE_MB, 16).toLongLong() * 1024 * 1024;
+  if(filterCacheBytes > 0)
+  {
+    filterCache = new FilterCache(db, query.getTableName());
+    filterCache->setLimitBytes(filterCacheBytes);
+  }
 
   buildQuery();
 }
 
 SqlModel::~SqlModel()
 {
+  closeCursor();
   delete airportInfo;
+  delete filterCache;
+  delete rollup;
+  MemoryStats::instance().set(MemoryStats::FILTER_CACHE_BYTES, 0);
+
+  rows.clear();
+  clearCacheState();
+  updateMemoryStats();
 }
 
 void SqlModel::filter(const QString& colName, const QVariant& value)
 {
-  bool colAlreadyFiltered = whereConditionMap.contains(colName);
-
-  if(value.isNull() || (value.type() == QVariant::String && value.toString().isEmpty()))
-  {
-    // If we get a null value or an empty string and the
-    // column is already filtered remove it
-    if(colAlreadyFiltered)
-      whereConditionMap.remove(colName);
-  }
-  else
-  {
-    QVariant newVariant;
-    QString condition;
-
-    if(value.type() == QVariant::String)
-    {
-      // Use like queries for string
-      QString newVal = value.toString();
-
-      if(newVal.startsWith(ll::constants::QUERY_NEGATE_CHAR))
-      {
-        if(newVal == ll::constants::QUERY_NEGATE_CHAR)
-        {
-          // A single "-" translates to not nulls
-          condition = "is not null";
-          newVal.clear();
-        }
-        else
-        {
-          condition = "not like";
-          newVal.remove(0, 1);
-        }
-      }
-      else
-        condition = "like";
-
-      // Replace "*" with "%" for SQL
-      if(newVal.contains(ll::constants::QUERY_PLACEHOLDER_CHAR))
-        newVal = newVal.toUpper().replace(ll::constants::QUERY_PLACEHOLDER_CHAR, "%");
-      else if(!newVal.isEmpty())
-        newVal = newVal.toUpper() + "%";
-
-      newVariant = newVal;
-    }
-    else if(value.type() == QVariant::Int)
-    {
-      // Use equal for numbers
-      newVariant = value;
-      condition = "=";
-    }
-    const Column *col = columns->getColumn(colName);
-    Q_ASSERT(col != nullptr);
+  query.filter(colName, value);
+  buildQuery();
+}
 
-    if(colAlreadyFiltered)
-    {
-      // Replace values in existing condition
-      whereConditionMap[colName].oper = condition;
-      whereConditionMap[colName].value = newVariant;
-      whereConditionMap[colName].col = col;
-    }
-    else
-      whereConditionMap.insert(colName, {condition, newVariant, col});
-  }
+void SqlModel::filterRange(const QString& colName, const QVariant& minValue, const QVariant& maxValue)
+{
+  query.filterRange(colName, minValue, maxValue);
   buildQuery();
 }
 
 void SqlModel::filterOperator(const QString& op)
 {
-  whereOperator = op;
+  query.setWhereOperator(op);
   buildQuery();
 }
 
-QVariant SqlModel::getFormattedFieldData(const QModelIndex& index) const
+QVariant SqlModel::getFormattedFieldData(const QModelIndex& index)
 {
+  loadReleasedRow(index.row());
   return data(index);
 }
 
@@ -157,79 +138,73 @@ void SqlModel::filterExcluding(QModelIndex index)
 
 void SqlModel::filterBy(QModelIndex index, bool exclude)
 {
-  QString whereCol = record().field(index.column()).name();
-  QVariant whereValue = QSqlQueryModel::data(index);
+  if(isSubtotalCell(index))
+    // Nothing to filter for
+    return;
 
-  // If there is already a filter on the same column remove it
-  if(whereConditionMap.contains(whereCol))
-    whereConditionMap.remove(whereCol);
+  loadReleasedRow(index.row());
+  QString whereCol = record().field(index.column()).name();
+  QVariant whereValue = rawData(index);
 
-  QString whereOp;
+  SelectStatement::Operator whereOp;
   if(whereValue.isNull())
-    whereOp = exclude ? "is not null" : "is null";
+    whereOp = exclude ? SelectStatement::IS_NOT_NULL : SelectStatement::IS_NULL;
   else
-    whereOp = exclude ? " not like " : " like ";
-
-  const Column *col = columns->getColumn(whereCol);
-  Q_ASSERT(col != nullptr);
+    whereOp = exclude ? SelectStatement::NOT_LIKE : SelectStatement::LIKE;
 
   // Set the search text into the corresponding line edit
   QLineEdit *edit = columns->getColumn(whereCol)->getLineEditWidget();
   if(edit != nullptr)
     edit->setText((exclude ? ll::constants::QUERY_NEGATE_CHAR : "") + whereValue.toString());
 
-  whereConditionMap.insert(whereCol, {whereOp, whereValue, col});
+  // Replaces an existing filter on the same column
+  query.setCondition(whereCol, whereOp, whereValue);
 }
 
 void SqlModel::getGroupByColumn(QModelIndex index)
 {
-  groupByCol = record().fieldName(index.column());
-  orderByCol = groupByCol;
-  orderByOrder = "asc";
-  clearWhereConditions();
+  QString groupByCol = record().fieldName(index.column());
+  query.setGroupBy(groupByCol);
+  query.setOrderBy(groupByCol, "asc");
+  query.clearWhereConditions();
   buildQuery();
   fillHeaderData();
 }
 
-void SqlModel::reset()
+void SqlModel::addGroupByColumn(const QString& colName)
 {
-  orderByCol.clear();
-  orderByOrder.clear();
-  groupByCol.clear();
-  clearWhereConditions();
+  // Keep the filters of the current grouping
+  query.addGroupBy(colName);
+  query.setOrderBy(query.getGroupBy(), "asc");
   buildQuery();
   fillHeaderData();
 }
 
-void SqlModel::resetSearch()
+void SqlModel::reset()
 {
-  clearWhereConditions();
+  query.setOrderBy(QString(), QString());
+  query.setGroupBy(QString());
+  query.clearWhereConditions();
+  query.clearRanges();
   buildQuery();
-  // no need to rebuild header - view remains the same
+  fillHeaderData();
 }
 
-void SqlModel::clearWhereConditions()
+void SqlModel::resetSearch()
 {
-  // Keep simulator filter - system dependent
-  auto iter = whereConditionMap.find("simulator_id");
-  if(iter != whereConditionMap.end())
-  {
-    WhereCondition wc = *iter;
-    whereConditionMap.clear();
-    whereConditionMap.insert(wc.col->getColumnName(), wc);
-  }
-  else
-    whereConditionMap.clear();
+  query.clearWhereConditions();
+  query.clearRanges();
+  buildQuery();
+  // no need to rebuild header - view remains the same
 }
 
 void SqlModel::ungroup()
 {
-  clearWhereConditions();
-  groupByCol.clear();
+  query.clearWhereConditions();
+  query.setGroupBy(QString());
 
   // Restore last sort order
-  orderByCol = lastOrderByCol;
-  orderByOrder = sortOrderToSql(lastOrderByOrder);
+  query.setOrderBy(lastOrderByCol, sortOrderToSql(lastOrderByOrder));
 
   buildQuery();
   fillHeaderData();
@@ -252,7 +227,7 @@ void SqlModel::fillHeaderData()
 
 bool SqlModel::isGrouped() const
 {
-  return !groupByCol.isEmpty();
+  return query.isGrouped();
 }
 
 int SqlModel::getLastSortIndex() const
@@ -291,10 +266,10 @@ QString SqlModel::sortOrderToSql(Qt::SortOrder order)
 void SqlModel::sort(int column, Qt::SortOrder order)
 {
   orderByColIndex = column;
-  orderByCol = record().field(column).name();
-  orderByOrder = sortOrderToSql(order);
+  QString orderByCol = record().field(column).name();
+  query.setOrderBy(orderByCol, sortOrderToSql(order));
 
-  if(groupByCol.isEmpty())
+  if(!query.isGrouped())
   {
     // Remember this sort order for the next ungroup
     lastOrderByCol = orderByCol;
@@ -303,176 +278,841 @@ void SqlModel::sort(int column, Qt::SortOrder order)
   buildQuery();
 }
 
-QString SqlModel::buildColumnList()
+void SqlModel::buildQuery()
+{
+  TraceSpan span("buildQuery", "model");
+
+  // The filter table cannot be changed while it is read
+  closeCursor();
+  updateFilterCache();
+  query.build();
+
+  // Keep the previous rows and count if one of the queries fails
+  int lastTotalRowCount = totalRowCount;
+  if(!updateTotalRowCount() || !resetQuery())
+    totalRowCount = lastTotalRowCount;
+  span.setRows(totalRowCount);
+}
+
+void SqlModel::updateFilterCache()
+{
+  if(filterCache == nullptr)
+    return;
+
+  bool useFilterTable = false;
+  try
+  {
+    useFilterTable = filterCache->update(query.getPredicates(), query.getWhereOperator() == "or");
+  }
+  catch(std::exception& e)
+  {
+    atools::gui::ErrorHandler(parentWidget).handleException(e, "While updating filter");
+  }
+  catch(...)
+  {
+    atools::gui::ErrorHandler(parentWidget).handleUnknownException("While updating filter");
+  }
+
+  query.setFilterTable(useFilterTable ? filterCache->getFilterTable() : QString());
+  MemoryStats::instance().set(MemoryStats::FILTER_CACHE_BYTES, filterCache->getBytes());
+}
+
+bool SqlModel::updateTotalRowCount()
+{
+  // Filter and grouping are the same if only the sort order changed
+  QString key = query.getStatement().getFilterKey();
+  auto it = countCache.constFind(key);
+  if(it != countCache.constEnd())
+  {
+    totalRowCount = *it;
+    return true;
+  }
+
+  QueryTimer timer(QueryStats::COUNT);
+  timer.setQueryInfo(db, query.getCountQuery(), query.getStateDescription(), query.getCountBinds());
+  QSqlQuery countStmt(db->getQSqlDatabase());
+  countStmt.setForwardOnly(true);
+  countStmt.prepare(query.getCountQuery());
+  SelectStatement::bindValues(countStmt, query.getCountBinds());
+  if(!countStmt.exec())
+  {
+    timer.pause();
+    atools::gui::ErrorHandler(parentWidget).handleSqlError(countStmt.lastError());
+    return false;
+  }
+
+  totalRowCount = 0;
+  if(timer.next(countStmt))
+  {
+    totalRowCount = countStmt.value(0).toInt();
+    countCache.insert(key, totalRowCount);
+  }
+  timer.addStatementCounters(countStmt);
+  return true;
+}
+
+bool SqlModel::resetQuery()
 {
-  QVector<QString> colNames;
-  for(const Column& col : columns->getColumns())
+  QueryTimer timer(QueryStats::PAGE_FETCH);
+  timer.setQueryInfo(db, query.getViewQuery(), query.getStateDescription(), query.getViewBinds());
+  if(!openCursor(0))
+    // Keep the loaded rows and record - no more rows can be fetched until the next query
+    return false;
+
+  beginResetModel();
+  rows.clear();
+  queryRecord = cursor->record();
+
+  delete rollup;
+  rollup = nullptr;
+  if(query.isRollup())
+    rollup = new GroupRollup(query.getResultColumnNames(), query.getGroupByColumns().size(),
+                             QueryBuilder::GROUP_LEVEL_COLUMN);
+  levelColIndex = queryRecord.indexOf(QueryBuilder::GROUP_LEVEL_COLUMN);
+
+  rows = readRows(FETCH_SIZE);
+  timer.addRows(rows.size());
+  timer.addStatementCounters(*cursor);
+  timer.pause();
+
+  clearCacheState();
+  addCachedRows(0, rows.size());
+
+  endResetModel();
+  return true;
+}
+
+bool SqlModel::openCursor(int offset)
+{
+  closeCursor();
+
+  cursor = new QSqlQuery(db->getQSqlDatabase());
+  // Rows are cached in the model - no need to keep them in the query too
+  cursor->setForwardOnly(true);
+
+  SelectStatement stmt = query.getViewStatement();
+  stmt.setLimit(-1, offset);
+  QVariantMap binds;
+  cursor->prepare(stmt.toSql(binds));
+  SelectStatement::bindValues(*cursor, binds);
+
+  if(!cursor->exec())
+  {
+    QSqlError error = cursor->lastError();
+    closeCursor();
+    atools::gui::ErrorHandler(parentWidget).handleSqlError(error);
+    return false;
+  }
+  cursorAtEnd = false;
+  return true;
+}
+
+void SqlModel::closeCursor()
+{
+  if(cursor != nullptr)
+  {
+    cursor->finish();
+    delete cursor;
+    cursor = nullptr;
+  }
+  cursorAtEnd = true;
+}
+
+QVector<QVariantList> SqlModel::readRows(int maxRows)
+{
+  QVector<QVariantList> result;
+  if(cursor == nullptr || cursorAtEnd)
+    return result;
+
+  int cnt = queryRecord.count(), numRead = 0;
+  while(numRead < maxRows && cursor->next())
   {
-    if(groupByCol.isEmpty())
+    QVariantList row;
+    row.reserve(cnt);
+    for(int i = 0; i < cnt; ++i)
+      row.append(cursor->value(i));
+    numRead++;
+
+    if(rollup != nullptr)
+      // Adds subtotals of completed groups before the row
+      rollup->addRow(row, result);
+    else
+      result.append(row);
+  }
+
+  if(numRead < maxRows)
+  {
+    // Release the statement as soon as possible to avoid locks
+    cursor->finish();
+    cursorAtEnd = true;
+
+    if(rollup != nullptr)
+      rollup->finish(result);
+  }
+  return result;
+}
+
+void SqlModel::clear()
+{
+  beginResetModel();
+  closeCursor();
+  rows.clear();
+  queryRecord.clear();
+  delete rollup;
+  rollup = nullptr;
+  levelColIndex = -1;
+  headerCaptions.clear();
+  totalRowCount = 0;
+  clearCacheState();
+  updateMemoryStats();
+  endResetModel();
+}
+
+void SqlModel::detachQuery()
+{
+  closeCursor();
+}
+
+void SqlModel::applyDelta()
+{
+  // Counts are outdated after database changes
+  countCache.clear();
+
+  if(queryRecord.isEmpty())
+  {
+    // Nothing loaded yet
+    buildQuery();
+    return;
+  }
+
+  if(filterCache != nullptr)
+  {
+    // Cached ids are outdated after database changes
+    closeCursor();
+    filterCache->clear();
+    updateFilterCache();
+    query.build();
+  }
+
+  int oldTotalRowCount = totalRowCount;
+  if(!updateTotalRowCount())
+    // Keep the loaded rows - no more rows can be fetched until the next query
+    return;
+
+  if(releasedRows > 0)
+  {
+    // Released rows cannot be compared with the new result
+    qDebug() << "Rows were released from cache - doing full reload";
+    resetQuery();
+    return;
+  }
+
+  if(rollup != nullptr)
+  {
+    // Subtotals of all levels can change - calculate them again in one pass
+    qDebug() << "Rollup view - doing full reload";
+    resetQuery();
+    return;
+  }
+
+  bool success;
+  if(isGrouped())
+    success = applyGroupDelta(oldTotalRowCount);
+  else
+    success = applyRowDelta(oldTotalRowCount);
+
+  if(success)
+  {
+    clearCacheState();
+    addCachedRows(0, rows.size());
+
+    // Continue fetching behind the rows that are already loaded
+    if(rows.size() < totalRowCount)
     {
-      // Not grouping - default view
-      if(col.isDefaultCol() || col.isHiddenCol())
-        colNames.append(col.getColumnName());
+      QueryTimer timer(QueryStats::PAGE_FETCH);
+      openCursor(rows.size());
+      timer.pause();
+      if(rows.isEmpty())
+        fetchMore(QModelIndex());
     }
-    else if(col.getColumnName() == groupByCol || col.isGroupShow())
-      // Add the group by column
-      colNames.append(col.getColumnName());
     else
+      closeCursor();
+  }
+  else
+  {
+    qDebug() << "Order of loaded rows changed - doing full reload";
+    resetQuery();
+  }
+}
+
+bool SqlModel::applyRowDelta(int oldTotalRowCount)
+{
+  // The window covers all loaded rows and all rows that were added before or within them
+  int window = rows.size() + std::max(0, totalRowCount - oldTotalRowCount);
+
+  QVector<QVariant> keys;
+  QHash<QString, QVariantList> newRows;
+  try
+  {
+    // Read only the keys in the current order
+    SelectStatement keyStmt = query.getStatement();
+    keyStmt.clearColumns();
+    keyStmt.addColumn("simulator_id");
+    keyStmt.addColumn("logbook_id");
+    keyStmt.setLimit(window);
+    QVariantMap keyBinds;
+    QString keySql = keyStmt.toSql(keyBinds);
+
+    QueryTimer keyTimer(QueryStats::PAGE_FETCH);
+    keyTimer.setQueryInfo(db, keySql, query.getStateDescription(), keyBinds);
+    SqlQuery keyQuery(db);
+    keyQuery.prepare(keySql);
+    SelectStatement::bindValues(keyQuery, keyBinds);
+    keyQuery.exec();
+    while(keyTimer.next(keyQuery))
+      keys.append(rowKey({keyQuery.value(0), keyQuery.value(1)}, {0, 1}));
+
+    if(!removeVanishedRows(keys))
+      return false;
+
+    // Collect keys that are not loaded yet
+    QSet<QString> loadedKeys;
+    QVector<int> keyIndexes = keyColumnIndexes();
+    for(const QVariantList& row : rows)
+      loadedKeys.insert(rowKey(row, keyIndexes));
+
+    // Entry numbers of the new rows by simulator
+    QMap<int, QStringList> missingKeys;
+    for(const QVariant& key : keys)
     {
-      // Add all aggregate columns
-      QString cname = col.getColumnName();
-      if(col.isMin())
-        colNames.append("min(" + cname + ") as " + cname + "_min");
-      if(col.isMax())
-        colNames.append("max(" + cname + ") as " + cname + "_max");
-      if(col.isSum())
-        colNames.append("sum(" + cname + ") as " + cname + "_sum");
+      if(!loadedKeys.contains(key.toString()))
+      {
+        QStringList values = key.toString().split('|');
+        missingKeys[values.first().toInt()].append(values.last());
+      }
     }
+
+    // Fetch only the new rows in chunks
+    const int CHUNK_SIZE = 500;
+    for(auto it = missingKeys.constBegin(); it != missingKeys.constEnd(); ++it)
+    {
+      for(int i = 0; i < it.value().size(); i += CHUNK_SIZE)
+      {
+        SelectStatement rowStmt = query.getViewStatement();
+        rowStmt.clearPredicates();
+        rowStmt.clearOrder();
+
+        SelectStatement::Predicate simPredicate;
+        simPredicate.column = "simulator_id";
+        simPredicate.value = it.key();
+        rowStmt.addPredicate(simPredicate);
+
+        SelectStatement::Predicate keyPredicate;
+        keyPredicate.column = "logbook_id";
+        keyPredicate.op = SelectStatement::IN_LIST;
+        keyPredicate.value = QVariant(it.value().mid(i, CHUNK_SIZE));
+        rowStmt.addPredicate(keyPredicate);
+
+        QVariantMap rowBinds;
+        QueryTimer rowTimer(QueryStats::PAGE_FETCH);
+        SqlQuery rowQuery(db);
+        rowQuery.prepare(rowStmt.toSql(rowBinds));
+        SelectStatement::bindValues(rowQuery, rowBinds);
+        rowQuery.exec();
+        while(rowTimer.next(rowQuery))
+        {
+          QVariantList row;
+          for(int col = 0; col < queryRecord.count(); ++col)
+            row.append(rowQuery.value(col));
+          newRows.insert(rowKey(row, keyIndexes), row);
+        }
+      }
+    }
+  }
+  catch(std::exception& e)
+  {
+    atools::gui::ErrorHandler(parentWidget).handleException(e, "While updating query");
+    return false;
+  }
+  catch(...)
+  {
+    atools::gui::ErrorHandler(parentWidget).handleUnknownException("While updating query");
+    return false;
   }
 
-  if(!groupByCol.isEmpty())
-    // Always add total count when grouping
-    colNames.append("count(*) as num_flights");
+  insertNewRows(keys, newRows);
+  qDebug() << "Row delta applied:" << newRows.size() << "rows inserted";
+  return true;
+}
+
+bool SqlModel::applyGroupDelta(int oldTotalRowCount)
+{
+  int window = rows.size() + std::max(0, totalRowCount - oldTotalRowCount);
+
+  // Groups are small - read the full rows including all aggregates
+  QVector<QVariant> keys;
+  QVector<QVariantList> windowRows;
+  QHash<QString, QVariantList> newRows;
+  QVector<int> keyIndexes = keyColumnIndexes();
+
+  QueryTimer timer(QueryStats::PAGE_FETCH);
+  timer.setQueryInfo(db, query.getViewQuery(), query.getStateDescription(), query.getViewBinds());
+  if(!openCursor(0))
+    return false;
+  windowRows = readRows(window);
+  timer.addRows(windowRows.size());
+  timer.addStatementCounters(*cursor);
+  timer.pause();
+  closeCursor();
+
+  for(const QVariantList& row : windowRows)
+  {
+    keys.append(rowKey(row, keyIndexes));
+    newRows.insert(rowKey(row, keyIndexes), row);
+  }
 
-  // Concatenate to one string
-  QString queryCols;
-  bool first = true;
-  for(QString cname : colNames)
+  if(!removeVanishedRows(keys))
+    return false;
+
+  // Patch aggregates of the groups that are still present
+  for(int r = 0; r < rows.size(); ++r)
   {
-    if(!first)
-      queryCols += ", ";
-    queryCols += cname;
+    const QVariantList& newRow = newRows.value(rowKey(rows.at(r), keyIndexes));
+    int firstChanged = -1, lastChanged = -1;
+    for(int col = 0; col < newRow.size(); ++col)
+    {
+      if(rows.at(r).at(col) != newRow.at(col))
+      {
+        if(firstChanged == -1)
+          firstChanged = col;
+        lastChanged = col;
+      }
+    }
 
-    first = false;
+    if(firstChanged != -1)
+    {
+      rows[r] = newRow;
+      emit dataChanged(index(r, firstChanged), index(r, lastChanged));
+    }
   }
-  return queryCols;
+
+  insertNewRows(keys, newRows);
+  return true;
 }
 
-QString SqlModel::buildWhereValue(const WhereCondition& cond)
+bool SqlModel::removeVanishedRows(const QVector<QVariant>& keys)
 {
-  QString val;
-  if(cond.value.type() == QVariant::String || cond.value.type() == QVariant::Char)
-    val = " '" + cond.value.toString() + "'";
-  else if(cond.value.type() == QVariant::Bool ||
-          cond.value.type() == QVariant::Int ||
-          cond.value.type() == QVariant::UInt ||
-          cond.value.type() == QVariant::LongLong ||
-          cond.value.type() == QVariant::ULongLong ||
-          cond.value.type() == QVariant::Double)
-    val = " " + cond.value.toString();
-  return val;
+  QVector<int> keyIndexes = keyColumnIndexes();
+
+  QHash<QString, int> keyPositions;
+  for(int i = 0; i < keys.size(); ++i)
+    keyPositions.insert(keys.at(i).toString(), i);
+
+  // Remove from bottom up and merge consecutive rows into one range
+  int r = rows.size() - 1;
+  while(r >= 0)
+  {
+    if(!keyPositions.contains(rowKey(rows.at(r), keyIndexes)))
+    {
+      int last = r;
+      while(r > 0 && !keyPositions.contains(rowKey(rows.at(r - 1), keyIndexes)))
+        r--;
+
+      beginRemoveRows(QModelIndex(), r, last);
+      rows.remove(r, last - r + 1);
+      endRemoveRows();
+    }
+    r--;
+  }
+
+  // Remaining rows have to keep their relative order
+  int lastPos = -1;
+  for(const QVariantList& row : rows)
+  {
+    int pos = keyPositions.value(rowKey(row, keyIndexes));
+    if(pos < lastPos)
+      return false;
+
+    lastPos = pos;
+  }
+  return true;
 }
 
-QString SqlModel::buildWhere()
+void SqlModel::insertNewRows(const QVector<QVariant>& keys, const QHash<QString, QVariantList>& newRows)
 {
-  QString queryWhere;
-  QString queryWhereAnd;
+  QVector<int> keyIndexes = keyColumnIndexes();
 
-  int numCond = 0, numAndCond = 0;
-  for(const WhereCondition& cond : whereConditionMap)
+  // Walk through the keys in sorted order and insert all blocks of missing rows
+  int rowPos = 0, keyPos = 0;
+  while(keyPos < keys.size())
   {
-    if(!cond.col->isAlwaysAndCol())
+    if(rowPos < rows.size() && rowKey(rows.at(rowPos), keyIndexes) == keys.at(keyPos).toString())
     {
-      if(numCond++ > 0)
-        queryWhere += " " + whereOperator + " ";
-      queryWhere += cond.col->getColumnName() + " " + cond.oper + " ";
-      if(!cond.value.isNull())
-        queryWhere += buildWhereValue(cond);
+      rowPos++;
+      keyPos++;
+      continue;
     }
-    else
+
+    // Collect all new rows up to the next loaded one
+    QString nextLoadedKey;
+    if(rowPos < rows.size())
+      nextLoadedKey = rowKey(rows.at(rowPos), keyIndexes);
+
+    QVector<QVariantList> block;
+    while(keyPos < keys.size() && (rowPos >= rows.size() || keys.at(keyPos).toString() != nextLoadedKey))
+    {
+      QString key = keys.at(keyPos).toString();
+      if(newRows.contains(key))
+        block.append(newRows.value(key));
+      keyPos++;
+    }
+
+    if(!block.isEmpty())
     {
-      if(numAndCond++ > 0)
-        queryWhereAnd += " and ";
-      queryWhereAnd += cond.col->getColumnName() + " " + cond.oper + " ";
-      if(!cond.value.isNull())
-        queryWhereAnd += buildWhereValue(cond);
+      beginInsertRows(QModelIndex(), rowPos, rowPos + block.size() - 1);
+      for(int i = 0; i < block.size(); ++i)
+        rows.insert(rowPos + i, block.at(i));
+      endInsertRows();
+      rowPos += block.size();
     }
   }
-  if(numCond > 0)
-    queryWhere = "(" + queryWhere + ")";
+}
+
+int SqlModel::groupLevel(int row) const
+{
+  if(levelColIndex == -1 || row < 0 || row >= rows.size() || rows.at(row).isEmpty())
+    return -1;
+
+  int level = rows.at(row).value(levelColIndex).toInt();
+  return level < query.getGroupByColumns().size() ? level : -1;
+}
 
-  if(numAndCond > 0)
+bool SqlModel::isSubtotalCell(const QModelIndex& index) const
+{
+  int level = groupLevel(index.row());
+  return level != -1 && index.column() >= level && index.column() < query.getGroupByColumns().size();
+}
+
+QVector<int> SqlModel::keyColumnIndexes() const
+{
+  QVector<int> indexes;
+  for(const QString& col : query.getKeyColumns())
+    indexes.append(queryRecord.indexOf(col));
+  return indexes;
+}
+
+QString SqlModel::rowKey(const QVariantList& row, const QVector<int>& keyIndexes)
+{
+  QStringList values;
+  for(int index : keyIndexes)
+    values.append(row.at(index).toString());
+  return values.join('|');
+}
+
+QVariant SqlModel::rawData(const QModelIndex& index) const
+{
+  if(!index.isValid() || index.row() >= rows.size() || index.column() >= queryRecord.count())
+    return QVariant();
+
+  const QVariantList& row = cachedRow(index.row());
+  return index.column() < row.size() ? row.at(index.column()) : QVariant();
+}
+
+const QVariantList& SqlModel::cachedRow(int row) const
+{
+  int page = row / FETCH_SIZE;
+  if(rows.at(row).isEmpty())
   {
-    if(numCond > 0)
-      queryWhere += " and ";
-    queryWhere += queryWhereAnd;
+    // No queries while painting - the view gets empty cells until the page is loaded
+    requestedPages.insert(page);
+    if(!pageLoadTimer.isActive())
+      pageLoadTimer.start();
   }
+  else if(page < pageAccess.size())
+    pageAccess[page] = ++accessTick;
+  return rows.at(row);
+}
 
-  if(numCond > 0 || numAndCond > 0)
-    queryWhere = " where " + queryWhere;
+void SqlModel::loadRequestedPages()
+{
+  QSet<int> pages;
+  pages.swap(requestedPages);
 
-  return queryWhere;
+  for(int page : pages)
+  {
+    // Rows can have changed since the request
+    int first = page * FETCH_SIZE;
+    if(first < rows.size() && rows.at(first).isEmpty())
+    {
+      loadPage(page);
+      int last = std::min(rows.size(), first + FETCH_SIZE) - 1;
+      emit dataChanged(createIndex(first, 0), createIndex(last, queryRecord.count() - 1));
+    }
+  }
 }
 
-void SqlModel::buildQuery()
+void SqlModel::loadReleasedRow(int row)
+{
+  if(row >= 0 && row < rows.size() && rows.at(row).isEmpty())
+    loadPage(row / FETCH_SIZE);
+}
+
+void SqlModel::setCacheLimitBytes(qint64 value)
+{
+  cacheLimitBytes = value;
+  enforceCacheLimit(pageAccess.size() - 1);
+  updateMemoryStats();
+}
+
+void SqlModel::setCollapsedColumns(const QSet<QString>& colNames)
 {
-  QString queryCols = buildColumnList();
+  if(colNames == query.getCollapsedColumns())
+    return;
 
-  QString queryWhere = buildWhere();
+  QStringList added;
+  for(const QString& colName : query.getResultColumnNames())
+    if(!query.isColumnProjected(colName))
+      added.append(colName);
 
-  QString queryGroup;
-  if(!groupByCol.isEmpty())
-    queryGroup += "group by " + groupByCol;
+  query.setCollapsedColumns(colNames);
+  query.build();
+
+  QStringList shown;
+  for(const QString& colName : added)
+    if(query.isColumnProjected(colName))
+      shown.append(colName);
+
+  qDebug() << "Collapsed columns" << colNames << "loading" << shown;
+
+  // Values of collapsed columns stay in the cache until the next query
+  if(!shown.isEmpty())
+    loadColumns(shown);
+
+  if(cursor != nullptr && !cursorAtEnd && rollup == nullptr)
+    // Continue fetching with the new column list - rollup rows do not match the query offset
+    openCursor(rows.size());
+}
 
-  QString queryOrder;
-  if(!orderByCol.isEmpty() && !orderByOrder.isEmpty())
+void SqlModel::loadColumns(const QStringList& colNames)
+{
+  // Only used for views that are not grouped
+  QVector<int> keyIndexes = keyColumnIndexes();
+  QHash<QString, int> rowIndex;
+  QMap<QString, QStringList> keys;
+  for(int r = 0; r < rows.size(); ++r)
   {
-    const Column *col = columns->getColumn(orderByCol);
-    Q_ASSERT(col != nullptr);
+    if(!rows.at(r).isEmpty())
+    {
+      rowIndex.insert(rowKey(rows.at(r), keyIndexes), r);
+      keys[rows.at(r).at(keyIndexes.first()).toString()].append(rows.at(r).at(keyIndexes.last()).toString());
+    }
+  }
+
+  QVector<int> colIndexes;
+  for(const QString& colName : colNames)
+    colIndexes.append(queryRecord.indexOf(colName));
 
-    if(!(col->getSortFuncColAsc().isEmpty() && col->getSortFuncColDesc().isEmpty()))
+  try
+  {
+    const int CHUNK_SIZE = 500;
+    for(auto it = keys.constBegin(); it != keys.constEnd(); ++it)
     {
-      // Use sort functions to have null values at end of the list - will avoid indexes
-      if(orderByOrder == "asc")
-        queryOrder += "order by " + col->getSortFuncColAsc().arg(orderByCol) + " " + orderByOrder;
-      else if(orderByOrder == "desc")
-        queryOrder += "order by " + col->getSortFuncColDesc().arg(orderByCol) + " " + orderByOrder;
-      else
-        Q_ASSERT(orderByOrder != "asc" && orderByOrder != "desc");
+      for(int i = 0; i < it.value().size(); i += CHUNK_SIZE)
+      {
+        QueryTimer timer(QueryStats::PAGE_FETCH);
+        SqlQuery colQuery(db);
+        colQuery.exec("select simulator_id, logbook_id, " + colNames.join(", ") + " from " +
+                      query.getTableName() + " where simulator_id = " + it.key() +
+                      " and logbook_id in (" + it.value().mid(i, CHUNK_SIZE).join(",") + ")");
+        while(timer.next(colQuery))
+        {
+          QVariantList& row = rows[rowIndex.value(rowKey({colQuery.value(0), colQuery.value(1)}, {0, 1}))];
+          cachedBytes -= MemoryStats::estimateBytes(row);
+          for(int c = 0; c < colIndexes.size(); ++c)
+            row[colIndexes.at(c)] = colQuery.value(c + 2);
+          cachedBytes += MemoryStats::estimateBytes(row);
+        }
+      }
     }
-    else
-      queryOrder += "order by " + orderByCol + " " + orderByOrder;
+  }
+  catch(std::exception& e)
+  {
+    atools::gui::ErrorHandler(parentWidget).handleException(e, "While loading columns");
+  }
+  catch(...)
+  {
+    atools::gui::ErrorHandler(parentWidget).handleUnknownException("While loading columns");
   }
 
-  currentSqlQuery = "select " + queryCols + " from " + tableName +
-                    " " + queryWhere + " " + queryGroup + " " + queryOrder;
+  for(int col : colIndexes)
+    emit dataChanged(createIndex(0, col), createIndex(rows.size() - 1, col));
+  updateMemoryStats();
+}
 
-  // Build a query to find the total row count of the result
-  totalRowCount = 0;
-  QString queryCount;
-  if(isGrouped())
-    queryCount = "select count(1) from "
-                 "(select count(" + groupByCol + ") from " + tableName + " " + queryWhere + " " +
-                 queryGroup + ")";
-  else
-    queryCount = "select count(1) from " + tableName + " " + queryWhere;
+void SqlModel::addCachedRows(int firstRow, int numRows)
+{
+  for(int r = firstRow; r < firstRow + numRows; ++r)
+    cachedBytes += MemoryStats::estimateBytes(rows.at(r));
 
-  try
+  pageAccess.resize((rows.size() + FETCH_SIZE - 1) / FETCH_SIZE);
+  if(numRows > 0)
+  {
+    int lastPage = (firstRow + numRows - 1) / FETCH_SIZE;
+    for(int page = firstRow / FETCH_SIZE; page <= lastPage; ++page)
+      pageAccess[page] = ++accessTick;
+    enforceCacheLimit(lastPage);
+  }
+  updateMemoryStats();
+}
+
+void SqlModel::loadPage(int page)
+{
+  int first = page * FETCH_SIZE;
+  int last = std::min(rows.size(), first + FETCH_SIZE) - 1;
+
+  SelectStatement stmt = query.getViewStatement();
+  stmt.setLimit(FETCH_SIZE, first);
+  QVariantMap binds;
+
+  QueryTimer timer(QueryStats::PAGE_FETCH);
+  QSqlQuery pageQuery(db->getQSqlDatabase());
+  pageQuery.setForwardOnly(true);
+  pageQuery.prepare(stmt.toSql(binds));
+  SelectStatement::bindValues(pageQuery, binds);
+  if(!pageQuery.exec())
   {
-    SqlQuery countStmt(db);
-    countStmt.exec(queryCount);
-    if(countStmt.next())
-      totalRowCount = countStmt.value(0).toInt();
+    timer.pause();
+    atools::gui::ErrorHandler(parentWidget).handleSqlError(pageQuery.lastError());
+    return;
+  }
 
-    qDebug() << "Query" << currentSqlQuery;
-    qDebug() << "Query Count" << queryCount;
+  int cnt = queryRecord.count();
+  for(int r = first; r <= last && timer.next(pageQuery); ++r)
+  {
+    if(rows.at(r).isEmpty())
+    {
+      QVariantList row;
+      row.reserve(cnt);
+      for(int i = 0; i < cnt; ++i)
+        row.append(pageQuery.value(i));
+      cachedBytes += MemoryStats::estimateBytes(row);
+      rows[r] = row;
+      releasedRows--;
+    }
+  }
+  timer.addStatementCounters(pageQuery);
+  timer.pause();
+  pageQuery.finish();
 
-    QSqlQueryModel::setQuery(currentSqlQuery, db->getQSqlDatabase());
+  pageAccess[page] = ++accessTick;
+  enforceCacheLimit(page);
+  updateMemoryStats();
+}
 
-    if(lastError().isValid())
-      atools::gui::ErrorHandler(parentWidget).handleSqlError(lastError());
+void SqlModel::releasePage(int page)
+{
+  int first = page * FETCH_SIZE;
+  int last = std::min(rows.size(), first + FETCH_SIZE) - 1;
+  for(int r = first; r <= last; ++r)
+  {
+    if(!rows.at(r).isEmpty())
+    {
+      cachedBytes -= MemoryStats::estimateBytes(rows.at(r));
+      rows[r] = QVariantList();
+      releasedRows++;
+    }
   }
-  catch(std::exception& e)
+}
+
+void SqlModel::enforceCacheLimit(int keepPage)
+{
+  // Pages with subtotals cannot be loaded again by offset
+  if(cacheLimitBytes <= 0 || rollup != nullptr)
+    return;
+
+  while(cachedBytes > cacheLimitBytes)
   {
-    atools::gui::ErrorHandler(parentWidget).handleException(e, "While executing query");
+    // Find the least recently used page that is still loaded
+    int oldest = -1;
+    for(int page = 0; page < pageAccess.size(); ++page)
+    {
+      if(page != keepPage && !rows.at(page * FETCH_SIZE).isEmpty() &&
+         (oldest == -1 || pageAccess.at(page) < pageAccess.at(oldest)))
+        oldest = page;
+    }
+
+    if(oldest == -1)
+      break;
+
+    qDebug() << "Releasing cached page" << oldest << "cache size" << cachedBytes << "limit" << cacheLimitBytes;
+    releasePage(oldest);
   }
-  catch(...)
+}
+
+void SqlModel::clearCacheState()
+{
+  cachedBytes = 0;
+  releasedRows = 0;
+  pageAccess.clear();
+  requestedPages.clear();
+  pageLoadTimer.stop();
+}
+
+void SqlModel::updateMemoryStats() const
+{
+  MemoryStats& stats = MemoryStats::instance();
+  stats.set(MemoryStats::MODEL_ROWS, rows.size() - releasedRows);
+  stats.set(MemoryStats::MODEL_BYTES, cachedBytes);
+  stats.set(MemoryStats::MODEL_EVICTED_ROWS, releasedRows);
+}
+
+int SqlModel::rowCount(const QModelIndex& parent) const
+{
+  if(parent.isValid())
+    return 0;
+
+  return rows.size();
+}
+
+int SqlModel::columnCount(const QModelIndex& parent) const
+{
+  if(parent.isValid())
+    return 0;
+
+  return queryRecord.count();
+}
+
+bool SqlModel::canFetchMore(const QModelIndex& parent) const
+{
+  return !parent.isValid() && cursor != nullptr && !cursorAtEnd;
+}
+
+QVariant SqlModel::headerData(int section, Qt::Orientation orientation, int role) const
+{
+  if(orientation == Qt::Horizontal && (role == Qt::DisplayRole || role == Qt::EditRole))
   {
-    atools::gui::ErrorHandler(parentWidget).handleUnknownException("While executing query");
+    if(headerCaptions.contains(section))
+      return headerCaptions.value(section);
+    else
+      return queryRecord.fieldName(section);
   }
+  return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+bool SqlModel::setHeaderData(int section, Qt::Orientation orientation, const QVariant& value, int role)
+{
+  if(orientation != Qt::Horizontal || section < 0 || section >= columnCount())
+    return false;
+
+  if(role != Qt::DisplayRole && role != Qt::EditRole)
+    return false;
+
+  headerCaptions.insert(section, value);
+  emit headerDataChanged(orientation, section, section);
+  return true;
 }
 
-QString SqlModel::formatValue(const QString& colName, const QVariant& value) const
+QString SqlModel::formatValue(const QString& colName, const QVariant& value)
 {
   using namespace atools::fs::lb::types;
   using namespace atools::fs;
@@ -501,6 +1141,16 @@ QString SqlModel::formatValue(const QString& colName, const QVariant& value) con
   }
   else if(colName.startsWith("startdate"))
     return formatter::formatDate(value.toInt());
+  else if(colName.startsWith("start_") && value.isNull())
+    return QString();
+  else if(colName == "start_year")
+    return QString::number(value.toInt());
+  else if(colName == "start_month")
+    return formatter::formatMonth(value.toInt());
+  else if(colName == "start_week")
+    return formatter::formatWeek(value.toInt());
+  else if(colName == "start_weekday")
+    return formatter::formatWeekday(value.toInt());
   else if(colName.startsWith("total_time"))
     return formatter::formatMinutesHours(value.toDouble());
   else if(colName.startsWith("night_time"))
@@ -549,7 +1199,7 @@ QString SqlModel::formatValue(const QString& colName, const QVariant& value) con
 
 Qt::SortOrder SqlModel::getSortOrder() const
 {
-  return orderByOrder == "desc" ? Qt::DescendingOrder : Qt::AscendingOrder;
+  return query.getOrderByOrder() == "desc" ? Qt::DescendingOrder : Qt::AscendingOrder;
 }
 
 QVariant SqlModel::data(const QModelIndex& index, int role) const
@@ -559,7 +1209,11 @@ QVariant SqlModel::data(const QModelIndex& index, int role) const
 
   if(role == Qt::DisplayRole)
   {
-    QVariant var = QSqlQueryModel::data(index, role);
+    if(isSubtotalCell(index))
+      // First empty group column of a subtotal row gets the label
+      return index.column() == groupLevel(index.row()) ? tr("Total") : QString();
+
+    QVariant var = rawData(index);
     QString col = record().field(index.column()).name();
     return formatValue(col, var);
   }
@@ -568,16 +1222,25 @@ QVariant SqlModel::data(const QModelIndex& index, int role) const
     QString col = record().field(index.column()).name();
 
     if((col == "airport_from_icao" || col == "airport_to_icao") && hasAirports)
-      return airportInfo->createAirportHtml(QSqlQueryModel::data(index, Qt::DisplayRole).toString());
+      return airportInfo->createAirportHtml(rawData(index).toString());
     else if(col.startsWith("startdate"))
-      return formatter::formatDateLong(QSqlQueryModel::data(index).toInt());
+      return formatter::formatDateLong(rawData(index).toInt());
     else if(col.startsWith("distance"))
     {
-      double nm = QSqlQueryModel::data(index).toDouble();
+      double nm = rawData(index).toDouble();
       if(nm > 0.01)
         return formatter::formatDoubleUnit(atools::geo::nmToMeters(nm / 1000.), tr("kilometers"));
     }
   }
+  else if(role == Qt::FontRole)
+  {
+    if(groupLevel(index.row()) != -1)
+    {
+      QFont font = parentWidget->font();
+      font.setBold(true);
+      return font;
+    }
+  }
   else if(role == Qt::BackgroundRole)
   {
     if(index.column() == orderByColIndex)
@@ -593,6 +1256,8 @@ QVariant SqlModel::data(const QModelIndex& index, int role) const
       return Qt::AlignRight;
     else if(col.startsWith("startdate"))
       return Qt::AlignRight;
+    else if(col == "start_year" || col == "start_month" || col == "start_week")
+      return Qt::AlignRight;
     else if(col.startsWith("total_time"))
       return Qt::AlignRight;
     else if(col.startsWith("night_time"))
@@ -604,7 +1269,7 @@ QVariant SqlModel::data(const QModelIndex& index, int role) const
     else if(col.startsWith("num_flights"))
       return Qt::AlignRight;
     else
-      return QSqlQueryModel::data(index, role);
+      return QVariant();
   }
 
   return QVariant();
@@ -612,15 +1277,35 @@ QVariant SqlModel::data(const QModelIndex& index, int role) const
 
 void SqlModel::fetchMore(const QModelIndex& parent)
 {
-  QSqlQueryModel::fetchMore(parent);
+  if(!canFetchMore(parent))
+    return;
+
+  TraceSpan span("fetchMore", "model");
+  QueryTimer timer(QueryStats::PAGE_FETCH);
+  QVector<QVariantList> fetched = readRows(FETCH_SIZE);
+  span.setRows(fetched.size());
+  timer.addRows(fetched.size());
+  if(cursor != nullptr)
+    timer.addStatementCounters(*cursor);
+  timer.pause();
+
+  if(!fetched.isEmpty())
+  {
+    beginInsertRows(QModelIndex(), rows.size(), rows.size() + fetched.size() - 1);
+    rows += fetched;
+    endInsertRows();
+    addCachedRows(rows.size() - fetched.size(), fetched.size());
+  }
   emit fetchedMore();
 }
 
-QVariantList SqlModel::getRawData(int row) const
+QVariantList SqlModel::getRawData(int row)
 {
+  loadReleasedRow(row);
+
   QVariantList values;
   for(int i = 0; i < columnCount(); ++i)
-    values.append(QSqlQueryModel::data(createIndex(row, i)));
+    values.append(rawData(createIndex(row, i)));
   return values;
 }
 
@@ -634,11 +1319,13 @@ QStringList SqlModel::getRawColumns() const
 
 QVariantList SqlModel::getFormattedRowData(int row)
 {
+  loadReleasedRow(row);
+
   QVariantList values;
   for(int i = 0; i < columnCount(); ++i)
   {
     QModelIndex idx = createIndex(row, i);
-    values.append(formatValue(record().field(idx.column()).name(), QSqlQueryModel::data(idx)));
+    values.append(formatValue(record().field(idx.column()).name(), rawData(idx)));
   }
   return values;
 }
@@ -18,8 +18,15 @@
 #ifndef LITTLELOGBOOK_SQLMODEL_H
 #define LITTLELOGBOOK_SQLMODEL_H
 
+#include "table/querybuilder.h"
+
+#include <QAbstractTableModel>
 #include <QColor>
-#include <QSqlQueryModel>
+#include <QHash>
+#include <QSet>
+#include <QSqlRecord>
+#include <QTimer>
+#include <QVector>
 
 namespace atools {
 namespace sql {
@@ -31,23 +38,42 @@ class SqlDatabase;
 class Column;
 class ColumnList;
 class AirportInfo;
+class ConnectionPool;
+class FilterCache;
+class GroupRollup;
+class QSqlQuery;
 
 /*
- * Extends the QSqlQueryModel and adds query building based on filters, ordering
- * and grouping.
+ * Table model that adds query building based on filters, ordering and grouping.
+ * Rows are fetched page by page like QSqlQueryModel does but kept in an own
+ * cache which allows to insert, remove and patch rows after database changes
+ * without resetting the whole model.
+ *
+ * If a cache limit is set in "Database/ModelCacheLimitMb" the least recently
+ * used pages are released when the estimated cache size exceeds the limit. Pages
+ * shown by the view are loaded again by offset after painting. Until then their
+ * cells are empty.
+ *
+ * Results of single filter conditions are cached by FilterCache unless
+ * "Database/FilterCacheMb" is 0.
  */
 class SqlModel :
-  public QSqlQueryModel
+  public QAbstractTableModel
 {
   Q_OBJECT
 
 public:
+  /* Tooltip lookups use a connection from connectionPool */
   SqlModel(QWidget *parent,
            atools::sql::SqlDatabase *sqlDb,
+           ConnectionPool *connectionPool,
            const ColumnList *columnList,
            bool hasAirportTable);
   virtual ~SqlModel();
 
+  /* Number of rows to fetch at once */
+  static const int FETCH_SIZE = 256;
+
   /* Creates an include filer for value at index in the table */
   void filterIncluding(QModelIndex index);
 
@@ -57,13 +83,17 @@ public:
   /* Group by the column at index */
   void getGroupByColumn(QModelIndex index);
 
+  /* Add a nested group level to the grouped view. Views grouped by more than one
+   * column show subtotal rows for each level and a grand total. */
+  void addGroupByColumn(const QString& colName);
+
   /* Release grouping and go back to default view */
   void ungroup();
 
   /* Clear all filters, sort order and grouping and go back to default view */
   void reset();
 
-  /* clear all filters */
+  /* clear all filters including value ranges */
   void resetSearch();
 
   /* Set header captions based on current query and the descriptions in
@@ -89,30 +119,41 @@ public:
    * query */
   void filter(const QString& colName, const QVariant& value);
 
+  /* Filter by a range of values. A null value leaves the range open on that side. */
+  void filterRange(const QString& colName, const QVariant& minValue, const QVariant& maxValue);
+
   /* Operator to connect all conditions ("and" or "or") */
   void filterOperator(const QString& op);
 
   /* Get field data formatted for display as seen in the table view */
-  QVariant getFormattedFieldData(const QModelIndex& index) const;
+  QVariant getFormattedFieldData(const QModelIndex& index);
 
   /* Get row data formatted for display as seen in the table view */
   QVariantList getFormattedRowData(int row);
 
   /* Format given data for display */
-  QString formatValue(const QString& colName, const QVariant& value) const;
+  static QString formatValue(const QString& colName, const QVariant& value);
 
   Qt::SortOrder getSortOrder() const;
 
   QString getSortColumn() const
   {
-    return orderByCol;
+    return query.getOrderByCol();
   }
 
   QString getGroupByColumn() const
   {
-    return groupByCol;
+    return query.getGroupBy();
+  }
+
+  const QStringList& getGroupByColumns() const
+  {
+    return query.getGroupByColumns();
   }
 
+  /* Level of a subtotal row (0 is the grand total) or -1 for normal rows */
+  int groupLevel(int row) const;
+
   int getTotalRowCount() const
   {
     return totalRowCount;
@@ -120,14 +161,62 @@ public:
 
   QString getCurrentSqlQuery() const
   {
-    return currentSqlQuery;
+    return query.getSqlQuery();
+  }
+
+  /* Query builder holding filters, grouping and order of this model */
+  const QueryBuilder& getQueryBuilder() const
+  {
+    return query;
   }
 
-  /* Emit signal fetchedMore */
+  /* Fetch the next page of rows from the query and emit signal fetchedMore */
   virtual void fetchMore(const QModelIndex& parent) override;
+  virtual bool canFetchMore(const QModelIndex& parent) const override;
+
+  virtual int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+  virtual int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+
+  virtual QVariant headerData(int section, Qt::Orientation orientation,
+                              int role = Qt::DisplayRole) const override;
+  virtual bool setHeaderData(int section, Qt::Orientation orientation, const QVariant& value,
+                             int role = Qt::EditRole) override;
 
-  /* Get unformatted data from the model */
-  QVariantList getRawData(int row) const;
+  /* Field names and types of the current query */
+  QSqlRecord record() const
+  {
+    return queryRecord;
+  }
+
+  /* Remove all rows and the query */
+  void clear();
+
+  /* Close the open query before the database is changed. All loaded rows are
+   * kept but no more rows can be fetched until applyDelta() is called. */
+  void detachQuery();
+
+  /* Update the loaded rows after the database was changed. New rows are
+   * inserted at their sorted position, vanished rows are removed and changed
+   * aggregates of grouped views are updated in place. Rows are identified by
+   * simulator_id and logbook_id or the group by column. Falls back to a full query if the order
+   * of the loaded rows has changed. */
+  void applyDelta();
+
+  /* Estimated size of all cached rows in bytes */
+  qint64 getCachedBytes() const
+  {
+    return cachedBytes;
+  }
+
+  /* Soft limit for the estimated cache size. 0 disables the limit. */
+  void setCacheLimitBytes(qint64 value);
+
+  /* Columns that are not shown in the view and are not fetched. Columns that are
+   * shown again are loaded for all cached rows without resetting the model. */
+  void setCollapsedColumns(const QSet<QString>& colNames);
+
+  /* Get unformatted data from the model. Loads the row again if it was released. */
+  QVariantList getRawData(int row);
   QStringList getRawColumns() const;
 
 signals:
@@ -135,54 +224,124 @@ signals:
   void fetchedMore();
 
 private:
-  struct WhereCondition
-  {
-    QString oper; /* operator (like, not like) */
-    QVariant value;
-    const Column *col;
-  };
-
   /* Column header was clicked */
   virtual void sort(int column, Qt::SortOrder order) override;
 
   /* Format data for display */
   virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
 
-  /* Build full list of columns to query including group by and aggregated
-   * columns */
-  QString buildColumnList();
+  /* Create SQL query and set it into the model */
+  void buildQuery();
 
-  /* Build where statement */
-  QString buildWhere();
+  /* Evaluate changed filter conditions and pass the filter table to the query */
+  void updateFilterCache();
 
-  /* Convert a value to string for the where clause */
-  QString buildWhereValue(const WhereCondition& cond);
+  /* Run the count query and update totalRowCount. Shows an error dialog and
+   * returns false if the query fails. totalRowCount is not changed in this case. */
+  bool updateTotalRowCount();
 
-  /* Create SQL query and set it into the model */
-  void buildQuery();
+  /* Reset model, run the current query and fetch the first page. Shows an error
+   * dialog and returns false if the query fails. The model is not reset in this case. */
+  bool resetQuery();
+
+  /* Open the current query skipping the given number of rows. Shows an error
+   * dialog and returns false if the query fails. No cursor is open in this case. */
+  bool openCursor(int offset);
+
+  /* Close and delete the current query */
+  void closeCursor();
+
+  /* Read up to maxRows rows from the cursor */
+  QVector<QVariantList> readRows(int maxRows);
+
+  /* Fetch values of the given columns for all cached rows by key */
+  void loadColumns(const QStringList& colNames);
+
+  /* Delta for default view and grouped view */
+  bool applyRowDelta(int oldTotalRowCount);
+  bool applyGroupDelta(int oldTotalRowCount);
+
+  /* Remove all rows not contained in keys. Returns false if the order of the
+   * remaining rows differs from keys */
+  bool removeVanishedRows(const QVector<QVariant>& keys);
+
+  /* Insert rows from newRows (keyed like keys) where they are missing */
+  void insertNewRows(const QVector<QVariant>& keys, const QHash<QString, QVariantList>& newRows);
+
+  /* Get a cached row. Released rows are empty and their page is loaded again later by
+   * loadRequestedPages() since this is called while painting. */
+  const QVariantList& cachedRow(int row) const;
+
+  /* Load released pages requested by cachedRow() and update the view */
+  void loadRequestedPages();
+
+  /* Load the page of the row if it was released. Not to be used while painting. */
+  void loadReleasedRow(int row);
+
+  /* Page cache handling - pages have FETCH_SIZE rows */
+  void addCachedRows(int firstRow, int numRows);
+  void loadPage(int page);
+  void releasePage(int page);
+  void enforceCacheLimit(int keepPage);
+  void clearCacheState();
+  void updateMemoryStats() const;
+
+  /* Column indexes of the values identifying a row */
+  QVector<int> keyColumnIndexes() const;
+
+  /* Text of the key values in the row at the given indexes */
+  static QString rowKey(const QVariantList& row, const QVector<int>& keyIndexes);
+
+  /* Group column of a subtotal row that has no value */
+  bool isSubtotalCell(const QModelIndex& index) const;
+
+  /* Data as returned by the query. Null for released rows. */
+  QVariant rawData(const QModelIndex& index) const;
 
   /* Filter by value at index (context menu in table view) */
   void filterBy(QModelIndex index, bool exclude);
   QString  sortOrderToSql(Qt::SortOrder order);
 
-  QString tableName, groupByCol, orderByCol, orderByOrder, whereOperator = "and";
-  QString currentSqlQuery;
+  QueryBuilder query;
+
+  QSqlRecord queryRecord;
+  QVector<QVariantList> rows;
+  QHash<int, QVariant> headerCaptions;
+  QSqlQuery *cursor = nullptr;
+  bool cursorAtEnd = true;
 
   int orderByColIndex = 0;
-  QHash<QString, WhereCondition> whereConditionMap;
   atools::sql::SqlDatabase *db;
   const ColumnList *columns;
   QWidget *parentWidget;
   AirportInfo *airportInfo;
+  FilterCache *filterCache = nullptr;
+
+  /* Adds subtotals while reading rows if grouped by more than one column. Pages are not
+   * released and database changes reload all rows in this case. */
+  GroupRollup *rollup = nullptr;
+  int levelColIndex = -1;
   bool hasAirports = false;
   int totalRowCount = 0;
 
   QString lastOrderByCol;
   Qt::SortOrder lastOrderByOrder = Qt::DescendingOrder;
 
+  /* Released rows are empty lists. pageAccess holds the last access tick of each page. */
+  qint64 cachedBytes = 0, cacheLimitBytes = 0;
+  int releasedRows = 0;
+  mutable QVector<quint32> pageAccess;
+  mutable quint32 accessTick = 0;
+
+  /* Released pages accessed by the view. Loaded once the event loop is idle. */
+  mutable QSet<int> requestedPages;
+  mutable QTimer pageLoadTimer;
+
   /* Alternating colors for normal display and display of sorted column */
   QColor rowBgColor, rowAltBgColor, rowSortBgColor, rowSortAltBgColor;
-  void clearWhereConditions();
+
+  /* Row counts by SelectStatement::getFilterKey(). Cleared when the database changes. */
+  QHash<QString, int> countCache;
 
 };
 